@@ -0,0 +1,149 @@
+// Cost of stepping the elements through their virtual calls against stepping them sorted by class.
+// Builds an architecture of 239 small elements, a chain of 40 fields, each with a gauss and a mexican hat kernel,
+// a stimulus and noise, and a gauss field coupling from every field to the next one, without the GUI.
+// The same architecture, with the same seed, is run in the serial and in the type-sorted execution mode;
+// prints the time per step of each, best of several repetitions, and the largest difference in activation.
+// Both modes step every element in an order the plan allows and sum the inputs of an element in the order
+// of their names, so the difference is zero, which test_execution_modes checks as well.
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <limits>
+
+#include "simulation/simulation.h"
+#include "elements/neural_field.h"
+#include "elements/gauss_kernel.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/normal_noise.h"
+#include "elements/gauss_field_coupling.h"
+
+
+using namespace dnf_composer;
+
+namespace
+{
+	constexpr int numberOfFields = 40;
+	constexpr int fieldSize = 50;
+	constexpr int numberOfSteps = 2000;
+	constexpr int repetitions = 5;
+	constexpr std::uint64_t seed = 42;
+
+	struct Run
+	{
+		std::vector<std::vector<double>> activations;
+		double microsecondsPerStep;
+	};
+
+	Run run(ExecutionMode mode)
+	{
+		const auto simulation = std::make_shared<Simulation>("dispatch benchmark", 1.0, 0.0, 0.0);
+		simulation->setSeed(seed);
+		simulation->setExecutionMode(mode);
+		const element::SigmoidFunction activationFunction{ 0.0, 4.0 };
+		const element::ElementDimensions dimensions{ fieldSize, 1.0 };
+
+		std::vector<std::shared_ptr<element::NeuralField>> fields;
+		for (int i = 0; i < numberOfFields; i++)
+		{
+			const std::string suffix = " " + std::to_string(i);
+			const auto nf = std::make_shared<element::NeuralField>(element::ElementCommonParameters{ "nf" + suffix, dimensions },
+				element::NeuralFieldParameters{ 25.0, -5.0, activationFunction });
+			const auto gk = std::make_shared<element::GaussKernel>(element::ElementCommonParameters{ "gk" + suffix, dimensions },
+				element::GaussKernelParameters{});
+			const auto mhk = std::make_shared<element::MexicanHatKernel>(element::ElementCommonParameters{ "mhk" + suffix, dimensions },
+				element::MexicanHatKernelParameters{});
+			const auto gs = std::make_shared<element::GaussStimulus>(element::ElementCommonParameters{ "gs" + suffix, dimensions },
+				element::GaussStimulusParameters{ 5.0, 10.0, 10.0 + i % 30 });
+			const auto nn = std::make_shared<element::NormalNoise>(element::ElementCommonParameters{ "nn" + suffix, dimensions },
+				element::NormalNoiseParameters{ 0.2 });
+
+			for (const auto& element : std::initializer_list<std::shared_ptr<element::Element>>{ nf, gk, mhk, gs, nn })
+				simulation->addElement(element);
+			nf->addInput(gk);
+			gk->addInput(nf);
+			nf->addInput(mhk);
+			mhk->addInput(nf);
+			nf->addInput(gs);
+			nf->addInput(nn);
+
+			if (!fields.empty())
+			{
+				const auto gfc = std::make_shared<element::GaussFieldCoupling>(element::ElementCommonParameters{ "gfc" + suffix, dimensions },
+					element::GaussFieldCouplingParameters{ dimensions, true, false, { {25.0, 25.0, 3.0, 3.0} } });
+				simulation->addElement(gfc);
+				gfc->addInput(fields.back());
+				nf->addInput(gfc);
+			}
+			fields.push_back(nf);
+		}
+
+		simulation->init();
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < numberOfSteps; i++)
+			simulation->step();
+		const auto end = std::chrono::steady_clock::now();
+
+		Run result{ {}, std::chrono::duration<double, std::micro>(end - start).count() / numberOfSteps };
+		for (const auto& field : fields)
+			result.activations.push_back(field->getComponent("activation"));
+		simulation->close();
+		return result;
+	}
+
+	double maximumDifference(const Run& run, const Run& reference)
+	{
+		double difference = 0.0;
+		for (size_t field = 0; field < run.activations.size(); field++)
+			for (size_t i = 0; i < run.activations[field].size(); i++)
+				difference = std::max(difference, std::abs(run.activations[field][i] - reference.activations[field][i]));
+		return difference;
+	}
+}
+
+int main()
+{
+	try
+	{
+		tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::WARNING);
+
+		double bestVirtual = std::numeric_limits<double>::infinity();
+		double bestTypeSorted = std::numeric_limits<double>::infinity();
+		double difference = 0.0;
+		// the modes alternate, so both see the same state of the machine
+		for (int repetition = 0; repetition < repetitions; repetition++)
+		{
+			const Run virtualRun = run(ExecutionMode::SERIAL);
+			const Run typeSortedRun = run(ExecutionMode::TYPE_SORTED);
+			bestVirtual = std::min(bestVirtual, virtualRun.microsecondsPerStep);
+			bestTypeSorted = std::min(bestTypeSorted, typeSortedRun.microsecondsPerStep);
+			difference = std::max(difference, maximumDifference(typeSortedRun, virtualRun));
+		}
+
+		std::cout << numberOfFields * 6 - 1 << " elements, " << numberOfSteps << " steps, best of " << repetitions << " runs\n";
+		std::cout << std::left << std::setw(14) << "serial" << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << bestVirtual << " us/step\n";
+		std::cout << std::left << std::setw(14) << "type sorted" << std::right
+			<< std::setw(10) << bestTypeSorted << " us/step\n";
+		std::cout << "speedup " << std::setprecision(3) << bestVirtual / bestTypeSorted
+			<< ", largest difference in activation " << std::scientific << std::setprecision(2) << difference << '\n';
+	}
+	catch (const dnf_composer::Exception& ex)
+	{
+		const std::string errorMessage = "Exception: " + std::string(ex.what()) + " ErrorCode: " + std::to_string(static_cast<int>(ex.getErrorCode())) + ". ";
+		log(dnf_composer::tools::logger::LogLevel::FATAL, errorMessage, dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return static_cast<int>(ex.getErrorCode());
+	}
+	catch (const std::exception& ex)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Exception caught: " + std::string(ex.what()) + ". ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+	catch (...)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Unknown exception occurred. ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+}
@@ -0,0 +1,154 @@
+// Throughput of an ensemble of simulations of one architecture against the same simulations run one after the other.
+// Every instance is a small architecture of 4 fields, each with a gauss kernel, a stimulus at a position of its own
+// and noise, without the GUI. Prints the instance-steps per second of the separate simulations, of the ensemble
+// stepped by one thread and of the ensemble stepped by one thread per hardware thread, best of several repetitions,
+// and the largest difference in activation between the ensemble and the separate simulations, seeded alike.
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include "simulation/ensemble_simulation.h"
+#include "elements/neural_field.h"
+#include "elements/gauss_kernel.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/normal_noise.h"
+
+
+using namespace dnf_composer;
+
+namespace
+{
+	constexpr size_t numberOfInstances = 64;
+	constexpr int numberOfFields = 4;
+	constexpr int fieldSize = 100;
+	constexpr int numberOfSteps = 500;
+	constexpr int repetitions = 7;
+	constexpr std::uint64_t seed = 42;
+
+	std::shared_ptr<Simulation> buildInstance(size_t instance)
+	{
+		const auto simulation = std::make_shared<Simulation>("ensemble benchmark " + std::to_string(instance), 1.0, 0.0, 0.0);
+		const element::SigmoidFunction activationFunction{ 0.0, 4.0 };
+		const element::ElementDimensions dimensions{ fieldSize, 1.0 };
+
+		for (int i = 0; i < numberOfFields; i++)
+		{
+			const std::string suffix = " " + std::to_string(i);
+			const auto nf = std::make_shared<element::NeuralField>(element::ElementCommonParameters{ "nf" + suffix, dimensions },
+				element::NeuralFieldParameters{ 25.0, -5.0, activationFunction });
+			const auto gk = std::make_shared<element::GaussKernel>(element::ElementCommonParameters{ "gk" + suffix, dimensions },
+				element::GaussKernelParameters{});
+			const auto gs = std::make_shared<element::GaussStimulus>(element::ElementCommonParameters{ "gs" + suffix, dimensions },
+				element::GaussStimulusParameters{ 5.0, 10.0, 10.0 + static_cast<double>((instance + i * 20) % 80) });
+			const auto nn = std::make_shared<element::NormalNoise>(element::ElementCommonParameters{ "nn" + suffix, dimensions },
+				element::NormalNoiseParameters{ 0.2 });
+
+			for (const auto& element : std::initializer_list<std::shared_ptr<element::Element>>{ nf, gk, gs, nn })
+				simulation->addElement(element);
+			nf->addInput(gk);
+			gk->addInput(nf);
+			nf->addInput(gs);
+			nf->addInput(nn);
+		}
+		return simulation;
+	}
+
+	std::vector<double> getActivations(const Simulation& simulation)
+	{
+		std::vector<double> activations;
+		for (int i = 0; i < numberOfFields; i++)
+		{
+			const auto activation = simulation.getElement("nf " + std::to_string(i))->getComponent("activation");
+			activations.insert(activations.end(), activation.begin(), activation.end());
+		}
+		return activations;
+	}
+
+	double runSeparately(std::vector<std::vector<double>>& activations)
+	{
+		std::vector<std::shared_ptr<Simulation>> simulations;
+		for (size_t i = 0; i < numberOfInstances; i++)
+		{
+			simulations.push_back(buildInstance(i));
+			simulations.back()->setSeed(EnsembleSimulation::getInstanceSeed(seed, i));
+			simulations.back()->setExecutionMode(ExecutionMode::TYPE_SORTED);
+		}
+		for (const auto& simulation : simulations)
+			simulation->init();
+
+		const auto start = std::chrono::steady_clock::now();
+		for (const auto& simulation : simulations)
+			for (int i = 0; i < numberOfSteps; i++)
+				simulation->step();
+		const auto end = std::chrono::steady_clock::now();
+
+		activations.clear();
+		for (const auto& simulation : simulations)
+			activations.push_back(getActivations(*simulation));
+		return static_cast<double>(numberOfInstances * numberOfSteps) / std::chrono::duration<double>(end - start).count();
+	}
+
+	double runEnsemble(int numberOfWorkers, const std::vector<std::vector<double>>& reference, double& difference)
+	{
+		EnsembleSimulation ensemble(numberOfInstances, buildInstance, seed);
+		ensemble.setNumberOfWorkers(numberOfWorkers);
+		ensemble.init();
+		ensemble.run(numberOfSteps);
+
+		for (size_t i = 0; i < numberOfInstances; i++)
+		{
+			const auto activations = getActivations(*ensemble.getInstance(i));
+			for (size_t j = 0; j < activations.size(); j++)
+				difference = std::max(difference, std::abs(activations[j] - reference[i][j]));
+		}
+		return ensemble.getInstanceStepsPerSecond();
+	}
+}
+
+int main()
+{
+	try
+	{
+		tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::WARNING);
+
+		double bestSeparate = 0.0;
+		double bestSingleThread = 0.0;
+		double bestAllThreads = 0.0;
+		double difference = 0.0;
+		std::vector<std::vector<double>> reference;
+		for (int repetition = 0; repetition < repetitions; repetition++)
+		{
+			bestSeparate = std::max(bestSeparate, runSeparately(reference));
+			bestSingleThread = std::max(bestSingleThread, runEnsemble(1, reference, difference));
+			bestAllThreads = std::max(bestAllThreads, runEnsemble(0, reference, difference));
+		}
+
+		std::cout << numberOfInstances << " instances of " << numberOfFields * 4 << " elements, " << numberOfSteps
+			<< " steps, best of " << repetitions << " runs\n";
+		std::cout << std::left << std::setw(22) << "separate" << std::right << std::fixed << std::setprecision(0)
+			<< std::setw(12) << bestSeparate << " instance-steps/s\n";
+		std::cout << std::left << std::setw(22) << "ensemble, 1 thread" << std::right
+			<< std::setw(12) << bestSingleThread << " instance-steps/s\n";
+		std::cout << std::left << std::setw(22) << "ensemble, all threads" << std::right
+			<< std::setw(12) << bestAllThreads << " instance-steps/s\n";
+		std::cout << "largest difference in activation " << std::scientific << std::setprecision(2) << difference << '\n';
+	}
+	catch (const dnf_composer::Exception& ex)
+	{
+		const std::string errorMessage = "Exception: " + std::string(ex.what()) + " ErrorCode: " + std::to_string(static_cast<int>(ex.getErrorCode())) + ". ";
+		log(dnf_composer::tools::logger::LogLevel::FATAL, errorMessage, dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return static_cast<int>(ex.getErrorCode());
+	}
+	catch (const std::exception& ex)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Exception caught: " + std::string(ex.what()) + ". ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+	catch (...)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Unknown exception occurred. ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+}
@@ -0,0 +1,273 @@
+// Time-to-solution of the neural field integrators for the same accuracy on the bundled example architectures.
+// Runs the architectures of ex_asymmetric_gauss_kernel, ex_gauss_and_field_couplings and
+// ex_complementary_action_selection without noise and without the GUI, once with the examples' time constant
+// and once with fast fields, for every integrator over a range of step sizes. ex_two_robot_team has the
+// dynamics of ex_complementary_action_selection, and the field coupling examples read or learn their weights,
+// so they are left out.
+// The error is the largest difference in activation from a reference run with RK4 and a tiny step, sampled
+// every sampleInterval time units. Heun and RK4 step every element two and four times per step, which the
+// times include. Prints one line per run and, per integrator, the largest step size, and its time, that keeps
+// the error below the tolerance.
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <cmath>
+#include <limits>
+#include <functional>
+#include <type_traits>
+
+#include "simulation/simulation.h"
+#include "elements/neural_field.h"
+#include "elements/gauss_kernel.h"
+#include "elements/asymmetric_gauss_kernel.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/gauss_field_coupling.h"
+
+
+using namespace dnf_composer;
+
+namespace
+{
+	constexpr double simulatedTime = 200.0;
+	constexpr double sampleInterval = 10.0;
+	constexpr double referenceDeltaT = 0.01;
+	constexpr double tolerance = 0.1;
+	constexpr element::Integrator integrators[] = { element::Integrator::EULER, element::Integrator::EXPONENTIAL_EULER,
+		element::Integrator::HEUN, element::Integrator::RK4 };
+
+	using Fields = std::vector<std::shared_ptr<element::NeuralField>>;
+
+	struct Architecture
+	{
+		std::string name;
+		// adds the elements of the example, with the given field time constant and integrator,
+		// and returns the neural fields whose activation is sampled
+		std::function<Fields(Simulation&, double, element::Integrator)> build;
+	};
+
+	template <typename ElementType, typename Parameters>
+	std::shared_ptr<ElementType> add(Simulation& simulation, const std::string& name,
+		const element::ElementDimensions& dimensions, const Parameters& parameters)
+	{
+		const auto element = std::make_shared<ElementType>(element::ElementCommonParameters{ name, dimensions }, parameters);
+		simulation.addElement(element);
+		return element;
+	}
+
+	Fields buildAsymmetricGaussKernel(Simulation& simulation, double tau, element::Integrator integrator)
+	{
+		const element::ElementDimensions dimensions{ 100, 1.0 };
+		const auto nf = add<element::NeuralField>(simulation, "neural field", dimensions,
+			element::NeuralFieldParameters{ tau, -5.0, element::SigmoidFunction{ 0.0, 4.0 }, integrator });
+		const auto agk = add<element::AsymmetricGaussKernel>(simulation, "asymmetric gauss kernel", dimensions,
+			element::AsymmetricGaussKernelParameters{ 6.0, 14.0, -0.116, 0.0 });
+		const auto gs = add<element::GaussStimulus>(simulation, "gauss stimulus", dimensions,
+			element::GaussStimulusParameters{ 5.0, 15.0, 20.0 });
+		nf->addInput(gs);
+		nf->addInput(agk);
+		agk->addInput(nf);
+		return { nf };
+	}
+
+	Fields buildGaussAndFieldCouplings(Simulation& simulation, double tau, element::Integrator integrator)
+	{
+		const element::SigmoidFunction activationFunction{ 0.0, 4.0 };
+
+		const element::ElementDimensions inputDimensions{ 200, 0.7 };
+		const auto nf1 = add<element::NeuralField>(simulation, "nf 1", inputDimensions,
+			element::NeuralFieldParameters{ tau, -5.0, activationFunction, integrator });
+		const auto gk1 = add<element::GaussKernel>(simulation, "gk 1", inputDimensions, element::GaussKernelParameters{});
+		const auto gs1 = add<element::GaussStimulus>(simulation, "gs 1", inputDimensions, element::GaussStimulusParameters{ 5.0, 15.0, 60.0 });
+
+		const element::ElementDimensions outputDimensions{ 100, 1.0 };
+		const auto nf2 = add<element::NeuralField>(simulation, "nf 2", outputDimensions,
+			element::NeuralFieldParameters{ tau, -5.0, activationFunction, integrator });
+		const auto mhk2 = add<element::MexicanHatKernel>(simulation, "mhk 2", outputDimensions, element::MexicanHatKernelParameters{});
+		const auto gs2 = add<element::GaussStimulus>(simulation, "gs 2", outputDimensions, element::GaussStimulusParameters{});
+		const auto gfc = add<element::GaussFieldCoupling>(simulation, "gfc", outputDimensions,
+			element::GaussFieldCouplingParameters{ inputDimensions, true, false,
+				{ {50.0, 50.0, 5.0, 5.0}, {25.0, 75.0, 5.0, 5.0}, {75.0, 25.0, 5.0, 5.0} } });
+
+		nf1->addInput(gk1);
+		gk1->addInput(nf1);
+		nf1->addInput(gs1);
+		nf2->addInput(mhk2);
+		mhk2->addInput(nf2);
+		nf2->addInput(gs2);
+		gfc->addInput(nf1);
+		nf2->addInput(gfc);
+		return { nf1, nf2 };
+	}
+
+	Fields buildComplementaryActionSelection(Simulation& simulation, double tau, element::Integrator integrator)
+	{
+		const element::ElementDimensions dimensions{ 100, 1.0 };
+		const auto field = [&](const std::string& name)
+		{
+			return add<element::NeuralField>(simulation, name, dimensions,
+				element::NeuralFieldParameters{ tau, -10.0, element::SigmoidFunction{ 0.0, 5.0 }, integrator });
+		};
+		const auto stimulus = [&](const std::string& name, double position, const std::shared_ptr<element::NeuralField>& target)
+		{
+			target->addInput(add<element::GaussStimulus>(simulation, name, dimensions, element::GaussStimulusParameters{ 5.0, 15.0, position }));
+		};
+		// a self-excitation kernel when source and target are the same field, a coupling otherwise
+		const auto connect = [&](const std::string& name, const auto& parameters,
+			const std::shared_ptr<element::NeuralField>& source, const std::shared_ptr<element::NeuralField>& target)
+		{
+			using KernelType = std::conditional_t<std::is_same_v<std::decay_t<decltype(parameters)>, element::MexicanHatKernelParameters>,
+				element::MexicanHatKernel, element::GaussKernel>;
+			const auto kernel = add<KernelType>(simulation, name, dimensions, parameters);
+			kernel->addInput(source);
+			target->addInput(kernel);
+		};
+
+		const auto hpf = field("hand position field");
+		const auto sof = field("small object field");
+		const auto lof = field("large object field");
+		const auto aef = field("action execution field");
+		const auto sos = field("small object selection field");
+		const auto loif = field("large object integration field");
+
+		stimulus("hand position stimulus", 50.0, hpf);
+		stimulus("small object 1 stimulus", 20.0, sof);
+		stimulus("small object 2 stimulus", 80.0, sof);
+		stimulus("large object stimulus", 50.0, lof);
+
+		connect("hpf kernel", element::GaussKernelParameters{ 20.0, 2.0, -0.01 }, hpf, hpf);
+		connect("sof kernel", element::MexicanHatKernelParameters{ 5.0, 15.0, 10.0, 15.0, -0.01 }, sof, sof);
+		connect("lof kernel", element::GaussKernelParameters{ 20.0, 2.0, -0.01 }, lof, lof);
+		connect("sosf kernel", element::GaussKernelParameters{ 18.92, 23.22, -0.23 }, sos, sos);
+		connect("loif kernel", element::GaussKernelParameters{ 20.0, 2.0, -0.01 }, loif, loif);
+		connect("aef kernel", element::GaussKernelParameters{ 5.09, 7.85, -0.42 }, aef, aef);
+
+		connect("hpf - loif coupling", element::GaussKernelParameters{ 5.0, 10.47, 0.0 }, hpf, loif);
+		connect("hpf - sosf coupling", element::GaussKernelParameters{ 5.0, -6.65, 0.0 }, hpf, sos);
+		connect("sof - sosf coupling", element::GaussKernelParameters{ 2.96, 10.75, 0.0 }, sof, sos);
+		connect("lof - loif coupling", element::GaussKernelParameters{ 5.0, 10.17, 0.0 }, lof, loif);
+		connect("sosf - aef coupling", element::GaussKernelParameters{ 5.0, 26.0, 0.0 }, sos, aef);
+		connect("loif - aef coupling", element::GaussKernelParameters{ 5.0, 26.0, 0.0 }, loif, aef);
+		return { hpf, sof, lof, aef, sos, loif };
+	}
+
+	struct Run
+	{
+		// activation of all fields at every sample time
+		std::vector<std::vector<double>> samples;
+		double milliseconds;
+	};
+
+	Run run(const Architecture& architecture, double tau, element::Integrator integrator, double deltaT)
+	{
+		const auto simulation = std::make_shared<Simulation>("integrator benchmark", deltaT, 0.0, 0.0);
+		const Fields fields = architecture.build(*simulation, tau, integrator);
+
+		simulation->init();
+		Run result{ {}, 0.0 };
+		const int stepsPerSample = static_cast<int>(std::lround(sampleInterval / deltaT));
+		const int numberOfSamples = static_cast<int>(std::lround(simulatedTime / sampleInterval));
+		for (int sample = 0; sample < numberOfSamples; sample++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < stepsPerSample; i++)
+				simulation->step();
+			const auto end = std::chrono::steady_clock::now();
+			result.milliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+
+			std::vector<double> activations;
+			for (const auto& field : fields)
+			{
+				const std::vector<double> activation = field->getComponent("activation");
+				activations.insert(activations.end(), activation.begin(), activation.end());
+			}
+			result.samples.push_back(std::move(activations));
+		}
+		simulation->close();
+		return result;
+	}
+
+	double maximumError(const Run& run, const Run& reference)
+	{
+		double error = 0.0;
+		for (size_t sample = 0; sample < run.samples.size(); sample++)
+			for (size_t i = 0; i < run.samples[sample].size(); i++)
+			{
+				const double difference = std::abs(run.samples[sample][i] - reference.samples[sample][i]);
+				// a diverged run gives nan, which must not pass for accurate
+				error = std::isfinite(difference) ? std::max(error, difference) : std::numeric_limits<double>::infinity();
+			}
+		return error;
+	}
+
+	void benchmark(const Architecture& architecture, double tau)
+	{
+		const Run reference = run(architecture, tau, element::Integrator::RK4, referenceDeltaT);
+		std::cout << '\n' << architecture.name << ", tau = " << std::fixed << std::setprecision(1) << tau << ", reference (RK4, deltaT = " << std::setprecision(2) << referenceDeltaT
+			<< ") took " << reference.milliseconds << " ms\n";
+		std::cout << std::left << std::setw(20) << "integrator" << std::right << std::setw(10) << "deltaT"
+			<< std::setw(14) << "max error" << std::setw(12) << "time ms" << '\n';
+
+		std::map<element::Integrator, std::pair<double, double>> best;
+		for (const auto integrator : integrators)
+		{
+			for (const double deltaT : { 0.1, 0.25, 0.5, 1.0, 2.0, 2.5, 5.0, 10.0 })
+			{
+				const Run result = run(architecture, tau, integrator, deltaT);
+				const double error = maximumError(result, reference);
+				std::cout << std::left << std::setw(20) << element::IntegratorToString.at(integrator)
+					<< std::right << std::setw(10) << std::fixed << std::setprecision(2) << deltaT
+					<< std::setw(14) << std::scientific << std::setprecision(2) << error
+					<< std::setw(12) << std::fixed << std::setprecision(2) << result.milliseconds << '\n';
+				if (error <= tolerance)
+					best[integrator] = { deltaT, result.milliseconds };
+			}
+		}
+
+		std::cout << "largest deltaT with max error <= " << tolerance << ":\n";
+		for (const auto integrator : integrators)
+		{
+			std::cout << "  " << std::left << std::setw(20) << element::IntegratorToString.at(integrator) << std::right;
+			// no step size may be accurate enough, e.g. when a field selects another stimulus than in the reference
+			if (!best.contains(integrator))
+				std::cout << " none\n";
+			else
+				std::cout << " deltaT = " << std::fixed << std::setprecision(2) << best.at(integrator).first
+					<< ", " << best.at(integrator).second << " ms\n";
+		}
+	}
+}
+
+int main()
+{
+	try
+	{
+		tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::WARNING);
+		const std::vector<Architecture> architectures{
+			{ "asymmetric gauss kernel", buildAsymmetricGaussKernel },
+			{ "gauss and field couplings", buildGaussAndFieldCouplings },
+			{ "complementary action selection", buildComplementaryActionSelection } };
+		// the time constant of the examples, and fast fields, for which explicit Euler needs a small deltaT
+		for (const auto& architecture : architectures)
+			for (const double tau : { 25.0, 2.0 })
+				benchmark(architecture, tau);
+	}
+	catch (const dnf_composer::Exception& ex)
+	{
+		const std::string errorMessage = "Exception: " + std::string(ex.what()) + " ErrorCode: " + std::to_string(static_cast<int>(ex.getErrorCode())) + ". ";
+		log(dnf_composer::tools::logger::LogLevel::FATAL, errorMessage, dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return static_cast<int>(ex.getErrorCode());
+	}
+	catch (const std::exception& ex)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Exception caught: " + std::string(ex.what()) + ". ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+	catch (...)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Unknown exception occurred. ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+}
@@ -0,0 +1,120 @@
+// Headless parameter sweep over a simulation saved by the SimulationFileManager.
+// With arguments, runs the sweep they describe:
+//     ex_parameter_sweep <simulation file> <sweep specification file> <result file> [number of workers]
+// see ParameterSweep::readSpecification for the format of the specification.
+// Without arguments, saves a small architecture, a field with a self-excitatory kernel, a stimulus and noise,
+// sweeps the time scale of the field against the position of the stimulus, and then sweeps an extended grid,
+// of which only the new points are run, the others are read from the result file.
+
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+
+#include "simulation/simulation.h"
+#include "simulation/parameter_sweep.h"
+#include "elements/neural_field.h"
+#include "elements/gauss_kernel.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/normal_noise.h"
+
+
+using namespace dnf_composer;
+
+namespace
+{
+	void printResults(const ParameterSweep& sweep, const std::vector<SweepPointResult>& results)
+	{
+		size_t numberOfCachedPoints = 0;
+		for (const SweepPointResult& result : results)
+		{
+			numberOfCachedPoints += result.cached ? 1 : 0;
+			for (size_t i = 0; i < result.values.size(); i++)
+				std::cout << sweep.getSpecification().parameters[i].elementName << "." << sweep.getSpecification().parameters[i].parameterName
+					<< " = " << std::setw(6) << result.values[i] << "  ";
+			for (const SweepFieldMetrics& field : result.fields)
+			{
+				std::cout << field.fieldName << ": " << field.numberOfBumps << " bump(s)";
+				for (const double centroid : field.centroids)
+					std::cout << " at " << centroid;
+				std::cout << ", stable from t = " << field.timeToStability << "  ";
+			}
+			std::cout << (result.cached ? "(cached)" : "") << '\n';
+		}
+		std::cout << results.size() << " points, " << numberOfCachedPoints << " read from the result file\n\n";
+	}
+
+	std::string saveExampleSimulation(const std::string& directory)
+	{
+		const auto simulation = std::make_shared<Simulation>("parameter sweep example", 1.0, 0.0, 0.0);
+		const element::ElementDimensions dimensions{ 100, 1.0 };
+		const auto nf = std::make_shared<element::NeuralField>(element::ElementCommonParameters{ "nf", dimensions },
+			element::NeuralFieldParameters{ 20.0, -5.0, element::SigmoidFunction{ 0.0, 4.0 } });
+		const auto gk = std::make_shared<element::GaussKernel>(element::ElementCommonParameters{ "gk", dimensions },
+			element::GaussKernelParameters{ 3.0, 10.0 });
+		const auto gs = std::make_shared<element::GaussStimulus>(element::ElementCommonParameters{ "gs", dimensions },
+			element::GaussStimulusParameters{ 5.0, 8.0, 50.0 });
+		const auto nn = std::make_shared<element::NormalNoise>(element::ElementCommonParameters{ "nn", dimensions },
+			element::NormalNoiseParameters{ 0.2 });
+		for (const auto& element : std::initializer_list<std::shared_ptr<element::Element>>{ nf, gk, gs, nn })
+			simulation->addElement(element);
+		nf->addInput(gk);
+		gk->addInput(nf);
+		nf->addInput(gs);
+		nf->addInput(nn);
+
+		simulation->save(directory);
+		return directory + simulation->getUniqueIdentifier() + ".json";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::WARNING);
+
+		if (argc >= 4)
+		{
+			ParameterSweep sweep(argv[1], ParameterSweep::readSpecification(argv[2]), argv[3]);
+			if (argc >= 5)
+				sweep.setNumberOfWorkers(std::stoi(argv[4]));
+			printResults(sweep, sweep.run());
+			return 0;
+		}
+
+		const std::string directory = std::string(OUTPUT_DIRECTORY) + "/simulations/";
+		std::filesystem::create_directories(directory);
+		const std::string simulationFilePath = saveExampleSimulation(directory);
+		const std::string resultFilePath = directory + "parameter sweep example results.jsonl";
+		std::filesystem::remove(resultFilePath);
+
+		SweepSpecification specification;
+		specification.runTime = 300.0;
+		specification.seed = 1;
+		specification.parameters = { { "nf", "tau", { 10.0, 20.0 } }, { "gs", "position", { 20.0, 40.0, 60.0, 80.0 } } };
+		ParameterSweep sweep(simulationFilePath, specification, resultFilePath);
+		std::cout << "Sweep of " << sweep.getPoints().size() << " points\n";
+		printResults(sweep, sweep.run());
+
+		specification.parameters[0].values.push_back(40.0);
+		ParameterSweep extendedSweep(simulationFilePath, specification, resultFilePath);
+		std::cout << "Extended sweep of " << extendedSweep.getPoints().size() << " points\n";
+		printResults(extendedSweep, extendedSweep.run());
+	}
+	catch (const dnf_composer::Exception& ex)
+	{
+		const std::string errorMessage = "Exception: " + std::string(ex.what()) + " ErrorCode: " + std::to_string(static_cast<int>(ex.getErrorCode())) + ". ";
+		log(dnf_composer::tools::logger::LogLevel::FATAL, errorMessage, dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return static_cast<int>(ex.getErrorCode());
+	}
+	catch (const std::exception& ex)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Exception caught: " + std::string(ex.what()) + ". ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+	catch (...)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Unknown exception occurred. ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+}
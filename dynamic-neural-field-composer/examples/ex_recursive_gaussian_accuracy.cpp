@@ -0,0 +1,150 @@
+// Accuracy and cost of the recursive Gaussian convolution compared to the direct convolution.
+// Runs without the GUI and prints one line per configuration: the error and cost of the recursive filters
+// whatever their error, where they are faster than the direct convolution, and the path a kernel in the
+// recursive mode ends up using with the default maximum error: the recursive filters, or the direct or
+// FFT convolution where those are faster or the recursive error would be too large.
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+#include "simulation/simulation.h"
+#include "elements/gauss_kernel.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/normal_noise.h"
+
+
+using namespace dnf_composer;
+
+namespace
+{
+	struct Measurement
+	{
+		double maxError;
+		double maxValue;
+		double directTime;
+		double recursiveTime;
+		bool filtered;
+		std::string path;
+	};
+
+	// steps copies of the same kernel, fed by the same stimulus and noise, one convolved directly
+	// and the other recursively whatever the error, and compares their outputs
+	template <typename KernelType, typename Parameters>
+	Measurement measure(int size, const Parameters& parameters, int steps)
+	{
+		Simulation simulation("recursive gaussian accuracy", 1.0, 0.0, 0.0);
+		simulation.setSeed(1);
+		const element::ElementDimensions dimensions{ size, 1.0 };
+
+		const auto stimulus = std::make_shared<element::GaussStimulus>(element::ElementCommonParameters{ "stimulus", dimensions },
+			element::GaussStimulusParameters{ 3.0, 10.0, size / 3.0 });
+		const auto noise = std::make_shared<element::NormalNoise>(element::ElementCommonParameters{ "noise", dimensions },
+			element::NormalNoiseParameters{ 1.0 });
+		const auto direct = std::make_shared<KernelType>(element::ElementCommonParameters{ "direct", dimensions }, parameters);
+		const auto recursive = std::make_shared<KernelType>(element::ElementCommonParameters{ "recursive", dimensions }, parameters);
+		direct->setConvolutionMode(element::ConvolutionMode::DIRECT);
+		recursive->setConvolutionMode(element::ConvolutionMode::RECURSIVE);
+		recursive->setMaximumRecursiveError(std::numeric_limits<double>::infinity());
+		const auto chosen = std::make_shared<KernelType>(element::ElementCommonParameters{ "chosen", dimensions }, parameters);
+		chosen->setConvolutionMode(element::ConvolutionMode::RECURSIVE);
+
+		for (const auto& element : std::initializer_list<std::shared_ptr<element::Element>>{ stimulus, noise, direct, recursive, chosen })
+			simulation.addElement(element);
+		for (const auto& kernel : std::initializer_list<std::shared_ptr<element::Element>>{ direct, recursive, chosen })
+		{
+			kernel->addInput(stimulus);
+			kernel->addInput(noise);
+		}
+		simulation.init();
+
+		Measurement measurement{ 0.0, 0.0, 0.0, 0.0, recursive->isUsingRecursiveConvolution(),
+			chosen->isUsingRecursiveConvolution() ? "recursive" : chosen->isUsingFftConvolution() ? "fft" : "direct" };
+		for (int i = 0; i < steps; i++)
+		{
+			simulation.t += simulation.deltaT;
+			stimulus->step(simulation.t, simulation.deltaT);
+			noise->step(simulation.t, simulation.deltaT);
+
+			auto start = std::chrono::steady_clock::now();
+			direct->step(simulation.t, simulation.deltaT);
+			auto end = std::chrono::steady_clock::now();
+			measurement.directTime += std::chrono::duration<double, std::micro>(end - start).count() / steps;
+
+			start = std::chrono::steady_clock::now();
+			recursive->step(simulation.t, simulation.deltaT);
+			end = std::chrono::steady_clock::now();
+			measurement.recursiveTime += std::chrono::duration<double, std::micro>(end - start).count() / steps;
+
+			const auto* directOutput = direct->getComponentPtr("output");
+			const auto* recursiveOutput = recursive->getComponentPtr("output");
+			for (size_t j = 0; j < directOutput->size(); j++)
+			{
+				measurement.maxError = std::max(measurement.maxError, std::abs((*directOutput)[j] - (*recursiveOutput)[j]));
+				measurement.maxValue = std::max(measurement.maxValue, std::abs((*directOutput)[j]));
+			}
+		}
+		return measurement;
+	}
+
+	void report(const std::string& kernel, int size, double width, bool circular, const Measurement& measurement)
+	{
+		std::cout << std::left << std::setw(12) << kernel
+			<< std::right << std::setw(6) << size
+			<< std::setw(8) << std::fixed << std::setprecision(1) << width
+			<< std::setw(10) << (circular ? "circular" : "bounded");
+		// where the direct convolution is faster the filters are not used at all
+		if (measurement.filtered)
+			std::cout << std::setw(14) << std::scientific << std::setprecision(2) << measurement.maxError
+				<< std::setw(14) << measurement.maxError / measurement.maxValue
+				<< std::setw(14) << std::fixed << std::setprecision(1) << measurement.directTime
+				<< std::setw(14) << measurement.recursiveTime;
+		else
+			std::cout << std::setw(14) << "-" << std::setw(14) << "-"
+				<< std::setw(14) << std::fixed << std::setprecision(1) << measurement.directTime << std::setw(14) << "-";
+		std::cout << std::setw(11) << measurement.path << '\n';
+	}
+}
+
+int main()
+{
+	try
+	{
+		// the path column shows where the recursive convolution is not used, without the warnings
+		tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+		constexpr int steps = 20;
+
+		std::cout << std::left << std::setw(12) << "kernel" << std::right << std::setw(6) << "size" << std::setw(8) << "width"
+			<< std::setw(10) << "boundary" << std::setw(14) << "max abs error" << std::setw(14) << "max rel error"
+			<< std::setw(14) << "direct us" << std::setw(14) << "recursive us" << std::setw(11) << "path" << '\n';
+
+		for (const int size : { 100, 500, 2000 })
+			for (const double width : { 1.0, 3.0, 10.0, 30.0, 100.0 })
+				for (const bool circular : { true, false })
+				{
+					const auto gaussParameters = element::GaussKernelParameters{ width, 3.0, 0.0, circular, true };
+					report("gauss", size, width, circular, measure<element::GaussKernel>(size, gaussParameters, steps));
+
+					const auto mexicanHatParameters = element::MexicanHatKernelParameters{ width, 11.0, 2.0 * width, 15.0, 0.0, circular, true };
+					report("mexican hat", size, width, circular, measure<element::MexicanHatKernel>(size, mexicanHatParameters, steps));
+				}
+	}
+	catch (const dnf_composer::Exception& ex)
+	{
+		const std::string errorMessage = "Exception: " + std::string(ex.what()) + " ErrorCode: " + std::to_string(static_cast<int>(ex.getErrorCode())) + ". ";
+		log(dnf_composer::tools::logger::LogLevel::FATAL, errorMessage, dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return static_cast<int>(ex.getErrorCode());
+	}
+	catch (const std::exception& ex)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Exception caught: " + std::string(ex.what()) + ". ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+	catch (...)
+	{
+		log(dnf_composer::tools::logger::LogLevel::FATAL, "Unknown exception occurred. ", dnf_composer::tools::logger::LogOutputMode::CONSOLE);
+		return 1;
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <atomic>
 #include <string>
 #include <format>
 
@@ -50,7 +51,8 @@ namespace dnf_composer
 
 		struct ElementIdentifiers
 		{
-			static inline int uniqueIdentifierCounter = 0;
+			// elements may be constructed by several threads at once, e.g. by a parameter sweep
+			static inline std::atomic<int> uniqueIdentifierCounter = 0;
 			int uniqueIdentifier;
 			std::string uniqueName;
 			ElementLabel label;
@@ -66,6 +68,9 @@ namespace dnf_composer
 		{
 			ElementIdentifiers identifiers;
 			ElementDimensions dimensionParameters;
+			// the element is stepped every stepPeriod-th simulation step, over stepPeriod times deltaT,
+			// in between its components keep the values of its last step
+			int stepPeriod = 1;
 
 			ElementCommonParameters();
 			ElementCommonParameters(ElementLabel label);
@@ -4,6 +4,7 @@
 
 #include "tools/logger.h"
 #include "tools/math.h"
+#include "tools/simd.h"
 
 namespace dnf_composer
 {
@@ -15,13 +16,23 @@ namespace dnf_composer
 			HEAVISIDE,
 		};
 
+		enum class ExpApproximation : int
+		{
+			// std::exp, correctly rounded or close to it
+			EXACT,
+			// vectorized polynomial, relative error below tools::simd::polynomialExpMaxRelativeError
+			POLYNOMIAL
+		};
+
 		struct ActivationFunction
 		{
 			ActivationFunctionType type;
 			ActivationFunction() = default;                                 
 			ActivationFunction(const ActivationFunction&) = default;
 			ActivationFunction& operator=(const ActivationFunction&) = delete;
-			virtual std::vector<double> operator()(const std::vector<double>& input) = 0;
+			virtual std::vector<double> operator()(std::span<const double> input) = 0;
+			// writes the result to output, which must have the size of input
+			virtual void operator()(std::span<const double> input, std::span<double> output) = 0;
 			virtual bool operator==(const ActivationFunction& other) const = 0;
 			virtual std::unique_ptr<ActivationFunction> clone() const = 0;
 			virtual std::string toString() const = 0;
@@ -30,14 +41,18 @@ namespace dnf_composer
 
 		};
 
-		struct SigmoidFunction : public ActivationFunction
+		// final, like HeavisideFunction, since a neural field inlines evaluate() in place of the virtual call
+		// for an activation function of exactly this type
+		struct SigmoidFunction final : public ActivationFunction
 		{
 			double x_shift, steepness;
+			ExpApproximation expApproximation;
 
 			SigmoidFunction(const SigmoidFunction&) = default;
-			SigmoidFunction(double x_shift, double steepness);
+			SigmoidFunction(double x_shift, double steepness, ExpApproximation expApproximation = ExpApproximation::EXACT);
 
-			std::vector<double> operator()(const std::vector<double>& input) override;
+			std::vector<double> operator()(std::span<const double> input) override;
+			void operator()(std::span<const double> input, std::span<double> output) override;
 			bool operator==(const ActivationFunction& other) const override;
 			std::unique_ptr<ActivationFunction> clone() const override;
 			std::string toString() const override;
@@ -45,25 +60,41 @@ namespace dnf_composer
 
 			double getSteepness() const;
 			double getXShift() const;
+			ExpApproximation getExpApproximation() const;
+			void setExpApproximation(ExpApproximation approximation);
+			// for kernels that know the concrete type and want the call inlined
+			double evaluate(double x) const { return 1 / (1 + std::exp(-steepness * (x - x_shift))); }
+			void evaluate(std::span<const double> input, std::span<double> output) const
+			{
+				if (expApproximation == ExpApproximation::POLYNOMIAL)
+					tools::simd::polynomialSigmoid(input, steepness, x_shift, output);
+				else
+					for (size_t i = 0; i < input.size(); i++)
+						output[i] = evaluate(input[i]);
+			}
 
 			~SigmoidFunction() override = default;
 
 		};
 
-		struct HeavisideFunction : public ActivationFunction
+		struct HeavisideFunction final : public ActivationFunction
 		{
 			double x_shift;
 
 			HeavisideFunction(const HeavisideFunction&) = default;
 			HeavisideFunction(double x_shift);
 
-			std::vector<double> operator()(const std::vector<double>& input) override;
+			std::vector<double> operator()(std::span<const double> input) override;
+			void operator()(std::span<const double> input, std::span<double> output) override;
 			bool operator==(const ActivationFunction& other) const override;
 			std::unique_ptr<ActivationFunction> clone() const override;
 			std::string toString() const override;
 			void print() const override;
 
 			double getXShift() const;
+			// for kernels that know the concrete type and want the call inlined
+			double evaluate(double x) const { return (x > x_shift) ? 1 : 0; }
+			void evaluate(std::span<const double> input, std::span<double> output) const { tools::simd::heaviside(input, x_shift, output); }
 
 			~HeavisideFunction() override = default;
 		};
@@ -62,6 +62,7 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::string toString() const override;
 			std::shared_ptr<Element> clone() const override;
+			double getAmplitudeGlobal() const override { return parameters.amplitudeGlobal; }
 
 			void setParameters(const AsymmetricGaussKernelParameters& gk_parameters);
 			AsymmetricGaussKernelParameters getParameters() const;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory_resource>
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		// Component buffers use a polymorphic allocator so the simulation can place them in its arena.
+		using Component = std::pmr::vector<double>;
+
+		// The standard components every element type is built from.
+		// They are stored in fixed slots, so the elements access them without any lookup.
+		enum class ComponentSlot : int
+		{
+			INPUT,
+			OUTPUT,
+			ACTIVATION,
+			RESTING_LEVEL,
+			KERNEL,
+			WEIGHTS,
+			COUNT
+		};
+
+		inline const std::array<std::string, static_cast<size_t>(ComponentSlot::COUNT)> ComponentSlotToString = {
+			"input",
+			"output",
+			"activation",
+			"resting level",
+			"kernel",
+			"weights"
+		};
+
+		// Storage of the components of an element.
+		// Standard components live in fixed slots and are accessed by ComponentSlot (fast path).
+		// Components are also reachable by name (slow path, used by the GUI and file I/O),
+		// a name that is not a standard component is kept in a separate map.
+		// Component vectors never move once created, so pointers to them stay valid,
+		// even when relocate() moves their contents to another memory resource.
+		class ComponentStorage
+		{
+		private:
+			std::array<Component, static_cast<size_t>(ComponentSlot::COUNT)> slots;
+			std::array<bool, static_cast<size_t>(ComponentSlot::COUNT)> present;
+			std::unordered_map<std::string, Component> extraComponents;
+		public:
+			ComponentStorage();
+
+			Component& operator[](ComponentSlot slot)
+			{
+				present[static_cast<size_t>(slot)] = true;
+				return slots[static_cast<size_t>(slot)];
+			}
+			Component& operator[](const std::string& componentName);
+
+			Component& at(ComponentSlot slot);
+			const Component& at(ComponentSlot slot) const;
+			Component& at(const std::string& componentName);
+			const Component& at(const std::string& componentName) const;
+
+			bool contains(ComponentSlot slot) const { return present[static_cast<size_t>(slot)]; }
+			bool contains(const std::string& componentName) const;
+			size_t size() const;
+			std::vector<std::string> getNames() const;
+			// moves the contents of every component to buffers allocated from the given resource,
+			// components already allocated from it stay where they are
+			void relocate(std::pmr::memory_resource* resource);
+			void relocate(ComponentSlot slot, std::pmr::memory_resource* resource);
+			// bytes of component buffers, each buffer rounded up to the given alignment
+			size_t getFootprint(size_t alignment = 1) const;
+
+			template <typename Function>
+			void forEach(Function&& function)
+			{
+				for (size_t i = 0; i < slots.size(); i++)
+					if (present[i])
+						function(ComponentSlotToString[i], slots[i]);
+				for (auto& [componentName, component] : extraComponents)
+					function(componentName, component);
+			}
+
+			template <typename Function>
+			void forEach(Function&& function) const
+			{
+				for (size_t i = 0; i < slots.size(); i++)
+					if (present[i])
+						function(ComponentSlotToString[i], slots[i]);
+				for (const auto& [componentName, component] : extraComponents)
+					function(componentName, component);
+			}
+
+			static bool isStandardComponent(const std::string& componentName, ComponentSlot& slot);
+		};
+	}
+}
@@ -7,22 +7,93 @@
 #include <ranges>
 #include <algorithm>
 #include <numeric>
+#include <cstdint>
+#include <span>
 
 #include "exceptions/exception.h"
 #include "tools/logger.h"
 #include "element_parameters/element_parameters.h"
+#include "elements/component_storage.h"
+#include "elements/shared_input_sum.h"
+#include "tools/arena.h"
+#include "tools/thread_pool.h"
 
 namespace dnf_composer
 {
 	namespace element
 	{
+		// Copy of what a step changes in an element, so the element can be stepped again from the same point.
+		// The buffers are reused by the next save, which then does not allocate.
+		struct ElementState
+		{
+			std::vector<std::vector<double>> components;
+			std::vector<std::vector<double>> publishedComponents;
+			// element specific, for instance the position of a random sequence
+			std::vector<std::uint64_t> counters;
+		};
+
+		// Bookkeeping of the simulation, which skips an element while neither its state nor its inputs change.
+		// Steps are counted from the initialization of the simulation, -1 is before the first one.
+		struct StepRecord
+		{
+			// the last step the element was stepped at, and the last one its state changed at
+			std::int64_t lastStep = -1;
+			std::int64_t lastChange = -1;
+			// lastChange when the components were last published, what the readers of published components see
+			std::int64_t publishedLastChange = -1;
+			// the state when it last changed
+			std::vector<double> reference;
+			// the stage of the step being taken, a multi-stage integrator steps the elements again in every stage
+			// after the first, each time at the state the neural fields reached in the stage before
+			int stage = 0;
+		};
+
+		class Element;
+
+		// An input as the element reads it during a step: the component the source element publishes.
+		// Component vectors never move, so the pointer stays valid while the connection exists.
+		struct InputSource
+		{
+			const Element* element;
+			const Component* component;
+		};
+
+		// out[i] = the sum of the sources that reach i, added in the order of the sources,
+		// pointers is scratch space for one pointer per source
+		void sumInputSources(std::span<const InputSource> sources, std::span<const double*> pointers, std::span<double> out);
+
 		class Element : public std::enable_shared_from_this<Element>
 		{
 		protected:
 			ElementCommonParameters commonParameters;
-			std::unordered_map<std::string, std::vector<double>> components;
+			// keeps the memory the components are allocated from alive, it must outlive them
+			std::shared_ptr<tools::memory::Arena> componentArena;
+			ComponentStorage components;
 			std::unordered_map<std::shared_ptr<Element>, std::string> inputs;
 			std::unordered_map<std::shared_ptr<Element>, std::string> outputs;
+			// in double-buffered mode other elements read these copies of the components,
+			// which hold the state of the previous step while the element writes the current one
+			ComponentStorage publishedComponents;
+			bool doubleBuffered;
+			// whether the last publishing swapped the transient components, which leaves the previous values in the element
+			bool transientComponentsSwapped;
+			// parameter revision the published constant components were copied at
+			std::uint64_t publishedParameterRevision;
+			// pool the element may split its own work over, null when the simulation steps serially
+			tools::threading::ThreadPool* threadPool;
+			StepRecord stepRecord;
+			// set by the simulation when other elements read the same inputs
+			std::shared_ptr<SharedInputSum> sharedInputSum;
+			// the inputs flattened for the step, compiled by the simulation with its execution plan
+			// whenever a connection changes, so a step sums them without any lookup
+			std::vector<InputSource> inputGather;
+			std::vector<const double*> inputGatherPointers;
+			std::uint64_t inputGatherRevision;
+			// incremented every time the inputs of the element change, or the components it reads from them move,
+			// a simulation sums the revisions of its own elements, so changes elsewhere do not concern it
+			std::uint64_t connectionRevision;
+			// incremented every time the parameters of the element change, summed by the simulation like the connection revision
+			std::uint64_t parameterRevision;
 		public:
 			Element(const ElementCommonParameters& parameters);
 
@@ -33,6 +104,29 @@ namespace dnf_composer
 			virtual std::string toString() const = 0;
 			void close();
 			void print() const;
+			virtual bool isDelayPoint() const;
+			// a transient component is entirely rewritten by every step, so its buffers can be swapped instead of copied
+			virtual bool isTransientComponent(const std::string& componentName) const;
+			// a constant component is never changed by a step, so it is left out of the saved state
+			virtual bool isConstantComponent(const std::string& componentName) const;
+			virtual void saveState(ElementState& state) const;
+			// a static element always has the same outputs, they only change with its parameters
+			virtual bool isStatic() const;
+			// an observable element has a state of its own that matters even when nothing reads its outputs
+			virtual bool isObservable() const;
+			// whether the element may hold its outputs instead of being stepped while its inputs do not change,
+			// which an element whose outputs change on their own, such as noise, must not
+			virtual bool canHoldOutputs() const;
+			// the component the state of the element is judged on, for instance to tell whether it changed
+			virtual ComponentSlot getStateSlot() const;
+			virtual void restoreState(const ElementState& state);
+			// stochastic elements derive their random sequence from the simulation seed and their unique name
+			virtual void setRandomSeed(std::uint64_t seed);
+			// called before a component is handed out, elements that only compute a component on demand do it here
+			virtual void prepareComponent(const std::string& componentName);
+			// whether the element reads its inputs through gatherInput(), which only writes the input component
+			// when the inputs have to be summed
+			virtual bool isReadingInputView() const;
 
 			virtual void addInput(const std::shared_ptr<Element>& inputElement, 
 				const std::string& inputComponent = "output");
@@ -42,6 +136,33 @@ namespace dnf_composer
 			bool hasInput(const std::string& inputElementName, const std::string& inputComponent);
 			bool hasInput(int inputElementId, const std::string& inputComponent);
 			void updateInput();
+			// sums the inputs through the connections themselves, outside a step the gather may not be compiled yet
+			void updateInputFromConnections();
+			void setDoubleBuffered(bool doubleBuffered);
+			bool isDoubleBuffered() const;
+			// swapping trades the buffers of the transient components, which is only right when the element is stepped
+			// next and writes them again, otherwise they are copied
+			void publishComponents(bool swapping = true);
+			// gives back the values a swap took to the published components, for an element that is not stepped after all
+			void keepPublishedComponents();
+			void relocateComponents(const std::shared_ptr<tools::memory::Arena>& arena);
+			// moves only the component in this slot, the others follow when all of them are relocated to the same arena
+			void relocateComponents(const std::shared_ptr<tools::memory::Arena>& arena, ComponentSlot slot);
+			size_t getComponentFootprint() const;
+			void setThreadPool(tools::threading::ThreadPool* threadPool);
+			void setSharedInputSum(const std::shared_ptr<SharedInputSum>& sum);
+			// resolves the component every input publishes, the simulation does it when it compiles its execution plan
+			void compileInputGather();
+			const std::vector<InputSource>& getInputGather() const;
+			bool isInputGatherUpToDate() const;
+			StepRecord& getStepRecord() { return stepRecord; }
+			const StepRecord& getStepRecord() const { return stepRecord; }
+			// marks the element as changed outside of a step, for instance by new parameters, so the simulation
+			// steps it and the elements that read it even if they were quiescent
+			void wake();
+			// whether the state of any input changed at or after the given step,
+			// as seen through the published components when published is set
+			bool haveInputsChangedSince(std::int64_t step, bool published) const;
 			void removeOutput(const std::string& outputElementId);
 			void removeOutput(int uniqueId);
 			void removeOutputs();
@@ -52,6 +173,8 @@ namespace dnf_composer
 			int getSize() const;
 			double getStepSize() const;
 			ElementCommonParameters getElementCommonParameters() const;
+			void setStepPeriod(int stepPeriod);
+			int getStepPeriod() const;
 			int getUniqueIdentifier() const;
 			std::string getUniqueName() const;
 			ElementLabel getLabel() const;
@@ -59,13 +182,27 @@ namespace dnf_composer
 			bool hasInput() const;
 
 			std::vector<double> getComponent(const std::string& componentName);
-			std::vector<double>* getComponentPtr(const std::string& componentName);
+			Component* getComponentPtr(const std::string& componentName);
 			std::vector<std::string> getComponentList() const;
-			const std::unordered_map<std::string, std::vector<double>>* getComponents() const;
+			const ComponentStorage* getComponents() const;
+			const Component& getPublishedComponent(const std::string& componentName) const;
 
 			std::vector<std::shared_ptr<Element>> getInputs();
 			std::unordered_map<std::shared_ptr<Element>, std::string> getInputsAndComponents();
+			// the inputs ordered by unique name, the order every sum over them adds them in,
+			// so the result depends neither on hashing nor on the order the connections were made in
+			std::vector<std::pair<std::shared_ptr<Element>, std::string>> getOrderedInputs() const;
 			std::vector<std::shared_ptr<Element>> getOutputs();
+
+			std::uint64_t getConnectionRevision() const { return connectionRevision; }
+			std::uint64_t getParameterRevision() const { return parameterRevision; }
+		protected:
+			void notifyConnectionChange();
+			// wakes the element and counts the change in its parameter revision
+			void notifyParameterChange();
+			// the first size values of the sum of the inputs, a single input of that size is read in place
+			// and a sum shared with other elements is computed once
+			std::span<const double> gatherInput(size_t size);
 		};
 	}
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <variant>
+#include <span>
+
+#include "elements/element.h"
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		class NeuralField;
+		class GaussStimulus;
+		class GaussKernel;
+		class MexicanHatKernel;
+		class OscillatoryKernel;
+		class AsymmetricGaussKernel;
+		class NormalNoise;
+		class FieldCoupling;
+		class GaussFieldCoupling;
+
+		// Elements of one concrete class, stepped one after the other. A batch of a known class is stepped through
+		// non-virtual calls to that class, so the calls are direct and may be inlined; elements of any other class,
+		// e.g. a class derived from one of these, are kept in the first alternative and stepped through Element.
+		using ElementBatch = std::variant<
+			std::vector<Element*>,
+			std::vector<NeuralField*>,
+			std::vector<GaussStimulus*>,
+			std::vector<GaussKernel*>,
+			std::vector<MexicanHatKernel*>,
+			std::vector<OscillatoryKernel*>,
+			std::vector<AsymmetricGaussKernel*>,
+			std::vector<NormalNoise*>,
+			std::vector<FieldCoupling*>,
+			std::vector<GaussFieldCoupling*>>;
+
+		// index of the alternative of ElementBatch that holds elements of the class of this element
+		size_t getBatchIndex(const Element& element);
+		// the elements must all have the given batch index
+		ElementBatch makeBatch(size_t batchIndex, std::span<Element* const> elements);
+	}
+}
+
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <set>
+#include <sstream>
 
 #include "tools/math.h"
+#include "tools/sparse_weights.h"
 #include "element.h"
 #include "neural_field.h"
 #include "tools/utils.h"
@@ -32,13 +34,16 @@ namespace dnf_composer
 			double scalar;
 			double learningRate;
 			bool isLearningActive;
+			// the weights are updated every learningPeriod-th step of the coupling, by learningPeriod times
+			// the learning rate, so they change as fast as when updated every step
+			int learningPeriod;
 
 			FieldCouplingParameters(const ElementDimensions& inputFieldDimensions = ElementDimensions{},
 				LearningRule learningRule = LearningRule::HEBB,
-				double scalar = 1.0, double learningRate = 0.01)
+				double scalar = 1.0, double learningRate = 0.01, int learningPeriod = 1)
 					: inputFieldDimensions(inputFieldDimensions),
 				learningRule(learningRule), scalar(scalar),
-				learningRate(learningRate), isLearningActive(false)
+				learningRate(learningRate), isLearningActive(false), learningPeriod(learningPeriod)
 			{}
 
 			bool operator==(const FieldCouplingParameters& other) const
@@ -49,7 +54,8 @@ namespace dnf_composer
 					std::abs(inputFieldDimensions.d_x - other.inputFieldDimensions.d_x) < epsilon &&
 					learningRule == other.learningRule &&
 					std::abs(scalar - other.scalar) < epsilon &&
-					std::abs(learningRate - other.learningRate) < epsilon;
+					std::abs(learningRate - other.learningRate) < epsilon &&
+					learningPeriod == other.learningPeriod;
 			}
 
 			std::string toString() const override
@@ -60,6 +66,7 @@ namespace dnf_composer
 					<< "Input field dimensions: " << inputFieldDimensions.toString() << ", "
 					<< "Learning rule: " << LearningRuleToString.at(learningRule) << ", "
 					<< "Learning rate: " << learningRate << ", "
+					<< "Learning period: " << learningPeriod << ", "
 					<< "Scalar: " << scalar
 					<< "]";
 				return result.str();
@@ -73,6 +80,16 @@ namespace dnf_composer
 			std::shared_ptr<Element> input;
 			std::shared_ptr<Element> output;
 			std::string weightsDirectory;
+			// scratch buffers for the normalized activations used by the learning rules
+			std::vector<double> normalizedInputActivation;
+			std::vector<double> normalizedOutputActivation;
+			// compressed copy of the weights the output is computed from, the weights component stays the
+			// reference and the copy is rebuilt whenever the weights are replaced or learning stops
+			tools::math::SparseWeights sparseWeights;
+			double weightThreshold;
+			bool sparseWeightsUpToDate;
+			// steps taken while learning, the weights are updated when it is a multiple of the learning period
+			std::uint64_t learningStepCount;
 		public:
 			FieldCoupling(const ElementCommonParameters& elementCommonParameters, 
 				const FieldCouplingParameters& fc_parameters);
@@ -81,13 +98,31 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::string toString() const override;
 			std::shared_ptr<Element> clone() const override;
+			bool isTransientComponent(const std::string& componentName) const override { return componentName == "input" || componentName == "output"; }
+			// the weights only change while learning
+			bool isConstantComponent(const std::string& componentName) const override { return componentName == "weights" && !parameters.isLearningActive; }
+			bool canHoldOutputs() const override { return !parameters.isLearningActive; }
+			bool isReadingInputView() const override { return true; }
+			// learnt weights matter even if nothing reads the output
+			bool isObservable() const override { return parameters.isLearningActive; }
+
+			void saveState(ElementState& state) const override;
+			void restoreState(const ElementState& state) override;
 
 			void setLearningRate(double learningRate);
+			void setLearningPeriod(int learningPeriod);
 			void setLearning(bool learning);
 			void setParameters(const FieldCouplingParameters& fcp);
 			void setWeightsDirectory(const std::string& dir);
 			FieldCouplingParameters getParameters() const;
 			std::string getWeightsDirectory() const;
+			// weights whose magnitude is at most threshold * max|w| are not stored in the compressed copy,
+			// and while learning the weights of an input at most threshold times the largest input are not updated
+			void setWeightThreshold(double threshold);
+			double getWeightThreshold() const;
+			tools::math::WeightStorage getWeightStorage() const;
+			// must be called after writing to the weights component directly
+			void compressWeights();
 
 			void readWeights();
 			void writeWeights() const;
@@ -2,6 +2,7 @@
 
 #include "element.h"
 #include "tools/math.h"
+#include "tools/sparse_weights.h"
 #include "tools/utils.h"
 
 
@@ -81,6 +82,17 @@ namespace dnf_composer
 		{
 		private:
 			GaussFieldCouplingParameters parameters;
+			// every coupling is a separable gaussian, amplitude * gOut(i) * gIn(j), so unless there are
+			// more couplings than (rows * cols) / (rows + cols) the output is computed from the profiles
+			// and the dense weight matrix is only built when the "weights" component is requested
+			bool usingLowRankEvaluation;
+			bool weightsComputed;
+			std::vector<double> inputProfiles;
+			std::vector<double> outputProfiles;
+			std::vector<double> projectedInputs;
+			// when the dense matrix is evaluated, the compressed copy of it the output is computed from
+			tools::math::SparseWeights sparseWeights;
+			double weightThreshold;
 		public:
 			GaussFieldCoupling(const ElementCommonParameters& elementCommonParameters, 
 				const GaussFieldCouplingParameters& gfc_parameters);
@@ -91,11 +103,21 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::string toString() const override;
 			std::shared_ptr<Element> clone() const override;
+			bool isTransientComponent(const std::string& componentName) const override { return componentName == "input" || componentName == "output"; }
+			bool isConstantComponent(const std::string& componentName) const override { return componentName == "weights"; }
+			void prepareComponent(const std::string& componentName) override;
+			bool isReadingInputView() const override { return true; }
 
 			GaussFieldCouplingParameters getParameters() const;
 			void setParameters(const GaussFieldCouplingParameters& gfc_parameters);
 			ElementDimensions getInputFieldDimensions() const;
+			bool isUsingLowRankEvaluation() const;
+			// weights whose magnitude is at most threshold * max|w| are not stored in the compressed copy
+			void setWeightThreshold(double threshold);
+			double getWeightThreshold() const;
 		private:
+			void computeProfiles();
+			void computeWeights();
 			void updateOutput();
 			void updateInputFieldDimensions();
 		};
@@ -63,6 +63,7 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::string toString() const override;
 			std::shared_ptr<Element> clone() const override;
+			bool isStatic() const override { return true; }
 
 			void setParameters(const GaussStimulusParameters& parameters);
 			GaussStimulusParameters getParameters() const;
@@ -1,25 +1,107 @@
 #pragma once
 
 #include "element.h"
+#include "tools/math.h"
+#include "tools/fft.h"
+#include "tools/recursive_gaussian.h"
 #include <array>
+#include <utility>
+#include <initializer_list>
 
 namespace dnf_composer
 {
 	namespace element
 	{
+		enum class ConvolutionMode : int
+		{
+			// direct convolution, or FFT convolution when it is expected to be faster
+			AUTOMATIC,
+			DIRECT,
+			FFT,
+			// recursive Gaussian filters, O(N) whatever the width, only for Gaussian based kernels and only
+			// where they are faster than the direct convolution and within the maximum recursive error of it
+			RECURSIVE
+		};
+
 		class Kernel : public Element
 		{
+			friend class KernelBatch;
+		public:
+			// the recursive convolution is only used if its error, relative to the sum of the magnitudes
+			// of the kernel, is at most this for every input
+			static constexpr double defaultMaximumRecursiveError = 0.05;
 		protected:
 			std::array<int, 2> kernelRange;
 			std::vector<int> extIndex;
 			double fullSum;
 			int cutOfFactor;
+			// scratch buffer holding the circularly extended input, sized in init()
+			std::vector<double> circularInput;
+			// wide kernels are convolved through an FFT, planned in init()
+			tools::math::FftConvolution fftConvolution;
+			bool usingFftConvolution;
+			ConvolutionMode convolutionMode;
+			double maximumRecursiveError;
+			// the Gaussians the kernel is made of, when they are applied recursively
+			std::vector<tools::math::RecursiveGaussian> recursiveGaussians;
+			// whether the kernel wraps around the field, as given to prepareConvolution()
+			bool circularConvolution;
+			// a kernel merged with others convolves their kernels with its own and adds their global amplitudes,
+			// its own kernel is kept to separate them again
+			std::vector<double> unmergedKernel;
+			std::array<int, 2> unmergedKernelRange;
+			double mergedAmplitudeGlobal;
+			// the kernel was merged into another one, which computes its output, so its own output is zero
+			bool mergedAway;
 		public:
 			Kernel(const ElementCommonParameters& elementCommonParameters);
 			~Kernel() override = default;
+			bool isTransientComponent(const std::string& componentName) const override { return componentName == "input" || componentName == "output"; }
+			bool isConstantComponent(const std::string& componentName) const override { return componentName == "kernel"; }
+			bool isReadingInputView() const override { return true; }
 
 			std::array<int, 2> getKernelRange() const;
 			std::vector<int> getExtIndex() const;
+			bool isUsingFftConvolution() const;
+			bool isUsingRecursiveConvolution() const;
+			// the mode is applied by init()
+			void setConvolutionMode(ConvolutionMode mode);
+			ConvolutionMode getConvolutionMode() const;
+			// applied by init() as well, the bound is about 0.03-0.07 for a Gaussian that the field does not truncate
+			// and 0.06-0.12 for a Mexican hat, so a Mexican hat is only convolved recursively with a larger one
+			void setMaximumRecursiveError(double error);
+			double getMaximumRecursiveError() const;
+			virtual bool supportsRecursiveConvolution() const { return false; }
+			virtual double getAmplitudeGlobal() const = 0;
+
+			// adds the kernel of other, which must read the same input, to this one, so the output of this kernel
+			// is the sum of both and other holds a zero output, returns false if the kernels cannot be merged
+			bool mergeKernel(Kernel& other);
+			// undoes every merge this kernel took part in, init() does too
+			void separateKernels();
+			bool isMerged() const;
+			bool isMergedAway() const;
+		protected:
+			// sizes the scratch buffers and chooses between direct and FFT convolution,
+			// to be called at the end of init(), once the kernel is computed
+			void prepareConvolution(bool circular);
+			void planConvolution();
+			// in recursive mode, replaces the convolution by the sum of the given Gaussians,
+			// each given as { width, sum of its samples in the kernel }
+			// the recursive convolution is not used when the direct one is faster, or when its error would exceed
+			// maximumRecursiveError, typically when the field truncates the Gaussians of the direct kernel
+			void prepareRecursiveConvolution(std::initializer_list<std::pair<double, double>> gaussians, bool circular);
+			// bound on the difference between the recursive and the direct convolution of any input,
+			// relative to the sum of the magnitudes of the kernel
+			double estimateRecursiveError();
+			// convolves the sum of the inputs with the kernel, writing the result directly to the output
+			void convolveInput(bool circular, double amplitudeGlobal);
+			// whether convolveInput convolves directly around a circle, the kernels KernelBatch convolves together
+			bool isConvolvedDirectlyAroundCircle() const;
+			// the parts of convolveInput around the convolution: the sum of the inputs, whose total it keeps,
+			// and the global term added to the output
+			std::span<const double> gatherConvolutionInput();
+			void addGlobalTerm(double amplitudeGlobal);
 		};
 	}
 
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		class Kernel;
+
+		// Steps kernels convolved directly around a circle together: the extended inputs and the kernels of those added
+		// one after the other with the same sizes are interleaved, a block at a time, into one matrix each, value i of
+		// every kernel in row i, and convolved at once, the vector lanes holding different kernels (see tools::simd::convolveInterleavedRows).
+		// Any other kernel steps on its own. Only for the kernel classes whose step is Kernel::convolveInput, and every
+		// kernel gets exactly the output it gets when it is stepped on its own.
+		class KernelBatch
+		{
+		private:
+			// the kernels convolved at once, a vector of AVX-512 or two of AVX2, few enough for their matrices
+			// to stay in the L1 cache
+			static constexpr size_t blockColumns = 8;
+
+			std::vector<Kernel*> kernels;
+			std::vector<double> deltaTs;
+			// the kernels convolved together, and the interleaved inputs, kernels and outputs of a block of them
+			std::vector<Kernel*> columnKernels;
+			std::vector<double> inputs;
+			std::vector<double> weights;
+			std::vector<double> outputs;
+		public:
+			KernelBatch() = default;
+
+			// adding up to this many kernels does not allocate
+			void reserve(size_t numberOfKernels);
+			void clear();
+			void add(Kernel* kernel, double deltaT);
+			void step(double t);
+
+			const std::vector<Kernel*>& getKernels() const { return kernels; }
+		};
+	}
+}
@@ -82,6 +82,8 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::string toString() const override;
 			std::shared_ptr<Element> clone() const override;
+			double getAmplitudeGlobal() const override { return parameters.amplitudeGlobal; }
+			bool supportsRecursiveConvolution() const override { return true; }
 
 			void setParameters(const MexicanHatKernelParameters& mhk_parameters);
 			MexicanHatKernelParameters getParameters() const;
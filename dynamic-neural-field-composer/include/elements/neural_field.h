@@ -9,11 +9,36 @@ namespace dnf_composer
 {
 	namespace element
 	{
+		// How the activation follows tau * du/dt = -u + h + s over one step. Euler and exponential Euler take the
+		// step in one stage, with the input s the other elements computed before the field steps held for the
+		// whole step, as u += g * (-u + h + s) with a gain g that depends only on a = deltaT / tau.
+		// Heun and RK4 take it in several stages: in every stage the simulation evaluates the other elements again at
+		// the state the fields reached in the stage before, and then advances the fields (see StepRecord::stage).
+		enum class Integrator : int
+		{
+			// g = a, stable only for a < 2 and accurate only for a << 1
+			EULER,
+			// g = 1 - exp(-a), the exact solution for the held input, stable for any deltaT
+			EXPONENTIAL_EULER,
+			// two stages, the explicit trapezoidal rule, second order
+			HEUN,
+			// four stages, the classic Runge-Kutta scheme, fourth order
+			RK4
+		};
+
+		inline const std::map<Integrator, std::string> IntegratorToString = {
+			{Integrator::EULER, "Euler"},
+			{Integrator::EXPONENTIAL_EULER, "Exponential Euler"},
+			{Integrator::HEUN, "Heun"},
+			{Integrator::RK4, "RK4"}
+		};
+
 		struct NeuralFieldParameters : ElementSpecificParameters
 		{
 			double tau;
 			double startingRestingLevel;
 			std::unique_ptr<ActivationFunction> activationFunction;
+			Integrator integrator;
 
 			NeuralFieldParameters& operator=(const NeuralFieldParameters& other)
 			{
@@ -25,6 +50,7 @@ namespace dnf_composer
 						activationFunction = other.activationFunction->clone();
 					else
 						activationFunction.reset();
+					integrator = other.integrator;
 				}
 				return *this;
 			}
@@ -34,17 +60,18 @@ namespace dnf_composer
 				constexpr double epsilon = 1e-6;
 				return std::abs(tau - other.tau) < epsilon &&
 					std::abs(startingRestingLevel - other.startingRestingLevel) < epsilon &&
-					activationFunction == other.activationFunction;
+					activationFunction == other.activationFunction &&
+					integrator == other.integrator;
 			}
 
 			NeuralFieldParameters()
-				:tau(25.0), startingRestingLevel(-5.0), activationFunction(nullptr)
+				:tau(25.0), startingRestingLevel(-5.0), activationFunction(nullptr), integrator(Integrator::EULER)
 			{}
 
 			NeuralFieldParameters(double tau, double restingLevel,
-				const ActivationFunction& activationFunction)
+				const ActivationFunction& activationFunction, Integrator integrator = Integrator::EULER)
 				: tau(tau), startingRestingLevel(restingLevel),
-				activationFunction(activationFunction.clone())
+				activationFunction(activationFunction.clone()), integrator(integrator)
 			{ }
 
 			NeuralFieldParameters(const NeuralFieldParameters& other)
@@ -55,6 +82,7 @@ namespace dnf_composer
 					activationFunction = std::make_unique<SigmoidFunction>(0.0, 10.0);
 				else
 					activationFunction = other.activationFunction->clone();
+				integrator = other.integrator;
 			}
 
 			std::string toString() const override
@@ -63,7 +91,8 @@ namespace dnf_composer
 				result << "Parameters: ["
 					<< "Tau: " << std::fixed << std::setprecision(2) << tau << ", "
 					<< "Resting level: " << std::fixed << std::setprecision(2) << startingRestingLevel << ", "
-					<< "Activation Function: " << (activationFunction ? activationFunction->toString() : "None")
+					<< "Activation Function: " << (activationFunction ? activationFunction->toString() : "None") << ", "
+					<< "Integrator: " << IntegratorToString.at(integrator)
 					<< "]";
 				return result.str();
 			}
@@ -153,9 +182,32 @@ namespace dnf_composer
 
 		class NeuralField : public Element
 		{
+			friend class NeuralFieldBatch;
 		protected:
+			// the fused step works through the field in blocks of this many values, which stay in the L1 cache
+			static constexpr size_t fusedBlockSize = 512;
+
 			NeuralFieldParameters parameters;
 			NeuralFieldState state;
+			// bumps of the previous step, used to estimate bump velocity and acceleration
+			std::vector<NeuralFieldBump> previousBumps;
+			// single-pass step for the activation function in use, null if its type is not known
+			void (NeuralField::*fusedStep)(double deltaT);
+			// the activation function of the fused step, called without virtual dispatch by NeuralFieldBatch
+			void (*fusedActivation)(const ActivationFunction& activationFunction, std::span<const double> input, std::span<double> output);
+			// published components summed into the input by the fused step
+			std::vector<const double*> inputSources;
+			// sum of the outputs of the static inputs, computed once by foldStaticInputs(),
+			// the fused step starts the input from it instead of summing those inputs every step
+			std::vector<double> foldedInput;
+			std::vector<const Element*> foldedInputElements;
+			// gain of the integrator, recomputed when deltaT changes
+			double integrationGain;
+			double integrationGainDeltaT;
+			// of a multi-stage integrator, the activation at the start of the step and the weighted sum of the
+			// increments of the stages taken so far
+			std::vector<double> stageStartActivation;
+			std::vector<double> stageIncrementSum;
 		public:
 			NeuralField(const ElementCommonParameters& elementCommonParameters,
 				const NeuralFieldParameters& parameters);
@@ -164,6 +216,13 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::string toString() const override;
 			std::shared_ptr<Element> clone() const override;
+			// a neural field integrates its input over time, so it is where the execution plan breaks cycles
+			bool isDelayPoint() const override { return true; }
+			bool isTransientComponent(const std::string& componentName) const override { return componentName == "input" || componentName == "output"; }
+			bool isConstantComponent(const std::string& componentName) const override { return componentName == "resting level"; }
+			// the output of a field below threshold does not show its activation settling
+			ComponentSlot getStateSlot() const override { return ComponentSlot::ACTIVATION; }
+			bool isObservable() const override { return true; }
 
 			void setThresholdForStability(double threshold) { state.thresholdForStability = threshold; }
 			void setParameters(const NeuralFieldParameters& parameters);
@@ -175,13 +234,35 @@ namespace dnf_composer
 			std::vector<NeuralFieldBump> getBumps() const { return state.bumps; }
 			std::shared_ptr<Kernel> getSelfExcitationKernel() const;
 			double getStabilityThreshold() const { return state.thresholdForStability; }
+			// the stages the integrator takes a step in, a field holds the step it took through the later stages of a
+			// simulation step with more of them
+			int getIntegrationStages() const;
+			// folds the inputs that are static and cover the whole field, returns their names,
+			// the sum is not updated when they change, the simulation folds them again then
+			std::vector<std::string> foldStaticInputs();
+			void unfoldStaticInputs();
 		protected:
 			void calculateActivation(double t, double deltaT);
+			double getIntegrationGain(double deltaT);
+			// one stage of a multi-stage integrator, the last one completes the step
+			void stepStage(double deltaT);
 			void calculateOutput();
 			//void calculateCentroid();
 			void updateState(double deltaT);
 			void checkStability();
+			void checkStability(double activationSum, double activationAvg, double activationNorm);
 			void updateMinMaxActivation();
+			template <typename Activation>
+			void stepFused(double deltaT);
+			template <typename Activation>
+			static void evaluateFusedActivation(const ActivationFunction& activationFunction, std::span<const double> input, std::span<double> output);
+			// the parts of the fused step, shared with NeuralFieldBatch: the input sources are collected once per step,
+			// false means the inputs do not all cover the field and the input is already summed, then every
+			// block is summed and integrated, and the statistics of the whole row are stored at the end
+			bool collectInputSources();
+			void sumInputBlock(size_t begin, size_t end);
+			tools::simd::FieldRow beginFusedRow(double deltaT);
+			void endFusedRow(const tools::simd::FieldRow& row);
 			void updateBumps(double deltaT);
 		};
 	}
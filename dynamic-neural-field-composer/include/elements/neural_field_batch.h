@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "tools/simd.h"
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		class NeuralField;
+
+		// Steps neural fields of the same size together, as the rows of one matrix per component: the inputs of
+		// every field are summed into its row, one sweep integrates the rows four fields per vector (see
+		// tools::simd::integrateFieldRows) and the activation function is applied row by row, block after block.
+		// The fields keep their own components, so the component views the GUI holds stay valid, and every field
+		// gets exactly the result it gets when it is stepped on its own.
+		class NeuralFieldBatch
+		{
+		private:
+			std::vector<NeuralField*> fields;
+			std::vector<double> deltaTs;
+			// the fields stepped through the fused path, and whether their inputs are summed block by block
+			std::vector<NeuralField*> rowFields;
+			std::vector<double> rowDeltaTs;
+			std::vector<std::uint8_t> rowSummingInputs;
+			std::vector<tools::simd::FieldRow> rows;
+		public:
+			NeuralFieldBatch() = default;
+
+			// adding up to this many fields does not allocate
+			void reserve(size_t numberOfFields);
+			void clear();
+			// fields of the same size are stepped as one matrix only when they are added one after the other
+			void add(NeuralField* field, double deltaT);
+			void step(double t);
+
+			const std::vector<NeuralField*>& getFields() const { return fields; }
+		};
+	}
+}
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "tools/math.h"
+#include "tools/rng.h"
 #include "element.h"
 
 namespace dnf_composer
@@ -30,6 +31,8 @@ namespace dnf_composer
 		{
 		private:
 			NormalNoiseParameters parameters;
+			// persistent generator, its sequence is reproducible for a given simulation seed
+			tools::rng::PhiloxGenerator generator;
 		public:
 			NormalNoise(const ElementCommonParameters& elementCommonParameters,
 				NormalNoiseParameters parameters);
@@ -38,6 +41,11 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::shared_ptr<Element> clone() const override;
 			std::string toString() const override;
+			bool isTransientComponent(const std::string& componentName) const override { return componentName == "input" || componentName == "output"; }
+			void setRandomSeed(std::uint64_t seed) override;
+			bool canHoldOutputs() const override { return false; }
+			void saveState(ElementState& state) const override;
+			void restoreState(const ElementState& state) override;
 
 			void setParameters(NormalNoiseParameters parameters);
 			NormalNoiseParameters getParameters() const;
@@ -73,6 +73,7 @@ namespace dnf_composer
 			void step(double t, double deltaT) override;
 			std::string toString() const override;
 			std::shared_ptr<Element> clone() const override;
+			double getAmplitudeGlobal() const override { return parameters.amplitudeGlobal; }
 
 			void setParameters(const OscillatoryKernelParameters& ok_parameters);
 			OscillatoryKernelParameters getParameters() const;
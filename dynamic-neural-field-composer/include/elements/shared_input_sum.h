@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <atomic>
+#include <mutex>
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		struct InputSource;
+
+		// Sum of a set of inputs that several elements read, e.g. two kernels of the same pair of fields.
+		// The first of them to step computes it and the others read it, until the simulation invalidates
+		// it before the next step. Elements of the same level may step concurrently, so computing it is locked.
+		class SharedInputSum
+		{
+		private:
+			std::vector<double> sum;
+			std::vector<const double*> pointers;
+			std::atomic<bool> upToDate;
+			std::mutex mutex;
+		public:
+			SharedInputSum(size_t size, size_t numberOfSources);
+
+			void invalidate() { upToDate.store(false, std::memory_order_relaxed); }
+			// all the elements sharing the sum have the same inputs, so any of them may pass its own
+			std::span<const double> gather(std::span<const InputSource> sources);
+			size_t size() const { return sum.size(); }
+		};
+	}
+}
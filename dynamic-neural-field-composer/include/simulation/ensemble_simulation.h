@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <random>
+
+#include "simulation/simulation.h"
+#include "elements/neural_field_batch.h"
+#include "elements/kernel_batch.h"
+#include "tools/thread_pool.h"
+#include "tools/arena.h"
+
+namespace dnf_composer
+{
+	// Runs many instances of one architecture side by side, e.g. for a parameter sweep or a study of the noise.
+	// Every instance is a Simulation of its own, built by the given function, which may give it its own parameters,
+	// and seeded with its own seed, so its NormalNoise elements draw their own streams.
+	// The instances advance in lockstep: the batches of the execution plan (see element::ElementBatch) are stepped
+	// one after the other across all instances, laid out across the instances rather than instance by instance.
+	// The neural fields of a batch are stepped as the rows of one matrix across the instances (see
+	// element::NeuralFieldBatch), whose components are placed together in memory, and so are the outputs of the
+	// normal noise. The kernels of a batch are convolved as the columns of one matrix across the instances (see
+	// element::KernelBatch), so the vector lanes of the convolution hold different instances, which is where the
+	// ensemble gains over the instances stepped one after the other (see examples/ex_ensemble_benchmark).
+	// Stimuli and couplings keep the layout of their instance and are stepped instance after instance.
+	// The instances are split in groups stepped by different threads.
+	// Every instance computes exactly what it computes alone in the type-sorted mode with its seed.
+	class EnsembleSimulation
+	{
+	private:
+		// instances stepped by one thread, with the buffers of the batches stepped across them
+		struct InstanceGroup
+		{
+			size_t begin;
+			size_t end;
+			element::NeuralFieldBatch fieldBatch;
+			// the instance every field of the batch belongs to
+			std::vector<Simulation*> fieldInstances;
+			element::KernelBatch kernelBatch;
+			std::vector<Simulation*> kernelInstances;
+			// the rows of the neural fields and of the normal noise
+			std::shared_ptr<tools::memory::Arena> rowArena;
+		};
+
+		std::vector<std::shared_ptr<Simulation>> instances;
+		std::uint64_t seed;
+		int numberOfWorkers;
+		std::unique_ptr<tools::threading::ThreadPool> threadPool;
+		std::vector<InstanceGroup> groups;
+		// whether the instances have the same execution plan, otherwise each of them steps on its own
+		bool lockstep;
+		bool initialized;
+		double instanceStepsPerSecond;
+	public:
+		// buildInstance(i) returns instance i, not yet initialized
+		EnsembleSimulation(size_t numberOfInstances, const std::function<std::shared_ptr<Simulation>(size_t)>& buildInstance,
+			std::uint64_t seed = std::random_device{}());
+		EnsembleSimulation(const EnsembleSimulation&) = delete;
+		EnsembleSimulation& operator=(const EnsembleSimulation&) = delete;
+
+		void init();
+		void step();
+		void run(double runTime);
+
+		// 0 uses one worker per hardware thread
+		void setNumberOfWorkers(int numberOfWorkers);
+
+		size_t getNumberOfInstances() const { return instances.size(); }
+		const std::shared_ptr<Simulation>& getInstance(size_t index) const;
+		std::uint64_t getSeed() const { return seed; }
+		bool isInLockstep() const { return lockstep; }
+		// instances times steps over the wall time of the last call to run, paused instances included
+		double getInstanceStepsPerSecond() const { return instanceStepsPerSecond; }
+		// seed of an instance, the same instance run alone with it draws the same numbers
+		static std::uint64_t getInstanceSeed(std::uint64_t seed, size_t instance);
+	private:
+		bool haveSameExecutionPlan() const;
+		void groupInstances();
+		void placeRows(InstanceGroup& group) const;
+		void stepGroup(InstanceGroup& group);
+		// the batches of one pass of a sweep, of the instances that take the given stage
+		void stepGroupBatches(InstanceGroup& group, int stage, Simulation::SweepPass pass);
+	};
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+#include "elements/element.h"
+#include "elements/element_dispatch.h"
+
+namespace dnf_composer
+{
+	// A connection that is read with a one-step delay, i.e. the receiving element
+	// sees the output the source element produced during the previous step.
+	struct DelayedConnection
+	{
+		std::string sourceElement;
+		std::string receivingElement;
+	};
+
+	// The execution plan is the order in which the elements of a simulation are stepped.
+	// It is compiled from the element input/output graph so that every element runs after
+	// the elements it reads from. Cycles (e.g. field -> kernel -> field) are broken at a
+	// delay point (see Element::isDelayPoint()), so connections that close a cycle into a
+	// delay point carry a one-step latency and every other connection carries none.
+	// The elements are also grouped in dependency levels: the elements of a level only read from
+	// elements of earlier levels (or through delayed connections), so they can be stepped concurrently.
+	// Within every level the elements are also sorted by their concrete class into batches, see element::ElementBatch.
+	class ExecutionPlan
+	{
+	private:
+		std::vector<element::Element*> orderedElements;
+		std::vector<std::vector<element::Element*>> levels;
+		// the batches of every level, level after level
+		std::vector<element::ElementBatch> batches;
+		std::vector<DelayedConnection> delayedConnections;
+		std::uint64_t compiledConnectionRevision;
+		bool compiled;
+		size_t numberOfCompilations;
+	public:
+		ExecutionPlan();
+
+		// held elements are part of the simulation but are not stepped, the elements that read them see the outputs they hold,
+		// the plan stays up to date as long as the connection revision of the simulation is the one it was compiled at
+		void compile(const std::vector<std::shared_ptr<element::Element>>& elements, std::uint64_t connectionRevision,
+			const std::vector<std::shared_ptr<element::Element>>& heldElements = {});
+		void invalidate();
+		bool isUpToDate(std::uint64_t connectionRevision) const;
+
+		const std::vector<element::Element*>& getOrderedElements() const { return orderedElements; }
+		const std::vector<std::vector<element::Element*>>& getLevels() const { return levels; }
+		const std::vector<element::ElementBatch>& getBatches() const { return batches; }
+		const std::vector<DelayedConnection>& getDelayedConnections() const { return delayedConnections; }
+		// times the plan was compiled since it was constructed
+		size_t getNumberOfCompilations() const { return numberOfCompilations; }
+		std::string toString() const;
+		void print() const;
+	};
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "elements/element.h"
+
+namespace dnf_composer
+{
+	// What the last optimization of the element graph did.
+	struct GraphOptimizationReport
+	{
+		// every field and the static inputs folded into its constant input
+		std::vector<std::pair<std::string, std::vector<std::string>>> foldedInputs;
+		// every kernel and the kernels merged into it
+		std::vector<std::pair<std::string, std::vector<std::string>>> mergedKernels;
+		// elements whose outputs reach no observable element
+		std::vector<std::string> droppedElements;
+		size_t numberOfElements = 0;
+		size_t numberOfSteppedElements = 0;
+
+		std::string toString() const;
+	};
+
+	// Rewrites the element graph before it is compiled into an execution plan, without changing what the
+	// observable elements compute:
+	// - the outputs of static inputs of a neural field are summed once into a constant input of the field,
+	// - kernels that read the same input and are read by the same fields are merged into one convolution,
+	// - elements whose outputs reach no observable element, e.g. a neural field or a learning coupling, are dropped.
+	// Merged and dropped elements stay in the simulation but are held, they are not stepped.
+	// The optimization is undone and done again whenever the graph or the parameters of an element change.
+	class GraphOptimizer
+	{
+	private:
+		GraphOptimizationReport report;
+		std::vector<std::shared_ptr<element::Element>> heldElements;
+	public:
+		GraphOptimizer() = default;
+
+		// returns the elements that still have to be stepped
+		std::vector<std::shared_ptr<element::Element>> optimize(const std::vector<std::shared_ptr<element::Element>>& elements);
+		// restores every element to its unoptimized state
+		void revert(const std::vector<std::shared_ptr<element::Element>>& elements);
+		static void revert(element::Element& element);
+
+		const GraphOptimizationReport& getReport() const { return report; }
+		const std::vector<std::shared_ptr<element::Element>>& getHeldElements() const { return heldElements; }
+	};
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+namespace dnf_composer
+{
+	// One swept parameter: an entry of an element in the simulation file, e.g. "tau" of a neural field,
+	// "width" or "amplitude" of a kernel or "position" of a stimulus. Nested entries are addressed with dots,
+	// e.g. "activationFunction.steepness".
+	struct SweepParameter
+	{
+		std::string elementName;
+		std::string parameterName;
+		std::vector<double> values;
+	};
+
+	enum class SweepMode : int
+	{
+		// every combination of the values of the parameters, the last parameter varies fastest
+		GRID,
+		// the i-th values of all parameters form the i-th point, all parameters have as many values
+		LIST
+	};
+
+	struct SweepSpecification
+	{
+		std::vector<SweepParameter> parameters;
+		SweepMode mode = SweepMode::GRID;
+		double deltaT = 1.0;
+		double runTime = 1000.0;
+		std::uint64_t seed = 0;
+		// neural fields the metrics are computed for, all neural fields if empty
+		std::vector<std::string> observedFields;
+	};
+
+	struct SweepFieldMetrics
+	{
+		std::string fieldName;
+		size_t numberOfBumps = 0;
+		std::vector<double> centroids;
+		// time from which the field stayed stable until the end of the run, NaN if it was not stable at the end
+		double timeToStability = std::numeric_limits<double>::quiet_NaN();
+	};
+
+	struct SweepPointResult
+	{
+		// values of the swept parameters, in the order of the specification
+		std::vector<double> values;
+		std::vector<SweepFieldMetrics> fields;
+		// hash of everything the result depends on, the key of the result in the result file
+		std::uint64_t hash = 0;
+		// whether the result was read from the result file instead of computed
+		bool cached = false;
+	};
+
+	// Runs a simulation saved by the SimulationFileManager at every point of a parameter sweep, without the GUI.
+	// Every point is a clone of the saved simulation with the swept parameters overridden, run for the given
+	// time with the given seed. The points are run in parallel by a thread pool, which hands every thread the next
+	// point when it finishes one, so points of different cost keep all threads busy.
+	// The metrics of every point are appended to the result file, one JSON object per line, as soon as the point
+	// finishes. The file is read back before a sweep, and a point whose hash is found there is not run again,
+	// so extending a sweep only runs the new points, and an interrupted sweep continues where it stopped.
+	class ParameterSweep
+	{
+	private:
+		std::string simulationFilePath;
+		std::string resultFilePath;
+		SweepSpecification specification;
+		int numberOfWorkers;
+		std::unordered_map<std::uint64_t, SweepPointResult> cache;
+		size_t numberOfPlanCompilations;
+	public:
+		ParameterSweep(std::string simulationFilePath, SweepSpecification specification, std::string resultFilePath);
+
+		std::vector<SweepPointResult> run();
+
+		// 0 uses one worker per hardware thread
+		void setNumberOfWorkers(int numberOfWorkers);
+
+		// the values of the swept parameters at every point, in the order the points are run
+		std::vector<std::vector<double>> getPoints() const;
+		const SweepSpecification& getSpecification() const { return specification; }
+		// execution plans compiled by the points run in the last call to run(), one per point,
+		// more if the connections of a point changed while it ran
+		size_t getNumberOfPlanCompilations() const { return numberOfPlanCompilations; }
+
+		// reads a specification from a JSON file, e.g.
+		// { "runTime": 500, "seed": 1, "mode": "grid", "observedFields": ["nf 1"], "parameters": [
+		//   { "element": "nf 1", "parameter": "tau", "values": [10, 20, 40] },
+		//   { "element": "gs 1", "parameter": "position", "from": 10, "to": 90, "step": 10 } ] }
+		static SweepSpecification readSpecification(const std::string& filePath);
+	private:
+		void readCache();
+	};
+}
@@ -5,23 +5,120 @@
 #include <string>
 #include <filesystem>
 #include <chrono>
+#include <random>
+#include <cstdint>
 
 #include "elements/element.h"
+#include "elements/neural_field_batch.h"
+#include "simulation/execution_plan.h"
+#include "simulation/graph_optimizer.h"
 #include "exceptions/exception.h"
 #include "tools/utils.h"
+#include "tools/thread_pool.h"
+#include "tools/arena.h"
 
 namespace dnf_composer
 {
+	enum class ExecutionMode : int
+	{
+		SERIAL,
+		// the elements of each level of the execution plan are stepped concurrently
+		PARALLEL_LEVELS,
+		// serial, the elements of each level are stepped batch by batch, each batch through the non-virtual
+		// calls of its concrete class, see element::ElementBatch, and the neural fields of the same size
+		// as the rows of one matrix, see element::NeuralFieldBatch
+		TYPE_SORTED
+	};
+
+	// Step size control of Simulation::run in adaptive mode.
+	// Every step is taken once whole and once as two halves, from the same state; their difference estimates
+	// the error of the step. A step whose error exceeds the tolerance is taken again with a smaller size,
+	// otherwise the two halves are kept and the size of the next step is grown or shrunk from the error.
+	// Every element is stepped in every step, so adaptive stepping cannot be combined with quiescence skipping
+	// or with elements whose step period is not 1.
+	struct AdaptiveSteppingParameters
+	{
+		// largest accepted difference in the activation of any neural field
+		double tolerance;
+		// bounds of the step size, in the time units of deltaT, 0 uses deltaT / 16 and 16 * deltaT
+		double minimumDeltaT;
+		double maximumDeltaT;
+
+		AdaptiveSteppingParameters(double tolerance = 1e-2, double minimumDeltaT = 0, double maximumDeltaT = 0)
+			: tolerance(tolerance), minimumDeltaT(minimumDeltaT), maximumDeltaT(maximumDeltaT)
+		{}
+	};
+
+	// Steps taken by the last call to Simulation::run.
+	struct StepStatistics
+	{
+		size_t acceptedSteps = 0;
+		size_t rejectedSteps = 0;
+		// times every element was stepped, three per attempted step in adaptive mode, times the stages of the integrators
+		size_t elementSweeps = 0;
+		double smallestDeltaT = 0;
+		double largestDeltaT = 0;
+		// steps of single elements that were due, and those skipped because the element was quiescent
+		size_t elementSteps = 0;
+		size_t skippedElementSteps = 0;
+		// the sweeps a run with the fixed deltaT would have taken, over the sweeps taken
+		double speedup = 0;
+	};
+
 	class Simulation;
+	class EnsembleSimulation;
 	std::shared_ptr<Simulation> createSimulation(const std::string& identifier = "", double deltaT = 1, double tZero = 0, double t = 0);
 
 	class Simulation : public std::enable_shared_from_this<Simulation>
 	{
+		// steps the batches of its instances itself, interleaved across the instances
+		friend class EnsembleSimulation;
 	protected:
 		bool initialized;
 		bool paused;
+		bool doubleBuffered;
 		std::vector<std::shared_ptr<element::Element>> elements;
+		ExecutionPlan executionPlan;
+		ExecutionMode executionMode;
+		int numberOfWorkers;
+		std::unique_ptr<tools::threading::ThreadPool> threadPool;
+		bool measuringBusyTime;
+		std::atomic<std::int64_t> busyTimeNanoseconds;
+		std::shared_ptr<tools::memory::Arena> componentArena;
+		std::uint64_t seed;
+		bool adaptiveStepping;
+		AdaptiveSteppingParameters adaptiveSteppingParameters;
+		StepStatistics stepStatistics;
+		// step size the elements are stepped with, deltaT unless adaptive stepping changes it
+		double currentDeltaT;
+		// steps taken since init, accepted ones in adaptive mode, an element with a step period of k is stepped when it is a multiple of k
+		std::uint64_t stepCount;
+		// false while adaptive stepping steps every element, each attempt publishing what the last one wrote
+		bool applyingStepPeriods;
+		// stages the last step was taken in, the most any neural field integrates a step in
+		int integrationStages;
+		bool quiescenceSkipping;
+		double quiescenceTolerance;
+		std::atomic<std::uint64_t> elementStepCount;
+		std::atomic<std::uint64_t> skippedElementStepCount;
+		bool optimizingGraph;
+		GraphOptimizer graphOptimizer;
+		// parameter revision of the elements when the graph was optimized, the optimization is redone when it changes
+		std::uint64_t optimizedParameterRevision;
+		// the neural fields of the batch being stepped in the type-sorted mode
+		element::NeuralFieldBatch fieldBatch;
+		// sums of inputs read by several elements, computed once per step
+		std::vector<std::shared_ptr<element::SharedInputSum>> sharedInputSums;
+		// state of every element before the step being attempted, and activation after the whole step
+		std::vector<element::ElementState> savedStates;
+		std::vector<const element::Component*> errorComponents;
+		std::vector<std::vector<double>> wholeStepActivations;
 		std::string uniqueIdentifier;
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+		// parameter revision of the elements at the last step, new parameters may resize buffers in the step after
+		std::uint64_t steppedParameterRevision = 0;
+		size_t steadyStateStepAllocations = 0;
+#endif
 	public:
 		double deltaT;
 		double tZero;
@@ -52,13 +149,33 @@ namespace dnf_composer
 
 		void setUniqueIdentifier(const std::string& id);
 		void setDeltaT(double deltaT);
+		void setExecutionMode(ExecutionMode mode);
+		// 0 uses one worker per hardware thread
+		void setNumberOfWorkers(int numberOfWorkers);
+		// in double-buffered mode every element reads the state of the previous step,
+		// so the result does not depend on the order in which the elements are stepped
+		void setDoubleBuffered(bool doubleBuffered);
+		// stochastic elements draw reproducible sequences from this seed, whatever the execution mode,
+		// by default it is taken from std::random_device
+		void setSeed(std::uint64_t seed);
+		// in adaptive mode run() chooses the step size itself, step() always advances by deltaT,
+		// it throws with quiescence skipping on, and run() throws if an element has a step period other than 1
+		void setAdaptiveStepping(bool adaptive);
+		void setAdaptiveSteppingParameters(const AdaptiveSteppingParameters& parameters);
+		// an element is skipped, holding its outputs, while its state moved by at most the tolerance in its
+		// last step and the state of none of its inputs moved since, a change of an input wakes it up again
+		void setQuiescenceSkipping(bool skipping);
+		void setQuiescenceTolerance(double tolerance);
+		// the element graph is optimized when the execution plan is compiled, see GraphOptimizer,
+		// merged and dropped elements keep the outputs they held and are not stepped
+		void setGraphOptimization(bool optimizing);
 
 		std::vector<std::shared_ptr<element::Element>> getElements() const;
 		std::string getUniqueIdentifier() const;
 		std::shared_ptr<element::Element> getElement(const std::string& id) const;
 		std::shared_ptr<element::Element> getElement(int index) const;
 		std::vector<double> getComponent(const std::string& id, const std::string& componentName) const;
-		std::vector<double>* getComponentPtr(const std::string& id, const std::string& componentName) const;
+		element::Component* getComponentPtr(const std::string& id, const std::string& componentName) const;
 		int getNumberOfElements() const;
 		std::vector < std::shared_ptr<element::Element>> getElementsThatHaveSpecifiedElementAsInput(const std::string& specifiedElement, 
 		                                                                                            const std::string& inputComponent = "output") const;
@@ -73,9 +190,74 @@ namespace dnf_composer
 		void exportComponentToFile(const std::string& id, const std::string& componentName) const;
 
 		bool isInitialized() const;
+		const ExecutionPlan& getExecutionPlan() const;
+		const std::shared_ptr<tools::memory::Arena>& getComponentArena() const;
+		ExecutionMode getExecutionMode() const;
+		int getNumberOfWorkers() const;
+		bool isDoubleBuffered() const;
+		std::uint64_t getSeed() const;
+		bool isAdaptiveStepping() const;
+		AdaptiveSteppingParameters getAdaptiveSteppingParameters() const;
+		const StepStatistics& getStepStatistics() const;
+		bool isQuiescenceSkipping() const;
+		double getQuiescenceTolerance() const;
+		bool isOptimizingGraph() const;
+		const GraphOptimizationReport& getGraphOptimizationReport() const;
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+		// heap allocations made so far in steady-state steps, by the calling thread and the workers of the pool
+		size_t getSteadyStateStepAllocations() const;
+#endif
 
 		~Simulation() = default;
 	private:
 		void generateUniqueIdentifier();
+		void compileExecutionPlan();
+		bool isExecutionPlanUpToDate() const;
+		// sum of the connection revisions of the elements, it grows with every change of a connection between them,
+		// while adding or removing an element invalidates the plan itself
+		std::uint64_t getConnectionRevision() const;
+		// the same for the parameter revisions
+		std::uint64_t getParameterRevision() const;
+		void shareInputSums();
+		void allocateComponentArena();
+		void distributeThreadPool();
+		// the elements a sweep steps, a stage of a multi-stage step evaluates the inputs of the neural fields and then the fields
+		enum class SweepPass : int
+		{
+			ALL,
+			INPUTS,
+			NEURAL_FIELDS
+		};
+		// takes the step in as many stages as the integrators of the neural fields have, see element::Integrator
+		void stepElements();
+		void sweepElements(SweepPass pass);
+		static bool isInSweepPass(const element::Element* element, SweepPass pass);
+		static bool isInSweepPass(const element::ElementBatch& batch, SweepPass pass);
+		// throws in double-buffered mode if a field is integrated in several stages
+		int getIntegrationStages() const;
+		void beginIntegrationStage(int stage);
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+		// heap allocations made so far by the threads that step this simulation
+		size_t getStepAllocationCount() const;
+#endif
+		// the parts of a step around the stepping of the elements, for an ensemble that steps them itself
+		void beginEnsembleStep();
+		void endEnsembleStep();
+		void runAdaptive(double endTime);
+		double attemptStep(double stepSize);
+		void saveStates();
+		void restoreStates();
+		// stepped through the calls of ConcreteElement, Element steps it through its virtual calls
+		template <typename ConcreteElement>
+		void stepElement(ConcreteElement* element);
+		void stepBatch(const element::ElementBatch& batch);
+		void stepFieldBatch(const std::vector<element::NeuralField*>& fields);
+		// whether the element is due and not skipped, and the step size it covers then,
+		// an element that is not stepped keeps the outputs it published
+		bool isElementStepped(element::Element* element, double& elementDeltaT);
+		void publishElement(element::Element* element) const;
+		bool isElementDue(const element::Element* element, std::uint64_t step) const;
+		bool isElementQuiescent(const element::Element* element) const;
+		void recordStep(element::Element* element) const;
 	};
 }
@@ -28,6 +28,8 @@ namespace dnf_composer
 
 		void saveElementsToJson() const;
 		void loadElementsFromJson() const;
+		// adds the elements described by elementsJson, in the format of the file, to the simulation
+		void loadElementsFromJson(const json& elementsJson) const;
 
 	private:
 		static json elementToJson(const std::shared_ptr<element::Element>& element);
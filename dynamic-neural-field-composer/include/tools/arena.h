@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory_resource>
+#include <cstddef>
+#include <mutex>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace memory
+		{
+			// Monotonic memory resource over a single cache-line aligned block.
+			// Every allocation starts on a cache line, so buffers allocated one after the other
+			// are laid out contiguously in allocation order. Deallocation does not reclaim memory,
+			// the whole block is released when the arena is destroyed. Requests that do not fit in
+			// the block are served by the upstream resource. Allocations are thread-safe.
+			class Arena : public std::pmr::memory_resource
+			{
+			public:
+				static constexpr size_t alignment = 64;
+			private:
+				std::byte* block;
+				size_t capacity;
+				size_t used;
+				size_t overflowAllocations;
+				std::pmr::memory_resource* upstream;
+				std::mutex mutex;
+			public:
+				Arena(size_t capacity, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+				Arena(const Arena&) = delete;
+				Arena& operator=(const Arena&) = delete;
+				~Arena() override;
+
+				size_t getCapacity() const { return capacity; }
+				size_t getUsed() const { return used; }
+				size_t getOverflowAllocations() const { return overflowAllocations; }
+				bool owns(const void* pointer) const;
+
+				static size_t roundUp(size_t bytes);
+			private:
+				void* do_allocate(size_t bytes, size_t alignment) override;
+				void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+				bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+			};
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <span>
+#include <cstddef>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace math
+		{
+			// Convolution with a fixed kernel computed through a real-input FFT.
+			// The plan (transform size, twiddle factors and the spectrum of the kernel) is computed once,
+			// after which convolve() gives the same result as conv_valid or conv_same, in
+			// O(M log M) instead of O(N K), without allocating.
+			class FftConvolution
+			{
+			private:
+				size_t signalSize;
+				size_t outputOffset;
+				size_t outputSize;
+				size_t transformSize;
+				std::vector<size_t> bitReversal;
+				std::vector<std::complex<double>> twiddles;
+				std::vector<std::complex<double>> realTwiddles;
+				std::vector<std::complex<double>> kernelSpectrum;
+				std::vector<std::complex<double>> buffer;
+				std::vector<std::complex<double>> spectrum;
+			public:
+				FftConvolution();
+
+				// equivalent to conv_valid(signal, kernel) for a signal of the given size
+				void planValid(size_t signalSize, std::span<const double> kernel);
+				// equivalent to conv_same(signal, kernel) for a signal of the given size
+				void planSame(size_t signalSize, std::span<const double> kernel);
+				void convolve(std::span<const double> signal, std::span<double> output);
+
+				bool isPlanned() const { return transformSize > 0; }
+				size_t getTransformSize() const { return transformSize; }
+
+				// whether the FFT is expected to be faster than the direct convolution
+				static bool isWorthwhile(size_t outputSize, size_t kernelSize);
+			private:
+				void plan(size_t signalSize, std::span<const double> kernel, bool reverseKernel, size_t outputOffset, size_t outputSize);
+				void transform(bool inverse);
+				void forward(std::span<const double> signal, bool reverse);
+			};
+		}
+	}
+}
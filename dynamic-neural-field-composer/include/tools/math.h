@@ -11,6 +11,8 @@
 
 #include <vector>
 #include <array>
+#include <span>
+#include <type_traits>
 #include <cmath>
 #include <math.h>
 #include <algorithm>
@@ -21,13 +23,18 @@
 #include <fstream>
 
 
+namespace dnf_composer::tools::threading
+{
+	class ThreadPool;
+}
+
 namespace dnf_composer::tools::math
 {
 	// https://stackoverflow.com/questions/24518989/how-to-perform-1-dimensional-valid-convolution
 	// The conv function implements the standard convolution method,
 	// where the output size is the sum of input sizes minus one.
-	template<typename T>
-	std::vector<T> conv(std::vector<T> const& f, std::vector<T> const& g)
+	template<typename T, typename AllocatorF, typename AllocatorG>
+	std::vector<T> conv(std::vector<T, AllocatorF> const& f, std::vector<T, AllocatorG> const& g)
 	{
 		int const nf = f.size();
 		int const ng = g.size();
@@ -50,13 +57,13 @@ namespace dnf_composer::tools::math
 	// https://stackoverflow.com/questions/24518989/how-to-perform-1-dimensional-valid-convolution
 	// The conv_valid function implements the valid convolution method,
 	// where the output size is the absolute difference between the input sizes plus one.
-	template<typename T>
-	std::vector<T> conv_valid(std::vector<T> const& f, std::vector<T> const& g)
+	template<typename T, typename AllocatorF, typename AllocatorG>
+	std::vector<T> conv_valid(std::vector<T, AllocatorF> const& f, std::vector<T, AllocatorG> const& g)
 	{
 		int const nf = f.size();
 		int const ng = g.size();
-		std::vector<T> const& min_v = (nf < ng) ? f : g;
-		std::vector<T> const& max_v = (nf < ng) ? g : f;
+		std::span<const T> const min_v = (nf < ng) ? std::span<const T>(f) : std::span<const T>(g);
+		std::span<const T> const max_v = (nf < ng) ? std::span<const T>(g) : std::span<const T>(f);
 		int const n = std::max(nf, ng) - std::min(nf, ng) + 1;
 		std::vector<T> out(n, T());
 		for (auto i(0); i < n; ++i) {
@@ -69,8 +76,8 @@ namespace dnf_composer::tools::math
 	}
 
 	// ChatGPT 4.0
-	template<typename T>
-	std::vector<T> conv_same(std::vector<T> const& f, std::vector<T> const& g) {
+	template<typename T, typename AllocatorF, typename AllocatorG>
+	std::vector<T> conv_same(std::vector<T, AllocatorF> const& f, std::vector<T, AllocatorG> const& g) {
 		int const nf = f.size();
 		int const ng = g.size();
 		std::vector<T> out(nf, T()); // Output size matches the size of f for 'same' mode
@@ -207,8 +214,8 @@ namespace dnf_composer::tools::math
 		return derivative;
 	}
 
-	template<typename T>
-	std::vector<T> obtainCircularVector(const std::vector<int>& indices, const std::vector<T>& contents)
+	template<typename T, typename Allocator>
+	std::vector<T> obtainCircularVector(const std::vector<int>& indices, const std::vector<T, Allocator>& contents)
 	{
 		std::vector<T> newContents(indices.size());
 		for (int i = 0; i < indices.size(); i++)
@@ -217,7 +224,7 @@ namespace dnf_composer::tools::math
 	}
 
 	template <typename T>
-	std::vector<T> sigmoid(const std::vector<T>& x, T beta, T x0)
+	std::vector<T> sigmoid(std::type_identity_t<std::span<const T>> x, T beta, T x0)
 	{
 		std::vector<T> s(x.size());
 		for (std::size_t i = 0; i < s.size(); ++i) {
@@ -227,7 +234,7 @@ namespace dnf_composer::tools::math
 	}
 
 	template<typename T>
-	std::vector<T> heaviside(const std::vector<T>& x, T threshold)
+	std::vector<T> heaviside(std::type_identity_t<std::span<const T>> x, T threshold)
 	{
 		std::vector<T> h(x.size());
 		for (int i = 0; i < static_cast<int>(h.size()); i++)
@@ -249,6 +256,22 @@ namespace dnf_composer::tools::math
 
 	std::vector<double> generateNormalVector(int size);
 
+	// In-place variants of the functions above, used by the elements while stepping.
+	// They write the result into a buffer provided by the caller and do not allocate.
+	void conv_valid(std::span<const double> f, std::span<const double> g, std::span<double> out);
+	void conv_same(std::span<const double> f, std::span<const double> g, std::span<double> out);
+	void obtainCircularVector(const std::vector<int>& indices, std::span<const double> contents, std::span<double> out);
+	void sigmoid(std::span<const double> x, double beta, double x0, std::span<double> out);
+	void heaviside(std::span<const double> x, double threshold, std::span<double> out);
+	void normalize(std::span<const double> x, std::span<double> out);
+
+	// output[i] = sum_j scalar * weights[j * output.size() + i] * input[j]
+	// The weights are stored input-major (the row of an input holds its weight to every output),
+	// so the product streams through them contiguously, accumulating one input row at a time into
+	// a block of outputs that stays in cache. Large products are split over the thread pool, if given.
+	void matrixVectorMultiply(std::span<const double> weights, std::span<const double> input, std::span<double> output,
+		double scalar = 1.0, threading::ThreadPool* threadPool = nullptr);
+
 	template <typename T>
 	std::vector<T> normalize(const std::vector<T>& vector)
 	{
@@ -271,8 +294,10 @@ namespace dnf_composer::tools::math
 		return normalizedVector;
 	}
 
-	template <typename T>
-	std::vector<T> hebbLearningRule(std::vector<T>& weights, const std::vector<T>& input, const std::vector<T>& output, double learningRate)
+	// an input whose magnitude is at most inputThreshold changes none of its weights
+	template <typename T, typename Allocator>
+	std::vector<T, Allocator>& hebbLearningRule(std::vector<T, Allocator>& weights, const std::vector<T>& input, const std::vector<T>& output, double learningRate,
+		T inputThreshold = 0)
 	{
 		if (input.empty() || output.empty())
 			throw std::invalid_argument("Input and output vectors cannot be empty");
@@ -286,6 +311,8 @@ namespace dnf_composer::tools::math
 
 		for (size_t i = 0; i < inputSize; ++i)
 		{
+			if (std::abs(input[i]) <= inputThreshold)
+				continue;
 			const T scaledInput = learningRate * input[i];
 			const size_t baseIndex = i * outputSize;
 
@@ -296,18 +323,24 @@ namespace dnf_composer::tools::math
 		return weights;
 	}
 
-	template <typename T>
-	std::vector<T> ojaLearningRule(std::vector<T>& weights, const std::vector<T>& input, const std::vector<T>& output, double learningRate)
+	// an input whose magnitude is at most inputThreshold changes none of its weights
+	template <typename T, typename Allocator>
+	std::vector<T, Allocator>& ojaLearningRule(std::vector<T, Allocator>& weights, const std::vector<T>& input, const std::vector<T>& output, double learningRate,
+		T inputThreshold = 0)
 	{
 		const int inputSize = input.size();
 		const int outputSize = output.size();
 
 		for (int i = 0; i < inputSize; i++)
+		{
+			if (std::abs(input[i]) <= inputThreshold)
+				continue;
 			for (int j = 0; j < outputSize; j++)
 			{
 				int index = i * outputSize + j; // Compute the index for the flattened matrix
 				weights[index] += learningRate * (input[i] * output[j] - output[j] * input[i] * weights[index]);
 			}
+		}
 
 		return weights;
 	}
@@ -383,8 +416,8 @@ namespace dnf_composer::tools::math
 		return true; // Vectors are equal within threshold
 	}
 
-	template <typename T>
-	T calculateVectorSum(const std::vector<T>& vec) {
+	template <typename T, typename Allocator>
+	T calculateVectorSum(const std::vector<T, Allocator>& vec) {
 		T result = 0.0;
 		for (T value : vec) {
 			result += value;
@@ -392,8 +425,8 @@ namespace dnf_composer::tools::math
 		return result;
 	}
 
-	template <typename T>
-	T calculateVectorAvg(const std::vector<T>& vec) {
+	template <typename T, typename Allocator>
+	T calculateVectorAvg(const std::vector<T, Allocator>& vec) {
 		if (vec.empty()) {
 			return T(); // Return default value if vector is empty
 		}
@@ -405,8 +438,8 @@ namespace dnf_composer::tools::math
 		return sum / static_cast<T>(vec.size()); // Calculate average
 	}
 
-	template <typename T>
-	T calculateVectorNorm(const std::vector<T>& vec) {
+	template <typename T, typename Allocator>
+	T calculateVectorNorm(const std::vector<T, Allocator>& vec) {
 		T sum_of_squares = std::accumulate(vec.begin(), vec.end(), 0.0,
 		                                   [](T a, T b) { return a + b * b; });
 		return std::sqrt(sum_of_squares);
@@ -4,6 +4,7 @@
 #include <string>
 #include <iostream>
 #include <mutex>
+#include <cstddef>
 
 namespace dnf_composer
 {
@@ -33,6 +34,12 @@ namespace dnf_composer
 				std::string signature;
 				std::ostream& outStream;
 			};
+
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+			// number of heap allocations made by the calling thread so far, counted by the replacement
+			// global operator new that is compiled in with DNF_COMPOSER_COUNT_ALLOCATIONS
+			size_t getAllocationCount();
+#endif
 		}
 	}
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstddef>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace math
+		{
+			// Recursive approximation of the convolution with a Gaussian (Young and van Vliet, 1995).
+			// A causal and an anti-causal third-order filter are run over the signal, so the cost
+			// is O(N + padding) whatever the width. The filter has unit gain, the result is multiplied
+			// by 'scale', which should be the sum of the sampled kernel it replaces.
+			// It only approximates the Gaussian: for noisy input the output differs from the direct convolution
+			// by up to 1-3% of its peak, and by 6-10% for a difference of Gaussians such as a Mexican hat,
+			// where the errors of both filters do not cancel like the Gaussians do. Where the field truncates
+			// the direct kernel the difference grows further, up to 16% for a Gaussian of width 30 around
+			// a circular field of 100 samples and 26-40% for a Mexican hat of width 100.
+			// The signal is extended by 'padding' samples on each side, wrapped around when circular
+			// and zero otherwise, which reproduces the boundary handling of conv_valid on the
+			// circularly extended input and of conv_same respectively.
+			class RecursiveGaussian
+			{
+			public:
+				// below this width the coefficients of Young and van Vliet are not valid
+				static constexpr double minimumWidth = 0.5;
+			private:
+				double b1, b2, b3, gain;
+				double scale;
+				size_t signalSize;
+				size_t padding;
+				bool circular;
+				std::vector<double> buffer;
+			public:
+				RecursiveGaussian();
+
+				void plan(double width, double scale, size_t signalSize, size_t padding, bool circular);
+				// writes scale * (input filtered by the Gaussian) to output, or adds it when accumulating
+				void filter(std::span<const double> input, std::span<double> output, bool accumulate = false);
+
+				// whether the given number of filters, each padded by at most padding samples, is expected
+				// to be faster than the direct convolution with a kernel of the given size
+				static bool isWorthwhile(size_t signalSize, size_t kernelSize, size_t numberOfFilters, size_t padding);
+			};
+		}
+	}
+}
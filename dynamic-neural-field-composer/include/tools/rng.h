@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <string>
+#include <cstdint>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace rng
+		{
+			// Counter-based random number generator (Philox4x32-10).
+			// Every block of four 32-bit numbers is a pure function of (key, stream, counter),
+			// so a sequence only depends on the seed and the stream it was given, never on which
+			// thread draws it or on what other generators do. Streams are independent sequences
+			// under the same seed, one per element.
+			class PhiloxGenerator
+			{
+			private:
+				std::uint64_t key;
+				std::uint64_t stream;
+				std::uint64_t counter;
+			public:
+				PhiloxGenerator(std::uint64_t seed = 0, std::uint64_t stream = 0);
+
+				// restarts the sequence of the given stream under the given seed
+				void setSeed(std::uint64_t seed, std::uint64_t stream);
+				// restarts the current sequence
+				void reset();
+
+				// uniformly distributed numbers in (0, 1)
+				void fillUniform(std::span<double> output);
+				// standard normally distributed numbers, by the Box-Muller transform of tools::simd::boxMuller
+				void fillNormal(std::span<double> output);
+
+				std::uint64_t getSeed() const { return key; }
+				std::uint64_t getStream() const { return stream; }
+				std::uint64_t getCounter() const { return counter; }
+				// moves to a position returned by getCounter, to draw the same numbers again
+				void setCounter(std::uint64_t counter) { this->counter = counter; }
+
+				static std::array<std::uint32_t, 4> generateBlock(std::uint64_t key, std::uint64_t stream, std::uint64_t counter);
+			};
+
+			// stable 64-bit hash (FNV-1a), used to derive a stream from a name
+			std::uint64_t hashName(const std::string& name);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <span>
+#include <string>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace simd
+		{
+			enum class InstructionSet
+			{
+				SCALAR,
+				AVX2,
+				AVX512
+			};
+
+			// Widest instruction set supported by both the build and the processor, detected once at start-up.
+			// The kernels below pick their implementation from it, so one binary runs everywhere.
+			InstructionSet getInstructionSet();
+			std::string getInstructionSetName();
+			// restricts the kernels to a narrower instruction set, to compare implementations,
+			// a set wider than the detected one is ignored
+			void setInstructionSet(InstructionSet instructionSet);
+
+			// exp(x) from a degree-7 polynomial on [-ln2/2, ln2/2] and an exponent shift, the relative error
+			// stays below polynomialExpMaxRelativeError for x in [-708, 708], arguments outside are clamped
+			inline constexpr double polynomialExpMaxRelativeError = 1e-8;
+
+			// out[i] = exp(x[i]) with the polynomial above
+			void polynomialExp(std::span<const double> x, std::span<double> out);
+			// out[i] = 1 / (1 + exp(-beta * (x[i] - x0))) with the polynomial exp, the absolute error
+			// is at most a quarter of the relative error of the exp, so below 2.5e-9
+			void polynomialSigmoid(std::span<const double> x, double beta, double x0, std::span<double> out);
+			// out[i] = x[i] > threshold ? 1 : 0, exact
+			void heaviside(std::span<const double> x, double threshold, std::span<double> out);
+			// out[i] = sources[0][i] + sources[1][i] + ..., added in that order so the result matches a loop
+			// that adds one source after the other, every source holds at least out.size() values
+			void sumSources(std::span<const double* const> sources, std::span<double> out);
+
+			// the normal numbers of boxMuller are within this of those of the logarithm, sine and cosine of the standard library
+			inline constexpr double boxMullerMaxAbsoluteError = 1e-14;
+
+			// every pair (u, v) of uniform numbers in (0, 1) becomes the pair of normal numbers sqrt(-2 ln u) (cos 2pi v, sin 2pi v),
+			// the logarithm, sine and cosine are polynomials, every instruction set gives the same result, values holds whole pairs
+			void boxMuller(std::span<double> values);
+
+			// The valid convolution of many rows at once, stored interleaved: value i of row r is at [i * rows + r].
+			// input holds outputSize + kernelSize - 1 values of every row, kernel kernelSize, the kernel of every row its own.
+			// The vector lanes hold different rows, and every row is summed in the order of tools::math::conv_valid,
+			// so it gets exactly the result it gets alone.
+			void convolveInterleavedRows(const double* input, const double* kernel, double* output,
+				size_t rows, size_t kernelSize, size_t outputSize);
+
+			// One row of integrateFieldRows, the activation, resting level and input of a field,
+			// and the statistics of its new activation, carried from one call to the next.
+			struct FieldRow
+			{
+				double* activation;
+				const double* restingLevel;
+				const double* input;
+				double gain;
+				double lowest;
+				double highest;
+				double sum;
+				double sumOfSquares;
+			};
+			// activation[i] += gain * (-activation[i] + restingLevel[i] + input[i]) for i in [begin, end) of every row,
+			// and the lowest, highest, sum and sum of squares of the new values, accumulated in element order.
+			// Rows are processed four at a time, one per vector lane, so every row gets exactly the result it gets alone;
+			// no multiply-add is fused, so every instruction set gives the result of NeuralField::calculateActivation.
+			void integrateFieldRows(std::span<FieldRow> rows, size_t begin, size_t end);
+		}
+	}
+}
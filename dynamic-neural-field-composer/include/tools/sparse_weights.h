@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <map>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace math
+		{
+			enum class WeightStorage
+			{
+				DENSE,
+				// compressed sparse rows, the column of every kept weight is stored next to it
+				CSR,
+				// one contiguous range of columns per row, the zeros inside the range are kept
+				BANDED
+			};
+
+			inline const std::map<WeightStorage, std::string> WeightStorageToString = {
+				{WeightStorage::DENSE, "dense"},
+				{WeightStorage::CSR, "CSR"},
+				{WeightStorage::BANDED, "banded"}
+			};
+
+			// Compressed copy of an input-major weight matrix (one row per input, holding its weight to every output).
+			// compress() drops the weights whose magnitude is at most threshold * max|w| and picks the storage from
+			// the measured density, multiply() then gives the same product as matrixVectorMultiply, skipping the
+			// dropped weights and the inputs that are zero, without allocating.
+			class SparseWeights
+			{
+			private:
+				WeightStorage storage;
+				size_t rows;
+				size_t columns;
+				size_t nonZeros;
+				// start of every row in values, rows + 1 entries
+				std::vector<size_t> rowOffsets;
+				// CSR: the column of every value, BANDED: the first column of every row
+				std::vector<std::uint32_t> columnIndices;
+				std::vector<double> values;
+			public:
+				SparseWeights();
+
+				void compress(std::span<const double> weights, size_t rows, size_t columns, double threshold);
+				// output[i] = sum_j scalar * w(j, i) * input[j], output is overwritten
+				void multiply(std::span<const double> input, std::span<double> output, double scalar = 1.0) const;
+
+				WeightStorage getStorage() const { return storage; }
+				size_t getNonZeros() const { return nonZeros; }
+				double getDensity() const;
+
+				// drops what is negligible next to the largest weight, such as the far tails of a gaussian
+				static constexpr double defaultThreshold = 1e-10;
+				// above this density the dense product is faster than following the indices
+				static constexpr double maximumSparseDensity = 0.3;
+				// a band is stored when it covers at most this fraction of the matrix
+				// and holds at most maximumBandFill entries per kept weight
+				static constexpr double maximumBandedDensity = 0.5;
+				static constexpr double maximumBandFill = 2.0;
+			};
+		}
+	}
+}
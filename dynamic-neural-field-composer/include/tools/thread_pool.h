@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <cstdint>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace threading
+		{
+			// Persistent pool of worker threads.
+			// parallelFor() hands out the indices [0, count) to the workers and to the calling thread,
+			// and only returns once every index has been processed, so consecutive calls are separated
+			// by a barrier. Calls made from inside a worker run serially on that worker.
+			class ThreadPool
+			{
+			private:
+				std::vector<std::thread> workers;
+				std::mutex mutex;
+				std::mutex dispatchMutex;
+				std::condition_variable workAvailable;
+				std::condition_variable workFinished;
+				void* taskContext;
+				void (*taskInvoker)(void*, size_t);
+				size_t taskCount;
+				std::atomic<size_t> nextIndex;
+				size_t activeWorkers;
+				std::uint64_t generation;
+				std::exception_ptr taskException;
+				bool stopping;
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+				// heap allocations made by the workers while running tasks, the calling thread counts its own
+				std::atomic<size_t> workerAllocationCount{ 0 };
+#endif
+			public:
+				ThreadPool(int numberOfWorkers = 0);
+				ThreadPool(const ThreadPool&) = delete;
+				ThreadPool& operator=(const ThreadPool&) = delete;
+				~ThreadPool();
+
+				template <typename Task>
+				void parallelFor(size_t count, Task&& task)
+				{
+					using TaskType = std::remove_reference_t<Task>;
+					dispatch(count, const_cast<void*>(static_cast<const void*>(&task)),
+						[](void* context, size_t index) { (*static_cast<TaskType*>(context))(index); });
+				}
+
+				// number of threads that execute tasks, including the calling thread
+				int getNumberOfThreads() const;
+				static bool isWorkerThread();
+				static int getHardwareConcurrency();
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+				size_t getWorkerAllocationCount() const;
+#endif
+			private:
+				void dispatch(size_t count, void* context, void (*invoker)(void*, size_t));
+				void runTasks();
+				void workerLoop();
+			};
+		}
+	}
+}
@@ -29,6 +29,6 @@ namespace dnf_composer
 		void setScale(double min, double max);
 		std::pair<double, double> getScale() const;
 		std::string toString() const override;
-		void render(const std::vector<std::vector<double>*>& data, const std::vector<std::string>& legends) override;
+		void render(const std::vector<element::Component*>& data, const std::vector<std::string>& legends) override;
 	};
 }
\ No newline at end of file
@@ -31,6 +31,6 @@ namespace dnf_composer
 		double getLineThickness() const;
 		double getAutoFit() const;
 		std::string toString() const override;
-		void render(const std::vector<std::vector<double>*>& data, const std::vector<std::string>& legends) override;
+		void render(const std::vector<element::Component*>& data, const std::vector<std::string>& legends) override;
 	};
 }
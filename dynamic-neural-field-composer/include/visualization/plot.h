@@ -1,5 +1,6 @@
 #pragma once
 #include "plot_parameters.h"
+#include "elements/component_storage.h"
 
 
 namespace dnf_composer
@@ -24,6 +25,6 @@ namespace dnf_composer
 
 		virtual std::string toString() const = 0;
 
-		virtual void render(const std::vector<std::vector<double>*>& data, const std::vector< std::string>& legends) = 0;
+		virtual void render(const std::vector<element::Component*>& data, const std::vector< std::string>& legends) = 0;
 	};
 }
@@ -99,7 +99,8 @@ namespace dnf_composer
 
 		bool ElementCommonParameters::operator==(const ElementCommonParameters& other) const
 		{
-			return identifiers == other.identifiers && dimensionParameters == other.dimensionParameters;
+			return identifiers == other.identifiers && dimensionParameters == other.dimensionParameters &&
+				stepPeriod == other.stepPeriod;
 		}
 
 		void ElementCommonParameters::print() const
@@ -112,7 +113,8 @@ namespace dnf_composer
 			std::string result;
 			result += "Common parameters {";
 			result += "  " + identifiers.toString();
-			result += dimensionParameters.toString() + "}";
+			result += dimensionParameters.toString();
+			result += "Step period: " + std::to_string(stepPeriod) + "}";
 			return result;
 		}
 
@@ -11,15 +11,22 @@ namespace dnf_composer
 {
 	namespace element
 	{
-		SigmoidFunction::SigmoidFunction(double x_shift, double steepness)
-		: x_shift(x_shift), steepness(steepness)
+		SigmoidFunction::SigmoidFunction(double x_shift, double steepness, ExpApproximation expApproximation)
+		: x_shift(x_shift), steepness(steepness), expApproximation(expApproximation)
 		{
 			type = ActivationFunctionType::SIGMOID;
 		}
 
-		std::vector<double> SigmoidFunction::operator()(const std::vector<double>& input)
+		std::vector<double> SigmoidFunction::operator()(std::span<const double> input)
 		{
-			return tools::math::sigmoid(input, steepness, x_shift);
+			std::vector<double> output(input.size());
+			evaluate(input, output);
+			return output;
+		}
+
+		void SigmoidFunction::operator()(std::span<const double> input, std::span<double> output)
+		{
+			evaluate(input, output);
 		}
 
 		bool SigmoidFunction::operator==(const ActivationFunction& other) const
@@ -27,7 +34,8 @@ namespace dnf_composer
 			if (type == other.type)
 			{
 				auto& other_casted = dynamic_cast<const SigmoidFunction&>(other);
-				return x_shift == other_casted.getXShift() && steepness == other_casted.getSteepness();
+				return x_shift == other_casted.getXShift() && steepness == other_casted.getSteepness() &&
+					expApproximation == other_casted.getExpApproximation();
 			}
 			return false;
 		}
@@ -45,7 +53,10 @@ namespace dnf_composer
 			result += "x_shift = " + stream_x_shift.str() + ", ";
 			std::ostringstream stream_steepness;
 			stream_steepness << std::fixed << std::setprecision(2) << steepness;
-			result += "steepness = " + stream_steepness.str() + ")";
+			result += "steepness = " + stream_steepness.str();
+			if (expApproximation == ExpApproximation::POLYNOMIAL)
+				result += ", polynomial exp";
+			result += ")";
 			return result;
 		}
 
@@ -65,17 +76,32 @@ namespace dnf_composer
 			return x_shift;
 		}
 
+		ExpApproximation SigmoidFunction::getExpApproximation() const
+		{
+			return expApproximation;
+		}
+
+		void SigmoidFunction::setExpApproximation(ExpApproximation approximation)
+		{
+			expApproximation = approximation;
+		}
+
 		HeavisideFunction::HeavisideFunction(double x_shift)
 		: x_shift(x_shift)
 		{
 			type = ActivationFunctionType::HEAVISIDE;
 		}
 
-		std::vector<double> HeavisideFunction::operator()(const std::vector<double>& input)
+		std::vector<double> HeavisideFunction::operator()(std::span<const double> input)
 		{
 			return tools::math::heaviside(input, x_shift);
 		}
 
+		void HeavisideFunction::operator()(std::span<const double> input, std::span<double> output)
+		{
+			evaluate(input, output);
+		}
+
 		bool HeavisideFunction::operator==(const ActivationFunction& other) const
 		{
 			if (type == other.type)
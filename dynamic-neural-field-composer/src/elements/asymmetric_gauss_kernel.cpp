@@ -9,7 +9,7 @@ namespace dnf_composer
 			: Kernel(elementCommonParameters), parameters(std::move(agk_parameters))
 		{
 			commonParameters.identifiers.label = ElementLabel::ASYMMETRIC_GAUSS_KERNEL;
-			components["kernel"] = std::vector<double>(commonParameters.dimensionParameters.size);
+			components[ComponentSlot::KERNEL] = Component(commonParameters.dimensionParameters.size);
 		}
 
 		void AsymmetricGaussKernel::init()
@@ -21,12 +21,12 @@ namespace dnf_composer
             if (parameters.circular)
             {
                 extIndex = tools::math::createExtendedIndex(commonParameters.dimensionParameters.size, kernelRange);
-                components["input"].resize(extIndex.size());
+                components[ComponentSlot::INPUT].resize(extIndex.size());
             }
             else
             {
                 extIndex = {};
-                components["input"].resize(commonParameters.dimensionParameters.size);
+                components[ComponentSlot::INPUT].resize(commonParameters.dimensionParameters.size);
             }
 
             // Generate the Gaussian kernel
@@ -51,44 +51,25 @@ namespace dnf_composer
             }
 
             // Combine Gaussian with its derivative for asymmetry
-            components["kernel"].resize(rangeX.size());
-            for (int i = 0; i < components["kernel"].size(); i++)
+            components[ComponentSlot::KERNEL].resize(rangeX.size());
+            for (size_t i = 0; i < components[ComponentSlot::KERNEL].size(); i++)
             {
-                components["kernel"][i] = parameters.amplitude * gauss[i] + parameters.timeShift * gaussDerivative[i];
+                components[ComponentSlot::KERNEL][i] = parameters.amplitude * gauss[i] + parameters.timeShift * gaussDerivative[i];
             }
 
             fullSum = 0.0;
-            std::ranges::fill(components["input"], 0.0);
-            std::ranges::fill(components["output"], 0.0);
+            std::ranges::fill(components[ComponentSlot::INPUT], 0.0);
+            std::ranges::fill(components[ComponentSlot::OUTPUT], 0.0);
+            prepareConvolution(parameters.circular);
 		}
 
 		void AsymmetricGaussKernel::step(double t, double deltaT)
 		{
-            updateInput();
-
 			// find a way to get the velocity and acceleration of the input
             // n(t) = -tau * v(t) -tau * c * a(t)
 			// c - constant time shift
 
-            fullSum = std::accumulate(components["input"].begin(), components["input"].end(), (double)0.0);
-
-            // Compute convolution
-            std::vector<double> convolution(commonParameters.dimensionParameters.size);
-            const std::vector<double> subDataInput = tools::math::obtainCircularVector(extIndex, components["input"]);
-
-            if (parameters.circular)
-            {
-                convolution = tools::math::conv_valid(subDataInput, components["kernel"]);
-            }
-            else
-            {
-                convolution = tools::math::conv_same(components["input"], components["kernel"]);
-            }
-
-            for (int i = 0; i < components["output"].size(); i++)
-            {
-                components["output"][i] = convolution[i] + parameters.amplitudeGlobal * fullSum;
-            }
+            convolveInput(parameters.circular, parameters.amplitudeGlobal);
 		}
 
 		std::string AsymmetricGaussKernel::toString() const
@@ -109,6 +90,7 @@ namespace dnf_composer
 		{
 			parameters = agk_parameters;
 			init();
+			notifyParameterChange();
 		}
 
 		AsymmetricGaussKernelParameters AsymmetricGaussKernel::getParameters() const
@@ -0,0 +1,141 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "elements/component_storage.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "exceptions/exception.h"
+
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		ComponentStorage::ComponentStorage()
+		{
+			present.fill(false);
+		}
+
+		Component& ComponentStorage::operator[](const std::string& componentName)
+		{
+			ComponentSlot slot;
+			if (isStandardComponent(componentName, slot))
+				return operator[](slot);
+			return extraComponents[componentName];
+		}
+
+		Component& ComponentStorage::at(ComponentSlot slot)
+		{
+			if (!contains(slot))
+				throw Exception(ErrorCode::ELEM_COMP_NOT_FOUND, std::string{}, ComponentSlotToString[static_cast<size_t>(slot)]);
+			return slots[static_cast<size_t>(slot)];
+		}
+
+		const Component& ComponentStorage::at(ComponentSlot slot) const
+		{
+			if (!contains(slot))
+				throw Exception(ErrorCode::ELEM_COMP_NOT_FOUND, std::string{}, ComponentSlotToString[static_cast<size_t>(slot)]);
+			return slots[static_cast<size_t>(slot)];
+		}
+
+		Component& ComponentStorage::at(const std::string& componentName)
+		{
+			ComponentSlot slot;
+			if (isStandardComponent(componentName, slot))
+				return at(slot);
+			const auto component = extraComponents.find(componentName);
+			if (component == extraComponents.end())
+				throw Exception(ErrorCode::ELEM_COMP_NOT_FOUND, std::string{}, componentName);
+			return component->second;
+		}
+
+		const Component& ComponentStorage::at(const std::string& componentName) const
+		{
+			ComponentSlot slot;
+			if (isStandardComponent(componentName, slot))
+				return at(slot);
+			const auto component = extraComponents.find(componentName);
+			if (component == extraComponents.end())
+				throw Exception(ErrorCode::ELEM_COMP_NOT_FOUND, std::string{}, componentName);
+			return component->second;
+		}
+
+		bool ComponentStorage::contains(const std::string& componentName) const
+		{
+			ComponentSlot slot;
+			if (isStandardComponent(componentName, slot))
+				return contains(slot);
+			return extraComponents.contains(componentName);
+		}
+
+		size_t ComponentStorage::size() const
+		{
+			return std::ranges::count(present, true) + extraComponents.size();
+		}
+
+		std::vector<std::string> ComponentStorage::getNames() const
+		{
+			std::vector<std::string> componentNames;
+			componentNames.reserve(size());
+			forEach([&](const std::string& componentName, const Component&)
+			{
+				componentNames.push_back(componentName);
+			});
+			return componentNames;
+		}
+
+		namespace
+		{
+			void relocateComponent(Component& component, std::pmr::memory_resource* resource)
+			{
+				if (component.get_allocator().resource() == resource)
+					return;
+				// the allocator of a pmr vector cannot be changed, so the vector is rebuilt in place
+				// to keep its address (the GUI holds pointers to components)
+				Component relocated(component.begin(), component.end(), resource);
+				std::destroy_at(&component);
+				std::construct_at(&component, std::move(relocated));
+			}
+		}
+
+		void ComponentStorage::relocate(std::pmr::memory_resource* resource)
+		{
+			forEach([resource](const std::string&, Component& component)
+			{
+				relocateComponent(component, resource);
+			});
+		}
+
+		void ComponentStorage::relocate(ComponentSlot slot, std::pmr::memory_resource* resource)
+		{
+			if (contains(slot))
+				relocateComponent(slots[static_cast<size_t>(slot)], resource);
+		}
+
+		size_t ComponentStorage::getFootprint(size_t alignment) const
+		{
+			size_t footprint = 0;
+			forEach([&](const std::string&, const Component& component)
+			{
+				footprint += (component.size() * sizeof(double) + alignment - 1) / alignment * alignment;
+			});
+			return footprint;
+		}
+
+		bool ComponentStorage::isStandardComponent(const std::string& componentName, ComponentSlot& slot)
+		{
+			for (size_t i = 0; i < ComponentSlotToString.size(); i++)
+			{
+				if (ComponentSlotToString[i] == componentName)
+				{
+					slot = static_cast<ComponentSlot>(i);
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+}
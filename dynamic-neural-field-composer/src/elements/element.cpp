@@ -4,12 +4,36 @@
 
 #include "elements/element.h"
 
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <tuple>
+
+#include "tools/simd.h"
+
 
 namespace dnf_composer
 {
 	namespace element
 	{
+		void sumInputSources(std::span<const InputSource> sources, std::span<const double*> pointers, std::span<double> out)
+		{
+			// the part every source covers is summed by one vectorized pass over all the sources
+			size_t common = out.size();
+			for (size_t s = 0; s < sources.size(); s++)
+			{
+				pointers[s] = sources[s].component->data();
+				common = std::min(common, sources[s].component->size());
+			}
+			tools::simd::sumSources(pointers, out.first(common));
+			std::fill(out.begin() + static_cast<std::ptrdiff_t>(common), out.end(), 0.0);
+			for (const auto& [element, component] : sources)
+				for (size_t i = common; i < std::min(component->size(), out.size()); i++)
+					out[i] += (*component)[i];
+		}
+
 		Element::Element(const ElementCommonParameters& parameters)
+			: doubleBuffered(false), transientComponentsSwapped(false), publishedParameterRevision(0), threadPool(nullptr), inputGatherRevision(0), connectionRevision(1), parameterRevision(0)
 		{
 			if(parameters.dimensionParameters.size <= 0)
 			{
@@ -19,18 +43,18 @@ namespace dnf_composer
 				return;
 			}
 			commonParameters = parameters;
-			components["output"] = std::vector<double>(commonParameters.dimensionParameters.size);
-			components["input"] = std::vector<double>(commonParameters.dimensionParameters.size);
+			if (commonParameters.stepPeriod < 1)
+				throw Exception(ErrorCode::ELEM_INVALID_PARAMETER, "stepPeriod");
+			components[ComponentSlot::OUTPUT] = Component(commonParameters.dimensionParameters.size);
+			components[ComponentSlot::INPUT] = Component(commonParameters.dimensionParameters.size);
 		}
 
 		void Element::close()
 		{
-			// views::values can be used
-			for (auto& pair : components)
+			components.forEach([](const std::string&, Component& component)
 			{
-				auto& component = pair.second;
 				std::ranges::fill(component, 0);
-			}
+			});
 		}
 
 		void Element::print() const
@@ -38,6 +62,127 @@ namespace dnf_composer
 			log(tools::logger::LogLevel::INFO, toString());
 		}
 
+		bool Element::isDelayPoint() const
+		{
+			return false;
+		}
+
+		bool Element::isTransientComponent(const std::string& componentName) const
+		{
+			return componentName == "input";
+		}
+
+		bool Element::isConstantComponent(const std::string&) const
+		{
+			return false;
+		}
+
+		void Element::saveState(ElementState& state) const
+		{
+			// the components are visited in the same order by restoreState, as long as none is added in between
+			const auto save = [this](const ComponentStorage& storage, std::vector<std::vector<double>>& saved)
+			{
+				size_t index = 0;
+				storage.forEach([this, &saved, &index](const std::string& componentName, const Component& component)
+				{
+					if (isConstantComponent(componentName))
+						return;
+					if (index == saved.size())
+						saved.emplace_back();
+					saved[index++].assign(component.begin(), component.end());
+				});
+				saved.resize(index);
+			};
+			save(components, state.components);
+			if (doubleBuffered)
+				save(publishedComponents, state.publishedComponents);
+		}
+
+		void Element::restoreState(const ElementState& state)
+		{
+			const auto restore = [this](ComponentStorage& storage, const std::vector<std::vector<double>>& saved)
+			{
+				size_t index = 0;
+				storage.forEach([this, &saved, &index](const std::string& componentName, Component& component)
+				{
+					if (isConstantComponent(componentName))
+						return;
+					const auto& savedComponent = saved.at(index++);
+					component.assign(savedComponent.begin(), savedComponent.end());
+				});
+			};
+			restore(components, state.components);
+			if (doubleBuffered)
+				restore(publishedComponents, state.publishedComponents);
+		}
+
+		void Element::wake()
+		{
+			stepRecord.lastChange = std::numeric_limits<std::int64_t>::max();
+		}
+
+		bool Element::haveInputsChangedSince(std::int64_t step, bool published) const
+		{
+			const auto hasChanged = [step, published](const Element& input)
+			{
+				const StepRecord& record = input.stepRecord;
+				return (published ? record.publishedLastChange : record.lastChange) >= step;
+			};
+			if (isInputGatherUpToDate())
+				return std::ranges::any_of(inputGather, [&](const InputSource& source) { return hasChanged(*source.element); });
+			return std::ranges::any_of(inputs, [&](const auto& pair) { return hasChanged(*pair.first); });
+		}
+
+		bool Element::isStatic() const
+		{
+			return false;
+		}
+
+		bool Element::isObservable() const
+		{
+			return false;
+		}
+
+		bool Element::canHoldOutputs() const
+		{
+			return true;
+		}
+
+		ComponentSlot Element::getStateSlot() const
+		{
+			return ComponentSlot::OUTPUT;
+		}
+
+		void Element::setRandomSeed(std::uint64_t)
+		{
+		}
+
+		void Element::prepareComponent(const std::string& componentName)
+		{
+			// the input component of an element that reads its inputs in place is only written on demand
+			if (componentName == "input" && isReadingInputView())
+				updateInputFromConnections();
+		}
+
+		bool Element::isReadingInputView() const
+		{
+			return false;
+		}
+
+		std::span<const double> Element::gatherInput(size_t size)
+		{
+			const auto& sources = getInputGather();
+			if (sources.size() == 1 && sources.front().component->size() == size)
+				return *sources.front().component;
+
+			if (sharedInputSum && sharedInputSum->size() >= size)
+				return sharedInputSum->gather(sources).first(size);
+
+			updateInput();
+			const auto& input = components[ComponentSlot::INPUT];
+			return std::span<const double>(input).first(std::min(size, input.size()));
+		}
+
 		void Element::addInput(const std::shared_ptr<Element>& inputElement, const std::string& inputComponent)
 		{
 			if (!inputElement)
@@ -68,6 +213,8 @@ namespace dnf_composer
 
 			inputs[inputElement] = inputComponent;
 			inputElement->outputs[this->shared_from_this()] = inputComponent;
+			notifyConnectionChange();
+			inputElement->notifyConnectionChange();
 
 			const std::string logMessage = "Input '" + inputElement->getUniqueName() +"' added successfully to '" +  this->getUniqueName() + ".";
 			log(tools::logger::LogLevel::INFO, logMessage);
@@ -79,6 +226,7 @@ namespace dnf_composer
 			{
 				if (key->commonParameters.identifiers.uniqueName == inputElementId) {
 					inputs.erase(key);
+					notifyConnectionChange();
 					log(tools::logger::LogLevel::INFO, "Input '" + inputElementId + "' removed successfully from '" 
 						+ this->getUniqueName() + ". ");
 					return;
@@ -92,6 +240,7 @@ namespace dnf_composer
 			{
 				if (key->commonParameters.identifiers.uniqueIdentifier == uniqueId) {
 					inputs.erase(key);
+					notifyConnectionChange();
 					log(tools::logger::LogLevel::INFO, "Input '" + std::to_string(uniqueId) + "' removed successfully from '" 
 						+ this->getUniqueName() + ".");
 					return;
@@ -128,26 +277,144 @@ namespace dnf_composer
 			{
 				const auto inputElement = input_pair.first;
 				inputElement->outputs.erase(this->shared_from_this());
+				inputElement->notifyConnectionChange();
 			}
 			inputs.clear();
+			notifyConnectionChange();
 		}
 
 		void Element::updateInput()
 		{
-			std::ranges::fill(components["input"], 0);
+			const auto& sources = getInputGather();
+			sumInputSources(sources, std::span<const double*>(inputGatherPointers).first(sources.size()), components[ComponentSlot::INPUT]);
+		}
 
-			for (const auto& input_pair : inputs) 
+		void Element::updateInputFromConnections()
+		{
+			auto& input = components[ComponentSlot::INPUT];
+			std::ranges::fill(input, 0);
+			for (const auto& [inputElement, inputComponent] : getOrderedInputs())
 			{
-				const auto inputElement = input_pair.first;
-				auto inputElementComponent = input_pair.second;
-				auto& inputElementComponents = inputElement->components;
-				const auto& inputElementComponentValue = inputElementComponents.at(inputElementComponent);
-
-				for (size_t i = 0; i < inputElementComponentValue.size(); i++)
-					components["input"][i] += inputElementComponentValue[i];
+				const Component& source = inputElement->getPublishedComponent(inputComponent);
+				const size_t size = std::min(source.size(), input.size());
+				for (size_t i = 0; i < size; i++)
+					input[i] += source[i];
 			}
 		}
 
+		void Element::compileInputGather()
+		{
+			inputGather.clear();
+			for (const auto& [inputElement, inputComponent] : getOrderedInputs())
+				inputGather.push_back({ inputElement.get(), &inputElement->getPublishedComponent(inputComponent) });
+			inputGatherPointers.resize(inputGather.size());
+			inputGatherRevision = connectionRevision;
+		}
+
+		const std::vector<InputSource>& Element::getInputGather() const
+		{
+			// the simulation compiles the gather of every element before it steps them, a step never does
+			assert(isInputGatherUpToDate() && "the input gather must be compiled before the element is stepped");
+			return inputGather;
+		}
+
+		bool Element::isInputGatherUpToDate() const
+		{
+			return inputGatherRevision == connectionRevision;
+		}
+
+		void Element::setDoubleBuffered(bool doubleBuffered)
+		{
+			this->doubleBuffered = doubleBuffered;
+			if (doubleBuffered)
+				publishedComponents = components;
+			else
+				publishedComponents = ComponentStorage{};
+			publishedParameterRevision = parameterRevision;
+			// the elements that read this one must resolve the components they read again
+			notifyConnectionChange();
+			for (const auto& outputElement : outputs | std::views::keys)
+				outputElement->notifyConnectionChange();
+		}
+
+		bool Element::isDoubleBuffered() const
+		{
+			return doubleBuffered;
+		}
+
+		void Element::publishComponents(bool swapping)
+		{
+			transientComponentsSwapped = false;
+			if (!doubleBuffered)
+				return;
+
+			// constant components only change with the parameters, until then the published copy still holds them
+			const bool parametersChanged = publishedParameterRevision != parameterRevision;
+			components.forEach([this, parametersChanged, swapping](const std::string& componentName, Component& component)
+			{
+				if (!parametersChanged && isConstantComponent(componentName))
+					return;
+				// a transient component is written whole in every step, so the buffers trade places,
+				// the others are updated in place from their previous values and must be copied
+				auto& publishedComponent = publishedComponents[componentName];
+				if (swapping && isTransientComponent(componentName) && publishedComponent.size() == component.size() &&
+					publishedComponent.get_allocator() == component.get_allocator())
+				{
+					publishedComponent.swap(component);
+					transientComponentsSwapped = true;
+				}
+				else
+					publishedComponent = component;
+			});
+			publishedParameterRevision = parameterRevision;
+		}
+
+		void Element::keepPublishedComponents()
+		{
+			if (!transientComponentsSwapped)
+				return;
+			components.forEach([this](const std::string& componentName, Component& component)
+			{
+				if (isTransientComponent(componentName))
+					std::ranges::copy(publishedComponents[componentName], component.begin());
+			});
+			transientComponentsSwapped = false;
+		}
+
+		void Element::relocateComponents(const std::shared_ptr<tools::memory::Arena>& arena)
+		{
+			components.relocate(arena.get());
+			if (doubleBuffered)
+				publishedComponents.relocate(arena.get());
+			componentArena = arena;
+		}
+
+		void Element::relocateComponents(const std::shared_ptr<tools::memory::Arena>& arena, ComponentSlot slot)
+		{
+			components.relocate(slot, arena.get());
+			if (doubleBuffered)
+				publishedComponents.relocate(slot, arena.get());
+			componentArena = arena;
+		}
+
+		size_t Element::getComponentFootprint() const
+		{
+			size_t footprint = components.getFootprint(tools::memory::Arena::alignment);
+			if (doubleBuffered)
+				footprint += publishedComponents.getFootprint(tools::memory::Arena::alignment);
+			return footprint;
+		}
+
+		void Element::setThreadPool(tools::threading::ThreadPool* threadPool)
+		{
+			this->threadPool = threadPool;
+		}
+
+		void Element::setSharedInputSum(const std::shared_ptr<SharedInputSum>& sum)
+		{
+			sharedInputSum = sum;
+		}
+
 		int Element::getMaxSpatialDimension() const
 		{
 			return commonParameters.dimensionParameters.x_max;
@@ -174,6 +441,18 @@ namespace dnf_composer
 			return commonParameters;
 		}
 
+		void Element::setStepPeriod(int stepPeriod)
+		{
+			if (stepPeriod < 1)
+				throw Exception(ErrorCode::ELEM_INVALID_PARAMETER, "stepPeriod");
+			commonParameters.stepPeriod = stepPeriod;
+		}
+
+		int Element::getStepPeriod() const
+		{
+			return commonParameters.stepPeriod;
+		}
+
 		bool Element::hasOutput(int outputElementId, const std::string& outputComponent)
 		{
 			const bool found = std::ranges::any_of(outputs, [&](const auto& pair) {
@@ -192,8 +471,10 @@ namespace dnf_composer
 			{
 				const auto outputElement = output_pair.first;
 				outputElement->inputs.erase(this->shared_from_this());
+				outputElement->notifyConnectionChange();
 			}
 			outputs.clear();
+			notifyConnectionChange();
 		}
 
 		int Element::getSize() const
@@ -207,6 +488,7 @@ namespace dnf_composer
 			{
 				if (key->commonParameters.identifiers.uniqueIdentifier == uniqueId) {
 					outputs.erase(key);
+					notifyConnectionChange();
 					log(tools::logger::LogLevel::INFO, "Output '" + std::to_string(uniqueId) + "' removed successfully from '" 
 						+ this->getUniqueName() + ".");
 					return;
@@ -220,6 +502,7 @@ namespace dnf_composer
 			{
 				if (key->commonParameters.identifiers.uniqueName == outputElementId) {
 					outputs.erase(key);
+					notifyConnectionChange();
 					log(tools::logger::LogLevel::INFO, "Output '" + outputElementId + "' removed successfully from '" 
 						+ this->getUniqueName() + ".");
 					return;
@@ -245,37 +528,42 @@ namespace dnf_composer
 		std::vector<double> Element::getComponent(const std::string& componentName)
 		{
 			if (components.contains(componentName))
-				return components.at(componentName);
+			{
+				prepareComponent(componentName);
+				const auto& component = components.at(componentName);
+				return { component.begin(), component.end() };
+			}
 			throw Exception(ErrorCode::ELEM_COMP_NOT_FOUND, commonParameters.identifiers.uniqueName, componentName);
 		}
 
-		std::vector<double>* Element::getComponentPtr(const std::string& componentName)
+		Component* Element::getComponentPtr(const std::string& componentName)
 		{
 			if (components.contains(componentName))
+			{
+				prepareComponent(componentName);
 				return &components.at(componentName);
+			}
 			throw Exception(ErrorCode::ELEM_COMP_NOT_FOUND, commonParameters.identifiers.uniqueName, componentName);
 		}
 
 		std::vector<std::string> Element::getComponentList() const
 		{
-
-			std::vector<std::string> componentNames;
-			componentNames.reserve(components.size());
-
-			for (const auto& pair : components)
-			{
-				const std::string& componentName = pair.first;
-				componentNames.push_back(componentName);
-			}
-
-			return componentNames;
+			return components.getNames();
 		}
 
-		const std::unordered_map<std::string, std::vector<double>>* Element::getComponents() const
+		const ComponentStorage* Element::getComponents() const
 		{
 			return &components;
 		}
 
+		const Component& Element::getPublishedComponent(const std::string& componentName) const
+		{
+			const auto& source = doubleBuffered ? publishedComponents : components;
+			if (source.contains(componentName))
+				return source.at(componentName);
+			throw Exception(ErrorCode::ELEM_COMP_NOT_FOUND, commonParameters.identifiers.uniqueName, componentName);
+		}
+
 		std::vector<std::shared_ptr<Element>> Element::getInputs()
 		{
 			std::vector<std::shared_ptr<Element>> inputVec;
@@ -292,6 +580,17 @@ namespace dnf_composer
 			return inputs;
 		}
 
+		std::vector<std::pair<std::shared_ptr<Element>, std::string>> Element::getOrderedInputs() const
+		{
+			std::vector<std::pair<std::shared_ptr<Element>, std::string>> orderedInputs(inputs.begin(), inputs.end());
+			std::ranges::sort(orderedInputs, [](const auto& a, const auto& b)
+			{
+				return std::tie(a.first->commonParameters.identifiers.uniqueName, a.second) <
+					std::tie(b.first->commonParameters.identifiers.uniqueName, b.second);
+			});
+			return orderedInputs;
+		}
+
 		bool Element::hasOutput() const
 		{
 			return !outputs.empty();
@@ -313,5 +612,15 @@ namespace dnf_composer
 			return outputVec;
 		}
 
+		void Element::notifyConnectionChange()
+		{
+			++connectionRevision;
+		}
+
+		void Element::notifyParameterChange()
+		{
+			wake();
+			++parameterRevision;
+		}
 	}
-}
+}
\ No newline at end of file
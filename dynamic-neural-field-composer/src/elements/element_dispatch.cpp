@@ -0,0 +1,69 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "elements/element_dispatch.h"
+
+#include <typeinfo>
+#include <algorithm>
+#include <type_traits>
+
+#include "elements/neural_field.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/gauss_kernel.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/oscillatory_kernel.h"
+#include "elements/asymmetric_gauss_kernel.h"
+#include "elements/normal_noise.h"
+#include "elements/field_coupling.h"
+#include "elements/gauss_field_coupling.h"
+
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		namespace
+		{
+			template <size_t index>
+			using BatchElementType = std::remove_pointer_t<typename std::variant_alternative_t<index, ElementBatch>::value_type>;
+
+			// an element belongs to a batch of a known class only if it is exactly of that class
+			template <size_t index = 1>
+			size_t findBatchIndex(const std::type_info& type)
+			{
+				if constexpr (index == std::variant_size_v<ElementBatch>)
+					return 0;
+				else
+					return typeid(BatchElementType<index>) == type ? index : findBatchIndex<index + 1>(type);
+			}
+
+			template <size_t index = 0>
+			ElementBatch makeBatchOfIndex(size_t batchIndex, std::span<Element* const> elements)
+			{
+				if constexpr (index + 1 < std::variant_size_v<ElementBatch>)
+					if (batchIndex != index)
+						return makeBatchOfIndex<index + 1>(batchIndex, elements);
+
+				std::vector<BatchElementType<index>*> batch;
+				batch.reserve(elements.size());
+				for (Element* element : elements)
+					batch.push_back(static_cast<BatchElementType<index>*>(element));
+				// fields of the same size are kept together, so they are stepped as the rows of one matrix
+				if constexpr (std::is_same_v<BatchElementType<index>, NeuralField>)
+					std::ranges::stable_sort(batch, {}, [](const NeuralField* field) { return field->getSize(); });
+				return ElementBatch{ std::in_place_index<index>, std::move(batch) };
+			}
+		}
+
+		size_t getBatchIndex(const Element& element)
+		{
+			return findBatchIndex(typeid(element));
+		}
+
+		ElementBatch makeBatch(size_t batchIndex, std::span<Element* const> elements)
+		{
+			return makeBatchOfIndex(batchIndex, elements);
+		}
+	}
+}
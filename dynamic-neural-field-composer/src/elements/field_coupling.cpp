@@ -11,14 +11,17 @@ namespace dnf_composer
 
 		FieldCoupling::FieldCoupling(const ElementCommonParameters& elementCommonParameters, 
 			const FieldCouplingParameters& parameters)
-			: Element(elementCommonParameters), parameters(parameters)
+			: Element(elementCommonParameters), parameters(parameters),
+			weightThreshold(tools::math::SparseWeights::defaultThreshold), sparseWeightsUpToDate(false), learningStepCount(0)
 		{
+			if (parameters.learningPeriod < 1)
+				throw Exception(ErrorCode::ELEM_INVALID_PARAMETER, "learningPeriod");
 			commonParameters.identifiers.label = ElementLabel::FIELD_COUPLING;
-			components["input"] = std::vector<double>(parameters.inputFieldDimensions.size);
-			components["output"] = std::vector<double>(commonParameters.dimensionParameters.size);
-			components["weights"] = std::vector<double>(components.at("input").size()
-				* components.at("output").size());
-			std::ranges::fill(components["weights"], 0);
+			components[ComponentSlot::INPUT] = Component(parameters.inputFieldDimensions.size);
+			components[ComponentSlot::OUTPUT] = Component(commonParameters.dimensionParameters.size);
+			components[ComponentSlot::WEIGHTS] = Component(components.at(ComponentSlot::INPUT).size()
+				* components.at(ComponentSlot::OUTPUT).size());
+			std::ranges::fill(components[ComponentSlot::WEIGHTS], 0);
 			weightsDirectory = std::string(OUTPUT_DIRECTORY) + "/inter-field-synaptic-connections";
 			readWeights();
 		}
@@ -26,22 +29,39 @@ namespace dnf_composer
 		void FieldCoupling::init()
 		{
 			parameters.isLearningActive = false;
-			std::ranges::fill(components["input"], 0);
-			std::ranges::fill(components["output"], 0);
+			learningStepCount = 0;
+			std::ranges::fill(components[ComponentSlot::INPUT], 0);
+			std::ranges::fill(components[ComponentSlot::OUTPUT], 0);
+			normalizedInputActivation.resize(parameters.inputFieldDimensions.size);
+			normalizedOutputActivation.resize(commonParameters.dimensionParameters.size);
 
 			updateInputField();
 			updateOutputField();
+			compressWeights();
 			if(!checkValidConnections())
 				return;
 		}
 
 		void FieldCoupling::step(double t, double deltaT)
 		{
-			updateInput();
 			updateOutput();
-			if (parameters.isLearningActive)
-				if(checkValidConnections())
-					updateWeights();
+			// the weights learn once per step, in its first stage
+			if (parameters.isLearningActive && stepRecord.stage == 0)
+				if (learningStepCount++ % static_cast<std::uint64_t>(parameters.learningPeriod) == 0)
+					if(checkValidConnections())
+						updateWeights();
+		}
+
+		void FieldCoupling::saveState(ElementState& state) const
+		{
+			Element::saveState(state);
+			state.counters.assign(1, learningStepCount);
+		}
+
+		void FieldCoupling::restoreState(const ElementState& state)
+		{
+			Element::restoreState(state);
+			learningStepCount = state.counters.at(0);
 		}
 
 		std::string FieldCoupling::toString() const
@@ -60,7 +80,12 @@ namespace dnf_composer
 
 		void FieldCoupling::setParameters(const FieldCouplingParameters& fcp)
 		{
+			if (fcp.learningPeriod < 1)
+				throw Exception(ErrorCode::ELEM_INVALID_PARAMETER, "learningPeriod");
 			parameters = fcp;
+			notifyParameterChange();
+			if (!parameters.isLearningActive && !sparseWeightsUpToDate)
+				compressWeights();
 		}
 
 		void FieldCoupling::setWeightsDirectory(const std::string& dir)
@@ -73,9 +98,23 @@ namespace dnf_composer
 			parameters.learningRate = learningRate;
 		}
 
+		void FieldCoupling::setLearningPeriod(int learningPeriod)
+		{
+			if (learningPeriod < 1)
+				throw Exception(ErrorCode::ELEM_INVALID_PARAMETER, "learningPeriod");
+			parameters.learningPeriod = learningPeriod;
+		}
+
 		void FieldCoupling::setLearning(bool learning)
 		{
+			// the first step after learning is switched on updates the weights
+			if (learning && !parameters.isLearningActive)
+				learningStepCount = 0;
 			parameters.isLearningActive = learning;
+			// while learning the dense weights are used, they change every step
+			if (!learning && !sparseWeightsUpToDate)
+				compressWeights();
+			notifyParameterChange();
 		}
 
 		FieldCouplingParameters FieldCoupling::getParameters() const
@@ -88,18 +127,38 @@ namespace dnf_composer
 			return weightsDirectory;
 		}
 
-		void FieldCoupling::updateOutput()
+		void FieldCoupling::setWeightThreshold(double threshold)
+		{
+			weightThreshold = threshold;
+			compressWeights();
+			notifyParameterChange();
+		}
+
+		double FieldCoupling::getWeightThreshold() const
 		{
-			components["output"] = std::vector<double>(components["output"].size(), 0);
+			return weightThreshold;
+		}
 
-			for (size_t i = 0; i < components["output"].size(); i++)
-			{
-				for (size_t j = 0; j < components["input"].size(); j++)
-				{
-					const size_t index = j * components["output"].size() + i;
-					components["output"][i] += parameters.scalar * components["weights"][index] * components["input"][j];
-				}
-			}
+		tools::math::WeightStorage FieldCoupling::getWeightStorage() const
+		{
+			return sparseWeightsUpToDate ? sparseWeights.getStorage() : tools::math::WeightStorage::DENSE;
+		}
+
+		void FieldCoupling::compressWeights()
+		{
+			sparseWeights.compress(components[ComponentSlot::WEIGHTS], components[ComponentSlot::INPUT].size(),
+				components[ComponentSlot::OUTPUT].size(), weightThreshold);
+			sparseWeightsUpToDate = true;
+		}
+
+		void FieldCoupling::updateOutput()
+		{
+			const std::span<const double> input = gatherInput(components[ComponentSlot::INPUT].size());
+			if (sparseWeightsUpToDate && sparseWeights.getStorage() != tools::math::WeightStorage::DENSE)
+				sparseWeights.multiply(input, components[ComponentSlot::OUTPUT], parameters.scalar);
+			else
+				tools::math::matrixVectorMultiply(components[ComponentSlot::WEIGHTS], input,
+					components[ComponentSlot::OUTPUT], parameters.scalar, threadPool);
 		}
 
 		void FieldCoupling::updateInputField()
@@ -146,23 +205,33 @@ namespace dnf_composer
 
 		void FieldCoupling::updateWeights()
 		{
-			std::vector<double> inputActivation = input->getComponents()->at("activation");
-			std::vector<double> outputActivation = output->getComponents()->at("activation");
-
-			inputActivation = tools::math::normalize(inputActivation);
-			outputActivation = tools::math::normalize(outputActivation);
+			const Component& inputActivation = input->getPublishedComponent("activation");
+			const Component& outputActivation = output->getPublishedComponent("activation");
+
+			// the buffers are sized in init(), resizing only happens if the fields changed size since
+			normalizedInputActivation.resize(inputActivation.size());
+			normalizedOutputActivation.resize(outputActivation.size());
+			tools::math::normalize(inputActivation, normalizedInputActivation);
+			tools::math::normalize(outputActivation, normalizedOutputActivation);
+			sparseWeightsUpToDate = false;
+			// an update every learningPeriod steps makes up for the steps in between
+			const double learningRate = parameters.learningRate * parameters.learningPeriod;
+			// the normalized activations are at least 0 and only the lowest one is 0, the row of an input at most
+			// weightThreshold times the largest one changes by as little next to the others as the weights
+			// the compression drops, so it is not updated
+			const double inputThreshold = weightThreshold * *std::ranges::max_element(normalizedInputActivation);
 
 			switch (parameters.learningRule)
 			{
 			case LearningRule::DELTA:
 				log(tools::logger::LogLevel::ERROR, "Unsupervised delta learning rule is not implemented yet.");
-				//tools::math::unsupervisedDeltaLearningRule(components["weights"], inputActivation, outputActivation, parameters.learningRate);
+				//tools::math::unsupervisedDeltaLearningRule(components[ComponentSlot::WEIGHTS], normalizedInputActivation, normalizedOutputActivation, learningRate);
 				break;
 			case LearningRule::HEBB:
-				tools::math::hebbLearningRule(components["weights"], inputActivation, outputActivation, parameters.learningRate);
+				tools::math::hebbLearningRule(components[ComponentSlot::WEIGHTS], normalizedInputActivation, normalizedOutputActivation, learningRate, inputThreshold);
 				break;
 			case LearningRule::OJA:
-				tools::math::ojaLearningRule(components["weights"], inputActivation, outputActivation, parameters.learningRate);
+				tools::math::ojaLearningRule(components[ComponentSlot::WEIGHTS], normalizedInputActivation, normalizedOutputActivation, learningRate, inputThreshold);
 				break;
 			}
 		}
@@ -171,13 +240,50 @@ namespace dnf_composer
 		{
 			const std::string filename = weightsDirectory + "/" + commonParameters.identifiers.uniqueName + "_weights.txt";
 			std::ifstream file(filename);
+			notifyParameterChange();
 
-			const size_t inputSize = components.at("input").size();
-			const size_t outputSize = components.at("output").size();
+			const size_t inputSize = components.at(ComponentSlot::INPUT).size();
+			const size_t outputSize = components.at(ComponentSlot::OUTPUT).size();
 			const size_t expectedSize = inputSize * outputSize;
 
 			if (file.is_open()) 
 			{
+				// files written before the layout was recorded have no header and are input-major
+				std::string layout = "input-major";
+				size_t fileInputSize = inputSize;
+				size_t fileOutputSize = outputSize;
+				if (file.peek() == '#')
+				{
+					std::string header;
+					std::getline(file, header);
+					std::istringstream headerStream(header);
+					std::string key;
+					while (headerStream >> key)
+					{
+						if (key == "layout:")
+							headerStream >> layout;
+						else if (key == "inputs:")
+							headerStream >> fileInputSize;
+						else if (key == "outputs:")
+							headerStream >> fileOutputSize;
+					}
+				}
+
+				if (layout != "input-major" && layout != "output-major")
+				{
+					log(tools::logger::LogLevel::ERROR, "Weight matrix read from file has an unknown layout '" + layout + "'.");
+					return;
+				}
+
+				if (fileInputSize != inputSize || fileOutputSize != outputSize)
+				{
+					log(tools::logger::LogLevel::ERROR,
+						"Weight matrix read from file has different dimensions than expected! "
+						"Expected: " + std::to_string(inputSize) + "x" + std::to_string(outputSize) +
+						", Got: " + std::to_string(fileInputSize) + "x" + std::to_string(fileOutputSize));
+					return;
+				}
+
 				std::vector<double> weights;
 				weights.reserve(expectedSize);
 				double element;
@@ -198,7 +304,18 @@ namespace dnf_composer
 					return;
 				}
 
-				components["weights"] = weights;
+				if (layout == "output-major")
+				{
+					// the forward pass streams through the rows of the inputs
+					auto& storedWeights = components[ComponentSlot::WEIGHTS];
+					for (size_t i = 0; i < outputSize; i++)
+						for (size_t j = 0; j < inputSize; j++)
+							storedWeights[j * outputSize + i] = weights[i * inputSize + j];
+				}
+				else
+					components[ComponentSlot::WEIGHTS].assign(weights.begin(), weights.end());
+
+				compressWeights();
 
 				const std::string message = "Weights '" + this->getUniqueName() + "' read successfully from: " +
 					filename + ".";
@@ -218,15 +335,17 @@ namespace dnf_composer
 
 			if (file.is_open()) 
 			{
-				const size_t inputSize = components.at("input").size();
-				const size_t outputSize = components.at("output").size();
+				const size_t inputSize = components.at(ComponentSlot::INPUT).size();
+				const size_t outputSize = components.at(ComponentSlot::OUTPUT).size();
 
+				// one row per input, holding its weight to every output
+				file << "# layout: input-major inputs: " << inputSize << " outputs: " << outputSize << '\n';
 				for (size_t i = 0; i < inputSize; i++) 
 				{
 					for (size_t j = 0; j < outputSize; j++) 
 					{
 						const size_t index = i * outputSize + j;
-						file << components.at("weights")[index] << " ";
+						file << components.at(ComponentSlot::WEIGHTS)[index] << " ";
 					}
 					file << '\n';
 				}
@@ -244,7 +363,9 @@ namespace dnf_composer
 
 		void FieldCoupling::clearWeights()
 		{
-			components["weights"] = std::vector<double>(components["weights"].size(), 0);
+			std::ranges::fill(components[ComponentSlot::WEIGHTS], 0);
+			compressWeights();
+			notifyParameterChange();
 		}
 
 		bool FieldCoupling::checkValidConnections()
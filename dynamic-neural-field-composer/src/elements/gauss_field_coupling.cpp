@@ -10,29 +10,122 @@ namespace dnf_composer
 	{
 		GaussFieldCoupling::GaussFieldCoupling(const ElementCommonParameters& elementCommonParameters, 
 			const GaussFieldCouplingParameters& gfc_parameters)
-			: Element(elementCommonParameters), parameters(gfc_parameters)
+			: Element(elementCommonParameters), parameters(gfc_parameters), usingLowRankEvaluation(false), weightsComputed(false),
+			weightThreshold(tools::math::SparseWeights::defaultThreshold)
 		{
 			commonParameters.identifiers.label = ElementLabel::GAUSS_FIELD_COUPLING;
-			components["input"] = std::vector<double>(parameters.inputFieldDimensions.size);
-			components["output"] = std::vector<double>(commonParameters.dimensionParameters.size);
-			components["weights"] = std::vector<double>(components.at("input").size() * components.at("output").size());
+			components[ComponentSlot::INPUT] = Component(parameters.inputFieldDimensions.size);
+			components[ComponentSlot::OUTPUT] = Component(commonParameters.dimensionParameters.size);
+			// sized when the weights are computed
+			components[ComponentSlot::WEIGHTS] = Component();
 		}
 
 		void GaussFieldCoupling::init()
 		{
 			updateInputFieldDimensions();
 
-			std::ranges::fill(components["input"], 0);
-			std::ranges::fill(components["output"], 0);
-			std::ranges::fill(components["weights"], 0);
+			std::ranges::fill(components[ComponentSlot::INPUT], 0);
+			std::ranges::fill(components[ComponentSlot::OUTPUT], 0);
 
-			const unsigned int cols = static_cast<int>(components["output"].size());
-			const unsigned int rows = static_cast<int>(components["input"].size());
+			const size_t cols = components[ComponentSlot::OUTPUT].size();
+			const size_t rows = components[ComponentSlot::INPUT].size();
+			usingLowRankEvaluation = parameters.couplings.size() * (rows + cols) < rows * cols;
+
+			weightsComputed = false;
+			if (usingLowRankEvaluation)
+			{
+				components[ComponentSlot::WEIGHTS].clear();
+				components[ComponentSlot::WEIGHTS].shrink_to_fit();
+				computeProfiles();
+			}
+			else
+			{
+				inputProfiles.clear();
+				outputProfiles.clear();
+				projectedInputs.clear();
+				computeWeights();
+				sparseWeights.compress(components[ComponentSlot::WEIGHTS], rows, cols, weightThreshold);
+			}
+		}
+
+		void GaussFieldCoupling::step(double t, double deltaT)
+		{
+			updateOutput();
+		}
+
+		std::string GaussFieldCoupling::toString() const
+		{
+			std::string result = "Gauss field coupling element\n";
+			result += commonParameters.toString() + '\n';
+			result += parameters.toString();
+			return result;
+		}
+
+		std::shared_ptr<Element> GaussFieldCoupling::clone() const
+		{
+			auto cloned = std::make_shared<GaussFieldCoupling>(*this);
+			return cloned;
+		}
+
+		void GaussFieldCoupling::prepareComponent(const std::string& componentName)
+		{
+			// the matrix is built when it is read, outside the step, and published at once,
+			// since the step only publishes constant components after a parameter change
+			if (componentName == "weights" && !weightsComputed)
+			{
+				computeWeights();
+				if (doubleBuffered)
+					publishedComponents[ComponentSlot::WEIGHTS] = components[ComponentSlot::WEIGHTS];
+			}
+			Element::prepareComponent(componentName);
+		}
+
+		void GaussFieldCoupling::computeProfiles()
+		{
+			const size_t cols = components[ComponentSlot::OUTPUT].size();
+			const size_t rows = components[ComponentSlot::INPUT].size();
+			const size_t numberOfCouplings = parameters.couplings.size();
+
+			inputProfiles.resize(numberOfCouplings * rows);
+			outputProfiles.resize(numberOfCouplings * cols);
+			projectedInputs.resize(numberOfCouplings);
+
+			const auto profile = [this](double x, double mu, double width, double size)
+			{
+				double distance = std::abs(x - mu);
+				if (parameters.circular)
+					distance = std::min(distance, size - distance);
+				return std::exp(-(distance * distance) / (2 * width * width));
+			};
+
+			for (size_t c = 0; c < numberOfCouplings; c++)
+			{
+				const auto& coupling = parameters.couplings[c];
+				double amplitude = coupling.amplitude;
+				if (parameters.normalized)
+					amplitude /= sqrt(2 * std::numbers::pi * std::pow(coupling.width, 2));
+
+				const double inputCenter = coupling.x_i / parameters.inputFieldDimensions.d_x;
+				const double outputCenter = coupling.x_j / commonParameters.dimensionParameters.d_x;
+				for (size_t j = 0; j < rows; j++)
+					inputProfiles[c * rows + j] = profile(static_cast<double>(j), inputCenter, coupling.width, static_cast<double>(rows));
+				// the amplitude is folded into the output side
+				for (size_t i = 0; i < cols; i++)
+					outputProfiles[c * cols + i] = amplitude * profile(static_cast<double>(i), outputCenter, coupling.width, static_cast<double>(cols));
+			}
+		}
+
+		void GaussFieldCoupling::computeWeights()
+		{
+			const unsigned int cols = static_cast<int>(components[ComponentSlot::OUTPUT].size());
+			const unsigned int rows = static_cast<int>(components[ComponentSlot::INPUT].size());
+
+			auto& weights = components[ComponentSlot::WEIGHTS];
+			weights.resize(static_cast<size_t>(rows) * cols);
+			std::ranges::fill(weights, 0);
 
 			for (unsigned int i = 0; i < cols; i++)
 			{
-				std::vector<double> col;
-				col.reserve(rows);
 				for (unsigned int j = 0; j < rows; j++)
 				{
 					double value = 0.0;
@@ -52,42 +145,45 @@ namespace dnf_composer
 								coupling.width, coupling.width, amplitude);
 					}
 					const size_t index = j * cols + i;
-					components["weights"][index] = value;
+					weights[index] = value;
 				}
 			}
+			weightsComputed = true;
 		}
 
-		void GaussFieldCoupling::step(double t, double deltaT)
+		void GaussFieldCoupling::updateOutput()
 		{
-			updateInput();
-			updateOutput();
-		}
+			auto& output = components[ComponentSlot::OUTPUT];
+			const std::span<const double> input = gatherInput(components[ComponentSlot::INPUT].size());
 
-		std::string GaussFieldCoupling::toString() const
-		{
-			std::string result = "Gauss field coupling element\n";
-			result += commonParameters.toString() + '\n';
-			result += parameters.toString();
-			return result;
-		}
-
-		std::shared_ptr<Element> GaussFieldCoupling::clone() const
-		{
-			auto cloned = std::make_shared<GaussFieldCoupling>(*this);
-			return cloned;
-		}
+			if (!usingLowRankEvaluation)
+			{
+				if (sparseWeights.getStorage() != tools::math::WeightStorage::DENSE)
+					sparseWeights.multiply(input, output);
+				else
+					tools::math::matrixVectorMultiply(components[ComponentSlot::WEIGHTS], input, output, 1.0, threadPool);
+				return;
+			}
 
-		void GaussFieldCoupling::updateOutput()
-		{
-			components["output"] = std::vector<double>(components["output"].size(), 0);
+			// output = sum over the couplings of amplitude * gOut * <gIn, input>, O(rows + cols) per coupling
+			const size_t cols = output.size();
+			const size_t rows = input.size();
+			for (size_t c = 0; c < projectedInputs.size(); c++)
+			{
+				const double* const inputProfile = inputProfiles.data() + c * rows;
+				double projection = 0.0;
+				for (size_t j = 0; j < rows; j++)
+					projection += inputProfile[j] * input[j];
+				projectedInputs[c] = projection;
+			}
 
-			for (size_t i = 0; i < components["output"].size(); i++)
+			std::ranges::fill(output, 0);
+			for (size_t c = 0; c < projectedInputs.size(); c++)
 			{
-				for (size_t j = 0; j < components["input"].size(); j++)
-				{
-					const size_t index = j * components["output"].size() + i;
-					components["output"][i] += components["weights"][index] * components["input"][j];
-				}
+				const double* const outputProfile = outputProfiles.data() + c * cols;
+				const double projection = projectedInputs[c];
+				for (size_t i = 0; i < cols; i++)
+					output[i] += projection * outputProfile[i];
 			}
 		}
 
@@ -105,6 +201,7 @@ namespace dnf_composer
 		{
 			parameters = gfc_parameters;
 			init();
+			notifyParameterChange();
 		}
 
 		ElementDimensions GaussFieldCoupling::getInputFieldDimensions() const
@@ -112,6 +209,25 @@ namespace dnf_composer
 			return parameters.inputFieldDimensions;
 		}
 
+		bool GaussFieldCoupling::isUsingLowRankEvaluation() const
+		{
+			return usingLowRankEvaluation;
+		}
+
+		void GaussFieldCoupling::setWeightThreshold(double threshold)
+		{
+			weightThreshold = threshold;
+			if (!usingLowRankEvaluation && weightsComputed)
+				sparseWeights.compress(components[ComponentSlot::WEIGHTS], components[ComponentSlot::INPUT].size(),
+					components[ComponentSlot::OUTPUT].size(), weightThreshold);
+			notifyParameterChange();
+		}
+
+		double GaussFieldCoupling::getWeightThreshold() const
+		{
+			return weightThreshold;
+		}
+
 		void GaussFieldCoupling::updateInputFieldDimensions()
 		{
 			if (inputs.size() != 1)
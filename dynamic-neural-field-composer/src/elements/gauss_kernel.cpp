@@ -13,7 +13,7 @@ namespace dnf_composer
 			: Kernel(elementCommonParameters), parameters(std::move(gk_parameters))
 		{
 			commonParameters.identifiers.label = ElementLabel::GAUSS_KERNEL;
-			components["kernel"] = std::vector<double>(commonParameters.dimensionParameters.size);
+			components[ComponentSlot::KERNEL] = Component(commonParameters.dimensionParameters.size);
 		}
 
 		void GaussKernel::init()
@@ -23,12 +23,12 @@ namespace dnf_composer
 			if (parameters.circular)
 			{
 				extIndex = tools::math::createExtendedIndex(commonParameters.dimensionParameters.size, kernelRange);
-				components["input"].resize(extIndex.size()); 
+				components[ComponentSlot::INPUT].resize(extIndex.size()); 
 			}
 			else
 			{
 				extIndex = {};
-				components["input"].resize(commonParameters.dimensionParameters.size);
+				components[ComponentSlot::INPUT].resize(commonParameters.dimensionParameters.size);
 			}
 
 			int rangeXsize = kernelRange[0] + kernelRange[1] + 1;
@@ -42,32 +42,21 @@ namespace dnf_composer
 			else
 				gauss = tools::math::gauss(rangeX, 0.0, parameters.width);
 
-			components["kernel"].resize(rangeX.size());
-			for (int i = 0; i < components["kernel"].size(); i++)
-				components["kernel"][i] = parameters.amplitude * gauss[i];
+			components[ComponentSlot::KERNEL].resize(rangeX.size());
+			for (size_t i = 0; i < components[ComponentSlot::KERNEL].size(); i++)
+				components[ComponentSlot::KERNEL][i] = parameters.amplitude * gauss[i];
 			 
 			fullSum = 0.0;
-			std::ranges::fill(components["input"], 0.0);
-			std::ranges::fill(components["output"], 0.0);
+			std::ranges::fill(components[ComponentSlot::INPUT], 0.0);
+			std::ranges::fill(components[ComponentSlot::OUTPUT], 0.0);
+			prepareConvolution(parameters.circular);
+			prepareRecursiveConvolution({ { parameters.width, parameters.amplitude * std::accumulate(gauss.begin(), gauss.end(), 0.0) } },
+				parameters.circular);
 		}
 
 		void GaussKernel::step(double t, double deltaT)
 		{
-			updateInput();
-
-			fullSum = std::accumulate(components["input"].begin(), components["input"].end(),
-				(double)0.0);
-
-			std::vector<double> convolution(commonParameters.dimensionParameters.size);
-			const std::vector<double> subDataInput = tools::math::obtainCircularVector(extIndex, components["input"]);
-
-			if (parameters.circular)
-				convolution = tools::math::conv_valid(subDataInput, components["kernel"]);
-			else
-				convolution = tools::math::conv_same(components["input"], components["kernel"]);
-
-			for (int i = 0; i < components["output"].size(); i++)
-				components["output"][i] = convolution[i] + parameters.amplitudeGlobal * fullSum;
+			convolveInput(parameters.circular, parameters.amplitudeGlobal);
 		}
 
 		std::string GaussKernel::toString() const
@@ -88,6 +77,7 @@ namespace dnf_composer
 		{
 			parameters = gk_parameters;
 			init();
+			notifyParameterChange();
 		}
 
 		GaussKernelParameters GaussKernel::getParameters() const
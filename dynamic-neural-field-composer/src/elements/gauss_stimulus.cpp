@@ -33,13 +33,13 @@ namespace dnf_composer
 
 			if (!parameters.normalized)
 				for (int i = 0; i < commonParameters.dimensionParameters.size; i++)
-					components["output"][i] = parameters.amplitude * g[i];
+					components[ComponentSlot::OUTPUT][i] = parameters.amplitude * g[i];
 			else
 			{
 				const double sum = tools::math::calculateVectorSum(g);
 				if(sum != 0.0)
 					for (int i = 0; i < commonParameters.dimensionParameters.size; i++)
-						components["output"][i] = parameters.amplitude * g[i] / sum;
+						components[ComponentSlot::OUTPUT][i] = parameters.amplitude * g[i] / sum;
 				else
 				{
 					const std::string message = "Tried to initialize a normalized Gaussian stimulus '"
@@ -49,10 +49,10 @@ namespace dnf_composer
 				}
 			}
 
-			components["input"] = std::vector<double>(commonParameters.dimensionParameters.size);
-			updateInput();
+			components[ComponentSlot::INPUT] = Component(commonParameters.dimensionParameters.size);
+			updateInputFromConnections();
 			for (int i = 0; i < commonParameters.dimensionParameters.size; i++)
-				components["output"][i] += components["input"][i];
+				components[ComponentSlot::OUTPUT][i] += components[ComponentSlot::INPUT][i];
 		}
 
 		void GaussStimulus::step(double t, double deltaT)
@@ -77,6 +77,7 @@ namespace dnf_composer
 		{
 			parameters = gaussStimulusParameters;
 			init();
+			notifyParameterChange();
 		}
 
 		GaussStimulusParameters GaussStimulus::getParameters() const
@@ -16,7 +16,14 @@ namespace dnf_composer
 			extIndex = {};
 			fullSum = 0.0;
 			cutOfFactor = 5;
-			components["kernel"] = std::vector<double>(commonParameters.dimensionParameters.size);
+			usingFftConvolution = false;
+			convolutionMode = ConvolutionMode::AUTOMATIC;
+			maximumRecursiveError = defaultMaximumRecursiveError;
+			circularConvolution = false;
+			unmergedKernelRange = { 0, 0 };
+			mergedAmplitudeGlobal = 0.0;
+			mergedAway = false;
+			components[ComponentSlot::KERNEL] = Component(commonParameters.dimensionParameters.size);
 		}
 
 		std::array<int, 2> Kernel::getKernelRange() const
@@ -28,5 +35,297 @@ namespace dnf_composer
 		{
 			return extIndex;
 		}
+
+		bool Kernel::isUsingFftConvolution() const
+		{
+			return usingFftConvolution;
+		}
+
+		bool Kernel::isUsingRecursiveConvolution() const
+		{
+			return !recursiveGaussians.empty();
+		}
+
+		void Kernel::setConvolutionMode(ConvolutionMode mode)
+		{
+			if (mode == ConvolutionMode::RECURSIVE && !supportsRecursiveConvolution())
+			{
+				log(tools::logger::LogLevel::WARNING, "Kernel '" + commonParameters.identifiers.uniqueName +
+					"' is not made of Gaussians and cannot be convolved recursively.");
+				return;
+			}
+			convolutionMode = mode;
+		}
+
+		ConvolutionMode Kernel::getConvolutionMode() const
+		{
+			return convolutionMode;
+		}
+
+		void Kernel::setMaximumRecursiveError(double error)
+		{
+			maximumRecursiveError = error;
+		}
+
+		double Kernel::getMaximumRecursiveError() const
+		{
+			return maximumRecursiveError;
+		}
+
+		bool Kernel::isMerged() const
+		{
+			return !unmergedKernel.empty();
+		}
+
+		bool Kernel::isMergedAway() const
+		{
+			return mergedAway;
+		}
+
+		bool Kernel::mergeKernel(Kernel& other)
+		{
+			if (&other == this || mergedAway || other.mergedAway || other.isMerged())
+				return false;
+			if (!recursiveGaussians.empty() || !other.recursiveGaussians.empty())
+				return false;
+			if (circularConvolution != other.circularConvolution ||
+				components[ComponentSlot::OUTPUT].size() != other.components[ComponentSlot::OUTPUT].size())
+				return false;
+			// a kernel that does not wrap around is centred on its middle sample, so it must be symmetric
+			if (!circularConvolution && (kernelRange[0] != kernelRange[1] || other.kernelRange[0] != other.kernelRange[1]))
+				return false;
+
+			auto& kernel = components[ComponentSlot::KERNEL];
+			if (!isMerged())
+			{
+				unmergedKernel.assign(kernel.begin(), kernel.end());
+				unmergedKernelRange = kernelRange;
+			}
+
+			// both kernels are aligned on their centre, sample kernelRange[0]
+			const std::array<int, 2> mergedRange = { std::max(kernelRange[0], other.kernelRange[0]),
+				std::max(kernelRange[1], other.kernelRange[1]) };
+			std::vector<double> merged(mergedRange[0] + mergedRange[1] + 1, 0.0);
+			for (size_t i = 0; i < kernel.size(); i++)
+				merged[i + mergedRange[0] - kernelRange[0]] += kernel[i];
+			const auto& otherKernel = other.components[ComponentSlot::KERNEL];
+			for (size_t i = 0; i < otherKernel.size(); i++)
+				merged[i + mergedRange[0] - other.kernelRange[0]] += otherKernel[i];
+
+			kernelRange = mergedRange;
+			kernel.assign(merged.begin(), merged.end());
+			if (circularConvolution)
+				extIndex = tools::math::createExtendedIndex(commonParameters.dimensionParameters.size, kernelRange);
+			planConvolution();
+			mergedAmplitudeGlobal += other.getAmplitudeGlobal();
+
+			other.mergedAway = true;
+			std::ranges::fill(other.components[ComponentSlot::OUTPUT], 0.0);
+			if (other.doubleBuffered)
+				std::ranges::fill(other.publishedComponents[ComponentSlot::OUTPUT], 0.0);
+			return true;
+		}
+
+		void Kernel::separateKernels()
+		{
+			mergedAway = false;
+			if (!isMerged())
+				return;
+
+			kernelRange = unmergedKernelRange;
+			components[ComponentSlot::KERNEL].assign(unmergedKernel.begin(), unmergedKernel.end());
+			if (circularConvolution)
+				extIndex = tools::math::createExtendedIndex(commonParameters.dimensionParameters.size, kernelRange);
+			unmergedKernel.clear();
+			mergedAmplitudeGlobal = 0.0;
+			planConvolution();
+		}
+
+		void Kernel::prepareConvolution(bool circular)
+		{
+			// a new kernel replaces any merged one
+			circularConvolution = circular;
+			unmergedKernel.clear();
+			mergedAmplitudeGlobal = 0.0;
+			mergedAway = false;
+			recursiveGaussians.clear();
+			planConvolution();
+		}
+
+		void Kernel::planConvolution()
+		{
+			const auto& kernel = components[ComponentSlot::KERNEL];
+			const size_t outputSize = components[ComponentSlot::OUTPUT].size();
+			const bool circular = circularConvolution;
+
+			circularInput.resize(extIndex.size());
+			switch (convolutionMode)
+			{
+			// a kernel that is not convolved recursively after all falls back to the faster of the other two
+			case ConvolutionMode::AUTOMATIC:
+			case ConvolutionMode::RECURSIVE:
+				usingFftConvolution = tools::math::FftConvolution::isWorthwhile(outputSize, kernel.size());
+				break;
+			case ConvolutionMode::FFT:
+				usingFftConvolution = true;
+				break;
+			case ConvolutionMode::DIRECT:
+				usingFftConvolution = false;
+				break;
+			}
+			if (!usingFftConvolution)
+				return;
+
+			if (circular)
+				fftConvolution.planValid(circularInput.size(), kernel);
+			else
+				fftConvolution.planSame(components[ComponentSlot::INPUT].size(), kernel);
+		}
+
+		void Kernel::prepareRecursiveConvolution(std::initializer_list<std::pair<double, double>> gaussians, bool circular)
+		{
+			if (convolutionMode != ConvolutionMode::RECURSIVE)
+				return;
+
+			for (const auto& [width, sum] : gaussians)
+			{
+				if (sum != 0.0 && width < tools::math::RecursiveGaussian::minimumWidth)
+				{
+					log(tools::logger::LogLevel::WARNING, "Kernel '" + commonParameters.identifiers.uniqueName +
+						"' is too narrow to be convolved recursively, the direct convolution is used.");
+					return;
+				}
+			}
+
+			// the signal is padded by the same range the direct convolution would cover
+			const size_t size = commonParameters.dimensionParameters.size;
+			size_t numberOfGaussians = 0;
+			size_t largestPadding = 0;
+			for (const auto& [width, sum] : gaussians)
+			{
+				if (sum == 0.0)
+					continue;
+				numberOfGaussians++;
+				largestPadding = std::max(largestPadding, static_cast<size_t>(std::ceil(width * cutOfFactor)));
+			}
+			if (!tools::math::RecursiveGaussian::isWorthwhile(size, components[ComponentSlot::KERNEL].size(),
+				numberOfGaussians, largestPadding))
+			{
+				log(tools::logger::LogLevel::INFO, "Kernel '" + commonParameters.identifiers.uniqueName +
+					"' is narrow enough for the direct convolution to be faster than the recursive one, which is not used.");
+				return;
+			}
+
+			for (const auto& [width, sum] : gaussians)
+			{
+				if (sum == 0.0)
+					continue;
+				const auto padding = static_cast<size_t>(std::ceil(width * cutOfFactor));
+				recursiveGaussians.emplace_back().plan(width, sum, size, padding, circular);
+			}
+
+			const double error = estimateRecursiveError();
+			if (error > maximumRecursiveError)
+			{
+				recursiveGaussians.clear();
+				log(tools::logger::LogLevel::WARNING, "Kernel '" + commonParameters.identifiers.uniqueName +
+					"' would be convolved recursively with an error of up to " + std::to_string(error * 100.0) +
+					"% of its magnitude, the direct or FFT convolution is used.");
+				return;
+			}
+			usingFftConvolution = false;
+		}
+
+		double Kernel::estimateRecursiveError()
+		{
+			// the error for any input is at most the largest difference between the responses of both paths
+			// to an impulse, over the positions of the impulse, an impulse at either end of the field covers
+			// every distance to the other samples on one side each
+			const auto& kernel = components[ComponentSlot::KERNEL];
+			const size_t size = commonParameters.dimensionParameters.size;
+			std::vector<double> impulse(size, 0.0);
+			std::vector<double> direct(size);
+			std::vector<double> recursive(size);
+			double error = 0.0;
+			for (const size_t position : { size_t{ 0 }, size - 1 })
+			{
+				std::ranges::fill(impulse, 0.0);
+				impulse[position] = 1.0;
+				if (circularConvolution)
+				{
+					tools::math::obtainCircularVector(extIndex, impulse, circularInput);
+					tools::math::conv_valid(circularInput, kernel, direct);
+				}
+				else
+					tools::math::conv_same(impulse, kernel, direct);
+				for (size_t i = 0; i < recursiveGaussians.size(); i++)
+					recursiveGaussians[i].filter(impulse, recursive, i > 0);
+				for (size_t i = 0; i < size; i++)
+					error += std::abs(direct[i] - recursive[i]);
+				// around a circle every position is alike
+				if (circularConvolution)
+					break;
+			}
+
+			double magnitude = 0.0;
+			for (const double value : kernel)
+				magnitude += std::abs(value);
+			return magnitude > 0.0 ? error / magnitude : 0.0;
+		}
+
+		void Kernel::convolveInput(bool circular, double amplitudeGlobal)
+		{
+			const auto& kernel = components[ComponentSlot::KERNEL];
+			auto& output = components[ComponentSlot::OUTPUT];
+
+			// the kernel this one was merged into computes its output
+			if (mergedAway)
+			{
+				std::ranges::fill(output, 0.0);
+				return;
+			}
+
+			const std::span<const double> input = gatherConvolutionInput();
+			if (!recursiveGaussians.empty())
+			{
+				const std::span<const double> field(input.data(), std::min(input.size(), output.size()));
+				for (size_t i = 0; i < recursiveGaussians.size(); i++)
+					recursiveGaussians[i].filter(field, output, i > 0);
+			}
+			else if (circular)
+			{
+				tools::math::obtainCircularVector(extIndex, input, circularInput);
+				if (usingFftConvolution)
+					fftConvolution.convolve(circularInput, output);
+				else
+					tools::math::conv_valid(circularInput, kernel, output);
+			}
+			else if (usingFftConvolution)
+				fftConvolution.convolve(input, output);
+			else
+				tools::math::conv_same(input, kernel, output);
+
+			addGlobalTerm(amplitudeGlobal);
+		}
+
+		bool Kernel::isConvolvedDirectlyAroundCircle() const
+		{
+			return circularConvolution && !usingFftConvolution && recursiveGaussians.empty() && !mergedAway;
+		}
+
+		std::span<const double> Kernel::gatherConvolutionInput()
+		{
+			// a field read in place, the input component is only written when several inputs are summed
+			const std::span<const double> input = gatherInput(commonParameters.dimensionParameters.size);
+			fullSum = std::accumulate(input.begin(), input.end(), (double)0.0);
+			return input;
+		}
+
+		void Kernel::addGlobalTerm(double amplitudeGlobal)
+		{
+			const double amplitude = amplitudeGlobal + mergedAmplitudeGlobal;
+			for (double& value : components[ComponentSlot::OUTPUT])
+				value += amplitude * fullSum;
+		}
 	}
 }
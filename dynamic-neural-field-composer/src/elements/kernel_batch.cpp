@@ -0,0 +1,91 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "elements/kernel_batch.h"
+
+#include <algorithm>
+
+#include "elements/kernel.h"
+#include "tools/simd.h"
+
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		void KernelBatch::reserve(size_t numberOfKernels)
+		{
+			kernels.reserve(numberOfKernels);
+			deltaTs.reserve(numberOfKernels);
+			columnKernels.reserve(numberOfKernels);
+		}
+
+		void KernelBatch::clear()
+		{
+			kernels.clear();
+			deltaTs.clear();
+		}
+
+		void KernelBatch::add(Kernel* kernel, double deltaT)
+		{
+			kernels.push_back(kernel);
+			deltaTs.push_back(deltaT);
+		}
+
+		void KernelBatch::step(double t)
+		{
+			columnKernels.clear();
+			for (size_t i = 0; i < kernels.size(); i++)
+			{
+				Kernel* kernel = kernels[i];
+				if (!kernel->isConvolvedDirectlyAroundCircle() ||
+					kernel->extIndex.size() + 1 != kernel->components[ComponentSlot::KERNEL].size() + kernel->components[ComponentSlot::OUTPUT].size())
+				{
+					kernel->step(t, deltaTs[i]);
+					continue;
+				}
+				columnKernels.push_back(kernel);
+			}
+
+			for (size_t first = 0; first < columnKernels.size();)
+			{
+				const size_t inputSize = columnKernels[first]->extIndex.size();
+				const size_t kernelSize = columnKernels[first]->components[ComponentSlot::KERNEL].size();
+				size_t last = first + 1;
+				while (last < columnKernels.size() && last - first < blockColumns && columnKernels[last]->extIndex.size() == inputSize &&
+					columnKernels[last]->components[ComponentSlot::KERNEL].size() == kernelSize)
+					last++;
+
+				// the buffers only grow, so the steps after the first do not allocate
+				const size_t columns = last - first;
+				const size_t outputSize = inputSize - kernelSize + 1;
+				inputs.resize(std::max(inputs.size(), inputSize * columns));
+				weights.resize(std::max(weights.size(), kernelSize * columns));
+				outputs.resize(std::max(outputs.size(), outputSize * columns));
+				for (size_t c = 0; c < columns; c++)
+				{
+					Kernel& kernel = *columnKernels[first + c];
+					const std::span<const double> input = kernel.gatherConvolutionInput();
+					for (size_t i = 0; i < inputSize; i++)
+						inputs[i * columns + c] = input[kernel.extIndex[i] - 1];
+					const Component& kernelValues = kernel.components[ComponentSlot::KERNEL];
+					for (size_t j = 0; j < kernelSize; j++)
+						weights[j * columns + c] = kernelValues[j];
+				}
+
+				tools::simd::convolveInterleavedRows(inputs.data(), weights.data(), outputs.data(), columns, kernelSize, outputSize);
+
+				for (size_t c = 0; c < columns; c++)
+				{
+					Kernel& kernel = *columnKernels[first + c];
+					Component& output = kernel.components[ComponentSlot::OUTPUT];
+					for (size_t i = 0; i < outputSize; i++)
+						output[i] = outputs[i * columns + c];
+					kernel.addGlobalTerm(kernel.getAmplitudeGlobal());
+				}
+				first = last;
+			}
+		}
+	}
+}
@@ -45,34 +45,24 @@ namespace dnf_composer
 				gaussInh = tools::math::gauss(rangeX, 0.0, parameters.widthInh);
 			}
 
-			components["kernel"].resize(rangeX.size());
-			for (int i = 0; i < components["kernel"].size(); i++)
-				components["kernel"][i] = parameters.amplitudeExc * gaussExc[i] -
+			components[ComponentSlot::KERNEL].resize(rangeX.size());
+			for (size_t i = 0; i < components[ComponentSlot::KERNEL].size(); i++)
+				components[ComponentSlot::KERNEL][i] = parameters.amplitudeExc * gaussExc[i] -
 				parameters.amplitudeInh * gaussInh[i];
 
 			fullSum = 0.0;
-			std::ranges::fill(components["input"], 0.0);
-			std::ranges::fill(components["output"], 0.0);  
+			std::ranges::fill(components[ComponentSlot::INPUT], 0.0);
+			std::ranges::fill(components[ComponentSlot::OUTPUT], 0.0);  
+			prepareConvolution(parameters.circular);
+			prepareRecursiveConvolution({
+					{ parameters.widthExc, parameters.amplitudeExc * std::accumulate(gaussExc.begin(), gaussExc.end(), 0.0) },
+					{ parameters.widthInh, -parameters.amplitudeInh * std::accumulate(gaussInh.begin(), gaussInh.end(), 0.0) }
+				}, parameters.circular);
 		}
 
 		void MexicanHatKernel::step(double t, double deltaT)
 		{
-			updateInput();
-
-			fullSum = std::accumulate(components["input"].begin(), components["input"].end(),
-				(double)0.0);
-
-			std::vector<double> convolution(commonParameters.dimensionParameters.size);
-			const std::vector<double> subDataInput = tools::math::obtainCircularVector(extIndex,
-				components["input"]);
-
-			if (parameters.circular)
-				convolution = tools::math::conv_valid(subDataInput, components["kernel"]);
-			else
-				convolution = tools::math::conv_same(components["input"], components["kernel"]);
-
-			for (int i = 0; i < components["output"].size(); i++)
-				components["output"][i] = convolution[i] + parameters.amplitudeGlobal * fullSum;
+			convolveInput(parameters.circular, parameters.amplitudeGlobal);
 		}
 
 		std::string MexicanHatKernel::toString() const
@@ -93,6 +83,7 @@ namespace dnf_composer
 		{
 			parameters = mhk_parameters;
 			init();
+			notifyParameterChange();
 		}
 
 		MexicanHatKernelParameters MexicanHatKernel::getParameters() const
@@ -4,6 +4,8 @@
 
 #include "elements/neural_field.h"
 
+#include <limits>
+
 
 namespace dnf_composer
 {
@@ -24,24 +26,110 @@ namespace dnf_composer
 
 		NeuralField::NeuralField(const ElementCommonParameters& elementCommonParameters, 
 			const NeuralFieldParameters& parameters)
-			: Element(elementCommonParameters), parameters(parameters)
+			: Element(elementCommonParameters), parameters(parameters), fusedStep(nullptr), fusedActivation(nullptr),
+			integrationGain(0.0), integrationGainDeltaT(-1.0)
 		{
 			commonParameters.identifiers.label = ElementLabel::NEURAL_FIELD;
-			components["activation"] = std::vector<double>(commonParameters.dimensionParameters.size);
-			components["resting level"] = std::vector<double>(commonParameters.dimensionParameters.size);
+			components[ComponentSlot::ACTIVATION] = Component(commonParameters.dimensionParameters.size);
+			components[ComponentSlot::RESTING_LEVEL] = Component(commonParameters.dimensionParameters.size);
 		}
 
 		void NeuralField::init()
 		{
-			std::ranges::fill(components["activation"], parameters.startingRestingLevel);
-			std::ranges::fill(components["input"], 0.0);
-			std::ranges::fill(components["output"], 0.0);
-			std::ranges::fill(components["resting level"], parameters.startingRestingLevel);
+			std::ranges::fill(components[ComponentSlot::ACTIVATION], parameters.startingRestingLevel);
+			std::ranges::fill(components[ComponentSlot::INPUT], 0.0);
+			std::ranges::fill(components[ComponentSlot::OUTPUT], 0.0);
+			std::ranges::fill(components[ComponentSlot::RESTING_LEVEL], parameters.startingRestingLevel);
+			// a field of size n holds at most n/2 + 1 separate bumps
+			state.bumps.reserve(commonParameters.dimensionParameters.size / 2 + 1);
+			previousBumps.reserve(commonParameters.dimensionParameters.size / 2 + 1);
+			inputSources.reserve(inputs.size());
+			integrationGainDeltaT = -1.0;
+			if (getIntegrationStages() > 1)
+			{
+				stageStartActivation.assign(commonParameters.dimensionParameters.size, 0.0);
+				stageIncrementSum.assign(commonParameters.dimensionParameters.size, 0.0);
+			}
+			else
+			{
+				stageStartActivation.clear();
+				stageIncrementSum.clear();
+			}
 			calculateOutput();
+
+			// the activation function is resolved once here, so the fused step can inline it,
+			// both functions are final, so the cast cannot match a class that overrides them
+			if (dynamic_cast<const SigmoidFunction*>(parameters.activationFunction.get()))
+			{
+				fusedStep = &NeuralField::stepFused<SigmoidFunction>;
+				fusedActivation = &NeuralField::evaluateFusedActivation<SigmoidFunction>;
+			}
+			else if (dynamic_cast<const HeavisideFunction*>(parameters.activationFunction.get()))
+			{
+				fusedStep = &NeuralField::stepFused<HeavisideFunction>;
+				fusedActivation = &NeuralField::evaluateFusedActivation<HeavisideFunction>;
+			}
+			else
+			{
+				fusedStep = nullptr;
+				fusedActivation = nullptr;
+			}
+		}
+
+		std::vector<std::string> NeuralField::foldStaticInputs()
+		{
+			unfoldStaticInputs();
+			// only the fused step reads the folded input
+			std::vector<std::string> folded;
+			if (!fusedStep)
+				return folded;
+
+			const size_t size = components[ComponentSlot::INPUT].size();
+			for (const auto& [inputElement, inputComponent] : getOrderedInputs())
+			{
+				if (!inputElement->isStatic() || inputElement->getComponents()->at(inputComponent).size() != size)
+					continue;
+				foldedInputElements.push_back(inputElement.get());
+				folded.push_back(inputElement->getUniqueName());
+			}
+			if (folded.empty())
+				return folded;
+
+			foldedInput.assign(size, 0.0);
+			for (const auto& [inputElement, inputComponent] : getOrderedInputs())
+			{
+				if (std::ranges::find(foldedInputElements, inputElement.get()) == foldedInputElements.end())
+					continue;
+				const Component& source = inputElement->getComponents()->at(inputComponent);
+				for (size_t i = 0; i < size; i++)
+					foldedInput[i] += source[i];
+			}
+			return folded;
+		}
+
+		void NeuralField::unfoldStaticInputs()
+		{
+			foldedInput.clear();
+			foldedInputElements.clear();
 		}
 
 		void NeuralField::step(double t, double deltaT)
 		{
+			if (getIntegrationStages() > 1 || stepRecord.stage > 0)
+			{
+				// a single-stage integrator took the whole step in the first stage
+				if (stepRecord.stage < getIntegrationStages())
+					stepStage(deltaT);
+				return;
+			}
+
+			if (fusedStep)
+			{
+				(this->*fusedStep)(deltaT);
+				updateBumps(deltaT);
+				return;
+			}
+
 			updateInput();
 			calculateActivation(t, deltaT);
 			calculateOutput();
@@ -52,6 +140,7 @@ namespace dnf_composer
 		{
 			parameters = neuralFieldParameters;
 			init();
+			notifyParameterChange();
 		}
 
 		NeuralFieldParameters NeuralField::getParameters() const
@@ -73,7 +162,7 @@ namespace dnf_composer
 
 		std::shared_ptr<Kernel> NeuralField::getSelfExcitationKernel() const
 		{
-			for (const auto& input : inputs)
+			for (const auto& input : getOrderedInputs())
 			{
 				if (input.first->getLabel() == ElementLabel::GAUSS_KERNEL ||
 					input.first->getLabel() == ElementLabel::MEXICAN_HAT_KERNEL)
@@ -106,21 +195,95 @@ namespace dnf_composer
 
 		void NeuralField::calculateActivation(double t, double deltaT)
 		{
+			auto& activation = components[ComponentSlot::ACTIVATION];
+			const auto& restingLevel = components[ComponentSlot::RESTING_LEVEL];
+			const auto& input = components[ComponentSlot::INPUT];
+
+			const double gain = getIntegrationGain(deltaT);
 			for (int i = 0; i < commonParameters.dimensionParameters.size; i++)
 			{
-				components["activation"][i] = components["activation"][i] + deltaT / parameters.tau *
-					(-components["activation"][i] + components["resting level"][i] + components["input"][i]);
+				activation[i] = activation[i] + gain *
+					(-activation[i] + restingLevel[i] + input[i]);
+			}
+		}
+
+		double NeuralField::getIntegrationGain(double deltaT)
+		{
+			if (deltaT == integrationGainDeltaT)
+				return integrationGain;
+
+			const double a = deltaT / parameters.tau;
+			switch (parameters.integrator)
+			{
+			case Integrator::EXPONENTIAL_EULER:
+				integrationGain = -std::expm1(-a);
+				break;
+			default:
+				integrationGain = a;
+				break;
 			}
+			integrationGainDeltaT = deltaT;
+			return integrationGain;
+		}
+
+		int NeuralField::getIntegrationStages() const
+		{
+			switch (parameters.integrator)
+			{
+			case Integrator::HEUN:
+				return 2;
+			case Integrator::RK4:
+				return 4;
+			default:
+				return 1;
+			}
+		}
+
+		void NeuralField::stepStage(double deltaT)
+		{
+			// the weight of the increment of every stage in the step, and the fraction of that increment the state
+			// of the next stage is taken at, from the start of the step
+			struct Stage
+			{
+				double weight;
+				double nextStateFraction;
+			};
+			static constexpr Stage heunStages[] = { { 0.5, 1.0 }, { 0.5, 0.0 } };
+			static constexpr Stage rk4Stages[] = { { 1.0 / 6, 0.5 }, { 1.0 / 3, 0.5 }, { 1.0 / 3, 1.0 }, { 1.0 / 6, 0.0 } };
+			const int stage = stepRecord.stage;
+			const bool lastStage = stage == getIntegrationStages() - 1;
+			const Stage& coefficients = parameters.integrator == Integrator::RK4 ? rk4Stages[stage] : heunStages[stage];
+
+			updateInput();
+			auto& activation = components[ComponentSlot::ACTIVATION];
+			const auto& restingLevel = components[ComponentSlot::RESTING_LEVEL];
+			const auto& input = components[ComponentSlot::INPUT];
+			const double a = deltaT / parameters.tau;
+			for (size_t i = 0; i < activation.size(); i++)
+			{
+				// the input was computed from the state of the stage, and so is the increment
+				const double increment = a * (-activation[i] + restingLevel[i] + input[i]);
+				if (stage == 0)
+				{
+					stageStartActivation[i] = activation[i];
+					stageIncrementSum[i] = 0.0;
+				}
+				stageIncrementSum[i] += coefficients.weight * increment;
+				activation[i] = stageStartActivation[i] + (lastStage ? stageIncrementSum[i] : coefficients.nextStateFraction * increment);
+			}
+			calculateOutput();
+			if (lastStage)
+				updateState(deltaT);
 		}
 
 		void NeuralField::calculateOutput()
 		{
-			components["output"] = parameters.activationFunction->operator()(components["activation"]);
+			parameters.activationFunction->operator()(components[ComponentSlot::ACTIVATION], components[ComponentSlot::OUTPUT]);
 		}
 
 		//void NeuralField::calculateCentroid()
 		//{
-		//	const std::vector<double> f_output = tools::math::heaviside(components["activation"], 0.1);
+		//	const std::vector<double> f_output = tools::math::heaviside(components[ComponentSlot::ACTIVATION], 0.1);
 
 		//	if (*std::ranges::max_element(f_output) > 0)
 		//	{
@@ -169,12 +332,97 @@ namespace dnf_composer
 			checkStability();
 		}
 
+		template <typename Activation>
+		void NeuralField::stepFused(double deltaT)
+		{
+			// input accumulation, euler update, activation function, min/max and the stability statistics,
+			// block by block so every block is read once from memory and then stays in the L1 cache
+			const auto& activationFunction = static_cast<const Activation&>(*parameters.activationFunction);
+			const size_t size = components[ComponentSlot::ACTIVATION].size();
+			double* const activation = components[ComponentSlot::ACTIVATION].data();
+			double* const output = components[ComponentSlot::OUTPUT].data();
+			if (size == 0)
+				return;
+
+			const bool summingInputs = collectInputSources();
+			tools::simd::FieldRow row = beginFusedRow(deltaT);
+			for (size_t begin = 0; begin < size; begin += fusedBlockSize)
+			{
+				const size_t end = std::min(begin + fusedBlockSize, size);
+				if (summingInputs)
+					sumInputBlock(begin, end);
+				tools::simd::integrateFieldRows(std::span<tools::simd::FieldRow>(&row, 1), begin, end);
+				activationFunction.evaluate(std::span<const double>(activation + begin, end - begin), std::span<double>(output + begin, end - begin));
+			}
+			endFusedRow(row);
+		}
+
+		template <typename Activation>
+		void NeuralField::evaluateFusedActivation(const ActivationFunction& activationFunction, std::span<const double> input, std::span<double> output)
+		{
+			static_cast<const Activation&>(activationFunction).evaluate(input, output);
+		}
+
+		bool NeuralField::collectInputSources()
+		{
+			// inputs that do not cover the whole field are summed by the generic path
+			const size_t size = components[ComponentSlot::INPUT].size();
+			inputSources.clear();
+			for (const auto& [inputElement, inputComponent] : getInputGather())
+			{
+				// static inputs are already in the folded input
+				if (!foldedInputElements.empty() && std::ranges::find(foldedInputElements, inputElement) != foldedInputElements.end())
+					continue;
+				const Component& source = *inputComponent;
+				if (source.size() != size)
+				{
+					inputSources.clear();
+					updateInput();
+					return false;
+				}
+				inputSources.push_back(source.data());
+			}
+			return true;
+		}
+
+		void NeuralField::sumInputBlock(size_t begin, size_t end)
+		{
+			double* const input = components[ComponentSlot::INPUT].data();
+			if (foldedInput.empty())
+				std::fill(input + begin, input + end, 0.0);
+			else
+				std::copy(foldedInput.data() + begin, foldedInput.data() + end, input + begin);
+			for (const double* const source : inputSources)
+				for (size_t i = begin; i < end; i++)
+					input[i] += source[i];
+		}
+
+		tools::simd::FieldRow NeuralField::beginFusedRow(double deltaT)
+		{
+			double* const activation = components[ComponentSlot::ACTIVATION].data();
+			// the statistics are kept in element order, so they match the separate passes exactly,
+			// and the extremes start empty, so only the integrated values count and not the activation before the step
+			return { activation, components[ComponentSlot::RESTING_LEVEL].data(), components[ComponentSlot::INPUT].data(),
+				getIntegrationGain(deltaT), std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), 0.0, 0.0 };
+		}
+
+		void NeuralField::endFusedRow(const tools::simd::FieldRow& row)
+		{
+			const size_t size = components[ComponentSlot::ACTIVATION].size();
+			state.lowestActivation = row.lowest;
+			state.highestActivation = row.highest;
+			checkStability(row.sum, row.sum / static_cast<double>(size), std::sqrt(row.sumOfSquares));
+		}
+
 		void NeuralField::checkStability()
 		{
-			const double currentActivationSum = tools::math::calculateVectorSum(components["activation"]);
-			const double currentActivationAvg = tools::math::calculateVectorAvg(components["activation"]);
-			const double currentActivationNorm = tools::math::calculateVectorNorm(components["activation"]);
+			checkStability(tools::math::calculateVectorSum(components[ComponentSlot::ACTIVATION]),
+				tools::math::calculateVectorAvg(components[ComponentSlot::ACTIVATION]),
+				tools::math::calculateVectorNorm(components[ComponentSlot::ACTIVATION]));
+		}
 
+		void NeuralField::checkStability(double currentActivationSum, double currentActivationAvg, double currentActivationNorm)
+		{
 			// this function is done like this, instead of comparing to a previously saved vector of activation,
 			// because it is simply faster and takes up less memory.
 			if (std::abs(currentActivationSum - state.previousActivationSum) < state.thresholdForStability)
@@ -208,15 +456,17 @@ namespace dnf_composer
 
 		void NeuralField::updateMinMaxActivation()
 		{
-			if (components["activation"].empty())
+			if (components[ComponentSlot::ACTIVATION].empty())
 				return;
-			state.lowestActivation = *std::ranges::min_element(components["activation"]);
-			state.highestActivation = *std::ranges::max_element(components["activation"]);
+			state.lowestActivation = *std::ranges::min_element(components[ComponentSlot::ACTIVATION]);
+			state.highestActivation = *std::ranges::max_element(components[ComponentSlot::ACTIVATION]);
 		}
 
 		void NeuralField::updateBumps(double deltaT)
 		{
-			const auto oldBumps = state.bumps;
+			// keep the previous bumps in a second buffer, so tracking them does not allocate
+			std::swap(previousBumps, state.bumps);
+			const auto& oldBumps = previousBumps;
 			state.bumps.clear();
 
 			constexpr double activationThreshold = 0.00001; // Define a threshold for what counts as a 'bump'
@@ -225,7 +475,7 @@ namespace dnf_composer
 
 			for (int i = 0; i < commonParameters.dimensionParameters.size; ++i)
 			{
-				double activation = components["activation"][i];
+				double activation = components[ComponentSlot::ACTIVATION][i];
 				if (activation > activationThreshold && !inBump)
 				{
 					// Start of a new bump
@@ -280,8 +530,8 @@ namespace dnf_composer
 				state.bumps.push_back(currentBump);
 
 			// Check if the first and last bumps are connected (wrap-around)
-			if (!state.bumps.empty() && components["activation"].front() > 
-				activationThreshold && components["activation"].back() > activationThreshold)
+			if (!state.bumps.empty() && components[ComponentSlot::ACTIVATION].front() > 
+				activationThreshold && components[ComponentSlot::ACTIVATION].back() > activationThreshold)
 			{
 				// Get the first and the last bump
 				const auto& firstBump = state.bumps.front();
@@ -0,0 +1,93 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "elements/neural_field_batch.h"
+
+#include <algorithm>
+
+#include "elements/neural_field.h"
+
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		void NeuralFieldBatch::reserve(size_t numberOfFields)
+		{
+			fields.reserve(numberOfFields);
+			deltaTs.reserve(numberOfFields);
+			rowFields.reserve(numberOfFields);
+			rowDeltaTs.reserve(numberOfFields);
+			rowSummingInputs.reserve(numberOfFields);
+			rows.reserve(numberOfFields);
+		}
+
+		void NeuralFieldBatch::clear()
+		{
+			fields.clear();
+			deltaTs.clear();
+		}
+
+		void NeuralFieldBatch::add(NeuralField* field, double deltaT)
+		{
+			fields.push_back(field);
+			deltaTs.push_back(deltaT);
+		}
+
+		void NeuralFieldBatch::step(double t)
+		{
+			rowFields.clear();
+			rowDeltaTs.clear();
+			rowSummingInputs.clear();
+			rows.clear();
+			for (size_t i = 0; i < fields.size(); i++)
+			{
+				NeuralField* field = fields[i];
+				// a field without a fused step, e.g. with an activation function of unknown type, steps on its own,
+				// and so does one in a step of several stages, see NeuralField::stepStage
+				if (!field->fusedStep || field->components[ComponentSlot::ACTIVATION].empty() ||
+					field->getIntegrationStages() > 1 || field->getStepRecord().stage > 0)
+				{
+					field->NeuralField::step(t, deltaTs[i]);
+					continue;
+				}
+				rowFields.push_back(field);
+				rowDeltaTs.push_back(deltaTs[i]);
+				rowSummingInputs.push_back(field->collectInputSources());
+				rows.push_back(field->beginFusedRow(deltaTs[i]));
+			}
+
+			for (size_t first = 0; first < rows.size();)
+			{
+				const size_t size = rowFields[first]->components[ComponentSlot::ACTIVATION].size();
+				size_t last = first + 1;
+				while (last < rows.size() && rowFields[last]->components[ComponentSlot::ACTIVATION].size() == size)
+					last++;
+
+				for (size_t begin = 0; begin < size; begin += NeuralField::fusedBlockSize)
+				{
+					const size_t end = std::min(begin + NeuralField::fusedBlockSize, size);
+					for (size_t r = first; r < last; r++)
+						if (rowSummingInputs[r])
+							rowFields[r]->sumInputBlock(begin, end);
+					tools::simd::integrateFieldRows(std::span<tools::simd::FieldRow>(rows).subspan(first, last - first), begin, end);
+					for (size_t r = first; r < last; r++)
+					{
+						Component& activation = rowFields[r]->components[ComponentSlot::ACTIVATION];
+						Component& output = rowFields[r]->components[ComponentSlot::OUTPUT];
+						rowFields[r]->fusedActivation(*rowFields[r]->parameters.activationFunction,
+							std::span<const double>(activation.data() + begin, end - begin), std::span<double>(output.data() + begin, end - begin));
+					}
+				}
+				first = last;
+			}
+
+			for (size_t r = 0; r < rows.size(); r++)
+			{
+				rowFields[r]->endFusedRow(rows[r]);
+				rowFields[r]->updateBumps(rowDeltaTs[r]);
+			}
+		}
+	}
+}
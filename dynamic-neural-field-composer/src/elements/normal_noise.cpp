@@ -9,22 +9,47 @@ namespace dnf_composer
 	namespace element
 	{
 		NormalNoise::NormalNoise(const ElementCommonParameters& elementCommonParameters, NormalNoiseParameters parameters)
-			: Element(elementCommonParameters), parameters(std::move(parameters))
+			: Element(elementCommonParameters), parameters(std::move(parameters)),
+			generator(0, tools::rng::hashName(commonParameters.identifiers.uniqueName))
 		{
 			 commonParameters.identifiers.label = ElementLabel::NORMAL_NOISE;
 		}
 
 		void NormalNoise::init()
 		{
-			std::ranges::fill(components["output"], 0.0);
+			std::ranges::fill(components[ComponentSlot::OUTPUT], 0.0);
+			generator.reset();
 		}
 
 		void NormalNoise::step(double t, double deltaT)
 		{
-			const std::vector<double> rand = tools::math::generateNormalVector(commonParameters.dimensionParameters.size);
+			// the noise is drawn once per step, the later stages of a multi-stage step see the same
+			if (stepRecord.stage > 0)
+				return;
 
-			for (int i = 0; i < commonParameters.dimensionParameters.size; i++)
-				components["output"][i] = parameters.amplitude / sqrt(deltaT) * rand[i];
+			auto& output = components[ComponentSlot::OUTPUT];
+			generator.fillNormal(output);
+
+			const double scale = parameters.amplitude / sqrt(deltaT);
+			for (double& value : output)
+				value *= scale;
+		}
+
+		void NormalNoise::setRandomSeed(std::uint64_t seed)
+		{
+			generator.setSeed(seed, tools::rng::hashName(commonParameters.identifiers.uniqueName));
+		}
+
+		void NormalNoise::saveState(ElementState& state) const
+		{
+			Element::saveState(state);
+			state.counters.assign(1, generator.getCounter());
+		}
+
+		void NormalNoise::restoreState(const ElementState& state)
+		{
+			Element::restoreState(state);
+			generator.setCounter(state.counters.at(0));
 		}
 
 		std::shared_ptr<Element> NormalNoise::clone() const
@@ -35,48 +35,34 @@ namespace dnf_composer
 			std::iota(rangeX.begin(), rangeX.end(), -kernelRange[0]);
 
 			// Compute the oscillatory kernel components
-			components["kernel"].resize(rangeX.size());
-			for (int i = 0; i < components["kernel"].size(); i++)
+			components[ComponentSlot::KERNEL].resize(rangeX.size());
+			for (size_t i = 0; i < components[ComponentSlot::KERNEL].size(); i++)
 			{
 				const double distance = rangeX[i];
 				const double decayFactor = exp(-parameters.decay * std::abs(distance));
 				const double oscillation = sin(parameters.decay * std::abs(parameters.zeroCrossings * distance)) + cos(parameters.zeroCrossings * distance);
-				components["kernel"][i] = parameters.amplitude * decayFactor * oscillation;
+				components[ComponentSlot::KERNEL][i] = parameters.amplitude * decayFactor * oscillation;
 			}
 
 			if (parameters.normalized)
 			{
-				const double normFactor = std::accumulate(components["kernel"].begin(), components["kernel"].end(), 0.0);
+				const double normFactor = std::accumulate(components[ComponentSlot::KERNEL].begin(), components[ComponentSlot::KERNEL].end(), 0.0);
 				if (normFactor != 0.0)
 				{
-					for (double& value : components["kernel"])
+					for (double& value : components[ComponentSlot::KERNEL])
 						value /= normFactor;
 				}
 			}
 
 			fullSum = 0.0;
-			std::ranges::fill(components["input"], 0.0);
-			std::ranges::fill(components["output"], 0.0);
+			std::ranges::fill(components[ComponentSlot::INPUT], 0.0);
+			std::ranges::fill(components[ComponentSlot::OUTPUT], 0.0);
+			prepareConvolution(parameters.circular);
 		}
 
 		void OscillatoryKernel::step(double t, double deltaT)
 		{
-			updateInput();
-
-			fullSum = std::accumulate(components["input"].begin(), components["input"].end(),
-				(double)0.0);
-
-			std::vector<double> convolution(commonParameters.dimensionParameters.size);
-			const std::vector<double> subDataInput = tools::math::obtainCircularVector(extIndex,
-				components["input"]);
-
-			if (parameters.circular)
-				convolution = tools::math::conv_valid(subDataInput, components["kernel"]);
-			else
-				convolution = tools::math::conv_same(components["input"], components["kernel"]);
-
-			for (int i = 0; i < components["output"].size(); i++)
-				components["output"][i] = convolution[i] + parameters.amplitudeGlobal * fullSum;
+			convolveInput(parameters.circular, parameters.amplitudeGlobal);
 		}
 
 		std::string OscillatoryKernel::toString() const
@@ -105,6 +91,7 @@ namespace dnf_composer
 			if (parameters.decay <= 0.0)
 				parameters.decay = 0.01;
 			init();
+			notifyParameterChange();
 		}
 
 		OscillatoryKernelParameters OscillatoryKernel::getParameters() const
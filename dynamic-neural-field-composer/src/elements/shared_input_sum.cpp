@@ -0,0 +1,33 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "elements/shared_input_sum.h"
+#include "elements/element.h"
+
+
+namespace dnf_composer
+{
+	namespace element
+	{
+		SharedInputSum::SharedInputSum(size_t size, size_t numberOfSources)
+			: sum(size, 0.0), pointers(numberOfSources, nullptr), upToDate(false)
+		{}
+
+		std::span<const double> SharedInputSum::gather(std::span<const InputSource> sources)
+		{
+			if (upToDate.load(std::memory_order_acquire))
+				return sum;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (upToDate.load(std::memory_order_relaxed))
+				return sum;
+
+			if (pointers.size() < sources.size())
+				pointers.resize(sources.size());
+			sumInputSources(sources, std::span<const double*>(pointers).first(sources.size()), sum);
+			upToDate.store(true, std::memory_order_release);
+			return sum;
+		}
+	}
+}
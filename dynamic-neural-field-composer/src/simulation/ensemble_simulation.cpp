@@ -0,0 +1,389 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "simulation/ensemble_simulation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <type_traits>
+
+#include "elements/neural_field.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/gauss_kernel.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/oscillatory_kernel.h"
+#include "elements/asymmetric_gauss_kernel.h"
+#include "elements/normal_noise.h"
+#include "elements/field_coupling.h"
+#include "elements/gauss_field_coupling.h"
+#include "tools/rng.h"
+
+
+namespace dnf_composer
+{
+	namespace
+	{
+		size_t getBatchSize(const element::ElementBatch& batch)
+		{
+			return std::visit([](const auto& batchElements) { return batchElements.size(); }, batch);
+		}
+
+		// element index of a batch of one of the kernel classes, whose step is Kernel::convolveInput, or null
+		element::Kernel* getKernel(const element::ElementBatch& batch, size_t index)
+		{
+			return std::visit([index](const auto& batchElements) -> element::Kernel*
+			{
+				using BatchElement = std::remove_pointer_t<typename std::decay_t<decltype(batchElements)>::value_type>;
+				if constexpr (std::is_base_of_v<element::Kernel, BatchElement>)
+					return batchElements[index];
+				else
+					return nullptr;
+			}, batch);
+		}
+	}
+
+	EnsembleSimulation::EnsembleSimulation(size_t numberOfInstances, const std::function<std::shared_ptr<Simulation>(size_t)>& buildInstance,
+		std::uint64_t seed)
+		: seed(seed), numberOfWorkers(0), lockstep(false), initialized(false), instanceStepsPerSecond(0)
+	{
+		if (numberOfInstances == 0 || !buildInstance)
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+
+		instances.reserve(numberOfInstances);
+		for (size_t i = 0; i < numberOfInstances; ++i)
+		{
+			std::shared_ptr<Simulation> instance = buildInstance(i);
+			if (!instance)
+				throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+			instances.push_back(std::move(instance));
+		}
+	}
+
+	void EnsembleSimulation::init()
+	{
+		for (size_t i = 0; i < instances.size(); ++i)
+		{
+			instances[i]->setSeed(getInstanceSeed(seed, i));
+			instances[i]->setExecutionMode(ExecutionMode::TYPE_SORTED);
+			instances[i]->init();
+		}
+		lockstep = haveSameExecutionPlan();
+		groupInstances();
+		initialized = true;
+
+		std::ostringstream oss;
+		oss << "Ensemble of " << instances.size() << " instances initialized with seed " << seed << ", stepped by "
+			<< groups.size() << " thread(s)" << (lockstep ? " in lockstep." : ", every instance on its own since their execution plans differ.");
+		log(tools::logger::LogLevel::INFO, oss.str());
+	}
+
+	void EnsembleSimulation::step()
+	{
+		if (!initialized)
+			init();
+
+		// compiled before the groups step, a compilation changes what the lockstep relies on
+		bool compiled = false;
+		for (const auto& instance : instances)
+		{
+			if (instance->paused || instance->isExecutionPlanUpToDate())
+				continue;
+			instance->compileExecutionPlan();
+			compiled = true;
+		}
+		if (compiled)
+		{
+			lockstep = haveSameExecutionPlan();
+			groupInstances();
+		}
+
+		if (threadPool)
+			threadPool->parallelFor(groups.size(), [this](size_t g) { stepGroup(groups[g]); });
+		else
+			for (InstanceGroup& group : groups)
+				stepGroup(group);
+	}
+
+	void EnsembleSimulation::run(double runTime)
+	{
+		if (runTime <= 0)
+			throw Exception(ErrorCode::SIM_RUNTIME_LESS_THAN_ZERO, static_cast<int>(runTime));
+		if (!initialized)
+			init();
+
+		// paused instances do not advance, so the run follows the instances that do, and ends at once if none does
+		const auto getLatestTime = [this]
+		{
+			double latestTime = -std::numeric_limits<double>::infinity();
+			for (const auto& instance : instances)
+				if (!instance->paused)
+					latestTime = std::max(latestTime, instance->t);
+			return latestTime;
+		};
+		const double endTime = getLatestTime() + runTime;
+		size_t numberOfSteps = 0;
+		const auto start = std::chrono::steady_clock::now();
+		while (getLatestTime() < endTime)
+		{
+			step();
+			numberOfSteps++;
+		}
+		const double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		instanceStepsPerSecond = wallTime > 0 ? static_cast<double>(numberOfSteps * instances.size()) / wallTime : 0;
+
+		std::ostringstream oss;
+		oss << "Ensemble ran " << numberOfSteps << " steps of " << instances.size() << " instances in " << std::fixed << std::setprecision(3)
+			<< wallTime << "s (" << std::setprecision(1) << instanceStepsPerSecond << " instance-steps/s) using " << groups.size() << " thread(s).";
+		log(tools::logger::LogLevel::INFO, oss.str());
+	}
+
+	void EnsembleSimulation::setNumberOfWorkers(int numberOfWorkers)
+	{
+		if (numberOfWorkers < 0)
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+		this->numberOfWorkers = numberOfWorkers;
+		threadPool.reset();
+		if (initialized)
+			groupInstances();
+	}
+
+	const std::shared_ptr<Simulation>& EnsembleSimulation::getInstance(size_t index) const
+	{
+		if (index >= instances.size())
+			throw Exception(ErrorCode::SIM_ELEM_INDEX, static_cast<int>(index));
+		return instances[index];
+	}
+
+	std::uint64_t EnsembleSimulation::getInstanceSeed(std::uint64_t seed, size_t instance)
+	{
+		// a block of the generator is a well mixed function of its inputs, so neighbouring instances get unrelated seeds
+		const auto block = tools::rng::PhiloxGenerator::generateBlock(seed, instance, 0);
+		return static_cast<std::uint64_t>(block[0]) << 32 | block[1];
+	}
+
+	bool EnsembleSimulation::haveSameExecutionPlan() const
+	{
+		const Simulation& first = *instances.front();
+		const auto& firstBatches = first.executionPlan.getBatches();
+		for (const auto& instance : instances)
+		{
+			const auto& batches = instance->executionPlan.getBatches();
+			if (instance->deltaT != first.deltaT || batches.size() != firstBatches.size())
+				return false;
+			for (size_t k = 0; k < batches.size(); ++k)
+			{
+				if (batches[k].index() != firstBatches[k].index())
+					return false;
+				const bool sameSizes = std::visit([&](const auto& batchElements)
+				{
+					const auto& firstElements = std::get<std::decay_t<decltype(batchElements)>>(firstBatches[k]);
+					if (batchElements.size() != firstElements.size())
+						return false;
+					for (size_t e = 0; e < batchElements.size(); ++e)
+						if (batchElements[e]->getSize() != firstElements[e]->getSize())
+							return false;
+					return true;
+				}, batches[k]);
+				if (!sameSizes)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	void EnsembleSimulation::groupInstances()
+	{
+		if (!threadPool && numberOfWorkers != 1)
+			threadPool = std::make_unique<tools::threading::ThreadPool>(numberOfWorkers);
+		const size_t numberOfThreads = threadPool ? static_cast<size_t>(threadPool->getNumberOfThreads()) : 1;
+		const size_t numberOfGroups = std::min(numberOfThreads, instances.size());
+
+		// the fields still live in the buffers of the previous groups until they are placed again
+		const std::vector<InstanceGroup> previousGroups = std::move(groups);
+		groups = std::vector<InstanceGroup>(numberOfGroups);
+		for (size_t g = 0; g < numberOfGroups; ++g)
+		{
+			InstanceGroup& group = groups[g];
+			group.begin = g * instances.size() / numberOfGroups;
+			group.end = (g + 1) * instances.size() / numberOfGroups;
+
+			size_t largestFieldBatch = 0;
+			size_t largestKernelBatch = 0;
+			for (const auto& batch : instances[group.begin]->executionPlan.getBatches())
+			{
+				if (std::holds_alternative<std::vector<element::NeuralField*>>(batch))
+					largestFieldBatch = std::max(largestFieldBatch, getBatchSize(batch));
+				if (getBatchSize(batch) != 0 && getKernel(batch, 0))
+					largestKernelBatch = std::max(largestKernelBatch, getBatchSize(batch));
+			}
+			group.fieldBatch.reserve(largestFieldBatch * (group.end - group.begin));
+			group.fieldInstances.reserve(largestFieldBatch * (group.end - group.begin));
+			group.kernelBatch.reserve(largestKernelBatch * (group.end - group.begin));
+			group.kernelInstances.reserve(largestKernelBatch * (group.end - group.begin));
+			if (lockstep)
+				placeRows(group);
+		}
+		if (numberOfGroups < 2)
+			threadPool.reset();
+	}
+
+	void EnsembleSimulation::placeRows(InstanceGroup& group) const
+	{
+		const auto& firstBatches = instances[group.begin]->executionPlan.getBatches();
+		size_t footprint = 0;
+		for (size_t i = group.begin; i < group.end; ++i)
+			for (const auto& batch : instances[i]->executionPlan.getBatches())
+			{
+				if (const auto* fields = std::get_if<std::vector<element::NeuralField*>>(&batch))
+					for (const element::NeuralField* field : *fields)
+						footprint += field->getComponentFootprint();
+				if (const auto* noises = std::get_if<std::vector<element::NormalNoise*>>(&batch))
+					for (const element::NormalNoise* noise : *noises)
+						footprint += noise->getComponentFootprint();
+			}
+
+		// every slot of every batch of fields is one matrix, whose rows are the fields of the batch in all the instances
+		// of the group, in the order they are stepped, and so is the output of every batch of normal noise
+		group.rowArena = std::make_shared<tools::memory::Arena>(footprint);
+		for (size_t k = 0; k < firstBatches.size(); ++k)
+		{
+			const auto getBatch = [this, k](size_t i) -> const element::ElementBatch& { return instances[i]->executionPlan.getBatches()[k]; };
+			if (std::holds_alternative<std::vector<element::NeuralField*>>(firstBatches[k]))
+			{
+				for (const element::ComponentSlot slot : { element::ComponentSlot::ACTIVATION, element::ComponentSlot::INPUT,
+					element::ComponentSlot::OUTPUT, element::ComponentSlot::RESTING_LEVEL })
+					for (size_t f = 0; f < getBatchSize(firstBatches[k]); ++f)
+						for (size_t i = group.begin; i < group.end; ++i)
+							std::get<std::vector<element::NeuralField*>>(getBatch(i))[f]->relocateComponents(group.rowArena, slot);
+			}
+			else if (std::holds_alternative<std::vector<element::NormalNoise*>>(firstBatches[k]))
+			{
+				for (size_t f = 0; f < getBatchSize(firstBatches[k]); ++f)
+					for (size_t i = group.begin; i < group.end; ++i)
+						std::get<std::vector<element::NormalNoise*>>(getBatch(i))[f]->relocateComponents(group.rowArena, element::ComponentSlot::OUTPUT);
+			}
+		}
+	}
+
+	void EnsembleSimulation::stepGroup(InstanceGroup& group)
+	{
+		int stages = 1;
+		for (size_t i = group.begin; i < group.end; ++i)
+			if (!instances[i]->paused)
+			{
+				instances[i]->beginEnsembleStep();
+				stages = std::max(stages, instances[i]->integrationStages);
+			}
+
+		if (stages == 1)
+			stepGroupBatches(group, 0, Simulation::SweepPass::ALL);
+		else
+		{
+			// as in Simulation::stepElements, every stage evaluates the inputs of the neural fields and then the fields,
+			// an instance takes as many stages as its own integrators have
+			for (int stage = 0; stage < stages; ++stage)
+			{
+				for (size_t i = group.begin; i < group.end; ++i)
+					if (!instances[i]->paused && stage < instances[i]->integrationStages)
+						instances[i]->beginIntegrationStage(stage);
+				stepGroupBatches(group, stage, Simulation::SweepPass::INPUTS);
+				stepGroupBatches(group, stage, Simulation::SweepPass::NEURAL_FIELDS);
+			}
+			for (size_t i = group.begin; i < group.end; ++i)
+				if (!instances[i]->paused)
+					instances[i]->beginIntegrationStage(0);
+		}
+
+		for (size_t i = group.begin; i < group.end; ++i)
+			if (!instances[i]->paused)
+				instances[i]->endEnsembleStep();
+	}
+
+	void EnsembleSimulation::stepGroupBatches(InstanceGroup& group, int stage, Simulation::SweepPass pass)
+	{
+		const auto isBatchStepped = [stage, pass](const Simulation& instance, const element::ElementBatch& batch)
+		{
+			if (instance.paused || stage >= instance.integrationStages)
+				return false;
+			// an instance that takes the step in one stage steps all its elements in the first pass, as it does alone
+			if (instance.integrationStages == 1 && pass != Simulation::SweepPass::ALL)
+				return pass == Simulation::SweepPass::INPUTS;
+			return Simulation::isInSweepPass(batch, pass);
+		};
+
+		if (!lockstep)
+		{
+			for (size_t i = group.begin; i < group.end; ++i)
+				for (const element::ElementBatch& batch : instances[i]->executionPlan.getBatches())
+					if (isBatchStepped(*instances[i], batch))
+						instances[i]->stepBatch(batch);
+			return;
+		}
+
+		const size_t numberOfBatches = instances[group.begin]->executionPlan.getBatches().size();
+		for (size_t k = 0; k < numberOfBatches; ++k)
+		{
+			const element::ElementBatch& firstBatch = instances[group.begin]->executionPlan.getBatches()[k];
+			if (getBatchSize(firstBatch) != 0 && getKernel(firstBatch, 0))
+			{
+				// the kernels of this batch in every instance are convolved as one, kernel after kernel,
+				// so the columns of a kernel in all the instances are convolved together
+				group.kernelBatch.clear();
+				group.kernelInstances.clear();
+				for (size_t f = 0; f < getBatchSize(firstBatch); ++f)
+					for (size_t i = group.begin; i < group.end; ++i)
+					{
+						Simulation& instance = *instances[i];
+						const element::ElementBatch& batch = instance.executionPlan.getBatches()[k];
+						element::Kernel* kernel = getKernel(batch, f);
+						double elementDeltaT;
+						if (isBatchStepped(instance, batch) && instance.isElementStepped(kernel, elementDeltaT))
+						{
+							group.kernelBatch.add(kernel, elementDeltaT);
+							group.kernelInstances.push_back(&instance);
+						}
+					}
+				group.kernelBatch.step(instances[group.begin]->t);
+
+				for (size_t f = 0; f < group.kernelInstances.size(); ++f)
+					group.kernelInstances[f]->recordStep(group.kernelBatch.getKernels()[f]);
+				continue;
+			}
+			if (!std::holds_alternative<std::vector<element::NeuralField*>>(firstBatch))
+			{
+				for (size_t i = group.begin; i < group.end; ++i)
+					if (isBatchStepped(*instances[i], instances[i]->executionPlan.getBatches()[k]))
+						instances[i]->stepBatch(instances[i]->executionPlan.getBatches()[k]);
+				continue;
+			}
+
+			// the fields of this batch in every instance are stepped as one, field after field,
+			// so the rows of a field in all the instances are integrated together
+			group.fieldBatch.clear();
+			group.fieldInstances.clear();
+			const size_t numberOfFields = getBatchSize(firstBatch);
+			for (size_t f = 0; f < numberOfFields; ++f)
+				for (size_t i = group.begin; i < group.end; ++i)
+				{
+					Simulation& instance = *instances[i];
+					const element::ElementBatch& batch = instance.executionPlan.getBatches()[k];
+					element::NeuralField* field = std::get<std::vector<element::NeuralField*>>(batch)[f];
+					double elementDeltaT;
+					if (isBatchStepped(instance, batch) && instance.isElementStepped(field, elementDeltaT))
+					{
+						group.fieldBatch.add(field, elementDeltaT);
+						group.fieldInstances.push_back(&instance);
+					}
+				}
+			group.fieldBatch.step(instances[group.begin]->t);
+
+			for (size_t f = 0; f < group.fieldInstances.size(); ++f)
+				if (group.fieldInstances[f]->applyingStepPeriods)
+					group.fieldInstances[f]->recordStep(group.fieldBatch.getFields()[f]);
+		}
+	}
+}
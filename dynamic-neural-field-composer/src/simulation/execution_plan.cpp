@@ -0,0 +1,284 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "simulation/execution_plan.h"
+
+#include <queue>
+#include <functional>
+
+
+namespace dnf_composer
+{
+	namespace
+	{
+		// Tarjan's algorithm, returns the strongly connected components of the graph.
+		std::vector<std::vector<size_t>> findStronglyConnectedComponents(const std::vector<std::vector<size_t>>& successors)
+		{
+			const size_t n = successors.size();
+			constexpr size_t unvisited = static_cast<size_t>(-1);
+			std::vector<size_t> index(n, unvisited);
+			std::vector<size_t> lowLink(n, 0);
+			std::vector<bool> onStack(n, false);
+			std::vector<size_t> stack;
+			std::vector<std::vector<size_t>> components;
+			size_t nextIndex = 0;
+
+			std::function<void(size_t)> visit = [&](size_t v)
+			{
+				index[v] = lowLink[v] = nextIndex++;
+				stack.push_back(v);
+				onStack[v] = true;
+
+				for (const size_t w : successors[v])
+				{
+					if (index[w] == unvisited)
+					{
+						visit(w);
+						lowLink[v] = std::min(lowLink[v], lowLink[w]);
+					}
+					else if (onStack[w])
+						lowLink[v] = std::min(lowLink[v], index[w]);
+				}
+
+				if (lowLink[v] == index[v])
+				{
+					std::vector<size_t> component;
+					size_t w;
+					do
+					{
+						w = stack.back();
+						stack.pop_back();
+						onStack[w] = false;
+						component.push_back(w);
+					} while (w != v);
+					components.push_back(std::move(component));
+				}
+			};
+
+			for (size_t v = 0; v < n; ++v)
+				if (index[v] == unvisited)
+					visit(v);
+
+			return components;
+		}
+
+		bool isReachable(const std::vector<std::vector<size_t>>& successors, size_t from, size_t to)
+		{
+			std::vector<bool> visited(successors.size(), false);
+			std::vector<size_t> pending{ from };
+			visited[from] = true;
+			while (!pending.empty())
+			{
+				const size_t u = pending.back();
+				pending.pop_back();
+				if (u == to)
+					return true;
+				for (const size_t v : successors[u])
+					if (!visited[v])
+					{
+						visited[v] = true;
+						pending.push_back(v);
+					}
+			}
+			return false;
+		}
+	}
+
+	ExecutionPlan::ExecutionPlan()
+		: compiledConnectionRevision(0), compiled(false), numberOfCompilations(0)
+	{}
+
+	void ExecutionPlan::compile(const std::vector<std::shared_ptr<element::Element>>& elements, std::uint64_t connectionRevision,
+		const std::vector<std::shared_ptr<element::Element>>& heldElements)
+	{
+		const size_t n = elements.size();
+
+		std::unordered_map<const element::Element*, size_t> indexOf;
+		indexOf.reserve(n);
+		for (size_t i = 0; i < n; ++i)
+			indexOf[elements[i].get()] = i;
+
+		// successors[u] holds every element that reads from element u
+		std::vector<std::vector<size_t>> successors(n);
+		for (size_t v = 0; v < n; ++v)
+		{
+			for (const auto& input : elements[v]->getInputs())
+			{
+				const auto it = indexOf.find(input.get());
+				if (it == indexOf.end())
+				{
+					if (std::ranges::find(heldElements, input) != heldElements.end())
+						continue;
+					const std::string logMessage = "Element '" + elements[v]->getUniqueName() + "' has input '" +
+						input->getUniqueName() + "' which is not part of the simulation. It is ignored by the execution plan.";
+					log(tools::logger::LogLevel::WARNING, logMessage);
+					continue;
+				}
+				successors[it->second].push_back(v);
+			}
+		}
+		// inputs are stored in a hash map, sort them so the plan does not depend on hashing
+		for (auto& s : successors)
+			std::ranges::sort(s);
+
+		// Break cycles. Every connection that closes a cycle into a delay point is delayed by one step.
+		// A cycle without any delay point is broken at its first element (in insertion order).
+		std::vector<std::pair<size_t, size_t>> removedConnections;
+		bool acyclic = false;
+		while (!acyclic)
+		{
+			acyclic = true;
+			for (const auto& component : findStronglyConnectedComponents(successors))
+			{
+				const size_t first = component.front();
+				const bool hasSelfLoop = std::ranges::find(successors[first], first) != successors[first].end();
+				if (component.size() == 1 && !hasSelfLoop)
+					continue;
+
+				acyclic = false;
+				std::vector<bool> inComponent(n, false);
+				for (const size_t v : component)
+					inComponent[v] = true;
+
+				const bool hasDelayPoint = std::ranges::any_of(component, [&](size_t v) { return elements[v]->isDelayPoint(); });
+				const size_t fallbackBreakPoint = *std::ranges::min_element(component);
+				if (!hasDelayPoint)
+				{
+					const std::string logMessage = "Cycle without a delay point found in the simulation. It is broken at element '" +
+						elements[fallbackBreakPoint]->getUniqueName() + "'.";
+					log(tools::logger::LogLevel::WARNING, logMessage);
+				}
+
+				for (const size_t u : component)
+				{
+					std::erase_if(successors[u], [&](size_t v)
+					{
+						const bool isBreakPoint = hasDelayPoint ? elements[v]->isDelayPoint() : v == fallbackBreakPoint;
+						if (!inComponent[v] || !isBreakPoint)
+							return false;
+						removedConnections.emplace_back(u, v);
+						return true;
+					});
+				}
+			}
+		}
+
+		// A cycle with several delay points only needs one delayed connection. Restore every removed
+		// connection that no longer closes a cycle. The remaining ones are delayed, and for each of them
+		// the receiving element is guaranteed to run before the source element, so the receiving element
+		// always reads the previous output whatever the order of the elements within a level.
+		delayedConnections.clear();
+		for (const auto& [u, v] : removedConnections)
+		{
+			if (u != v && !isReachable(successors, v, u))
+			{
+				successors[u].push_back(v);
+				continue;
+			}
+			delayedConnections.push_back({ elements[u]->getUniqueName(), elements[v]->getUniqueName() });
+		}
+
+		// Kahn's algorithm, ties are resolved in insertion order so the plan is deterministic
+		std::vector<size_t> inDegree(n, 0);
+		for (const auto& s : successors)
+			for (const size_t v : s)
+				inDegree[v]++;
+
+		std::priority_queue<size_t, std::vector<size_t>, std::greater<>> ready;
+		for (size_t v = 0; v < n; ++v)
+			if (inDegree[v] == 0)
+				ready.push(v);
+
+		// the level of an element is the length of the longest path that leads to it,
+		// elements of the same level do not read from each other
+		std::vector<size_t> level(n, 0);
+		orderedElements.clear();
+		orderedElements.reserve(n);
+		levels.clear();
+		while (!ready.empty())
+		{
+			const size_t u = ready.top();
+			ready.pop();
+			orderedElements.push_back(elements[u].get());
+			if (levels.size() <= level[u])
+				levels.resize(level[u] + 1);
+			levels[level[u]].push_back(elements[u].get());
+			for (const size_t v : successors[u])
+			{
+				level[v] = std::max(level[v], level[u] + 1);
+				if (--inDegree[v] == 0)
+					ready.push(v);
+			}
+		}
+
+		// the elements of a level do not read from each other, so they may be regrouped by class, in insertion order
+		// within every class, and a delayed connection is still read before its source element steps
+		batches.clear();
+		std::vector<element::Element*> batchElements;
+		for (const auto& levelElements : levels)
+		{
+			std::vector<size_t> batchIndices;
+			batchIndices.reserve(levelElements.size());
+			for (const element::Element* element : levelElements)
+				batchIndices.push_back(element::getBatchIndex(*element));
+			for (size_t batchIndex = 0; batchIndex < std::variant_size_v<element::ElementBatch>; ++batchIndex)
+			{
+				batchElements.clear();
+				for (size_t i = 0; i < levelElements.size(); ++i)
+					if (batchIndices[i] == batchIndex)
+						batchElements.push_back(levelElements[i]);
+				if (!batchElements.empty())
+					batches.push_back(element::makeBatch(batchIndex, batchElements));
+			}
+		}
+
+		compiledConnectionRevision = connectionRevision;
+		compiled = true;
+		numberOfCompilations++;
+
+		const std::string logMessage = "Execution plan compiled with " + std::to_string(orderedElements.size()) +
+			" elements in " + std::to_string(levels.size()) + " levels and " + std::to_string(delayedConnections.size()) +
+			" delayed connections, stepped as " + std::to_string(batches.size()) + " batches of one class each.";
+		log(tools::logger::LogLevel::INFO, logMessage);
+	}
+
+	void ExecutionPlan::invalidate()
+	{
+		compiled = false;
+	}
+
+	bool ExecutionPlan::isUpToDate(std::uint64_t connectionRevision) const
+	{
+		return compiled && compiledConnectionRevision == connectionRevision;
+	}
+
+	std::string ExecutionPlan::toString() const
+	{
+		std::string result = "Execution plan [";
+		for (size_t i = 0; i < orderedElements.size(); ++i)
+		{
+			result += orderedElements[i]->getUniqueName();
+			if (i + 1 < orderedElements.size())
+				result += " -> ";
+		}
+		result += "]\nLevels {";
+		for (size_t i = 0; i < levels.size(); ++i)
+		{
+			result += " " + std::to_string(i) + ":";
+			for (const auto& element : levels[i])
+				result += " " + element->getUniqueName();
+			result += ";";
+		}
+		result += " }\nDelayed connections {";
+		for (const auto& connection : delayedConnections)
+			result += " " + connection.sourceElement + " -> " + connection.receivingElement + ";";
+		result += " }";
+		return result;
+	}
+
+	void ExecutionPlan::print() const
+	{
+		log(tools::logger::LogLevel::INFO, toString());
+	}
+}
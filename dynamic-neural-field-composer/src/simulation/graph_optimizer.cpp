@@ -0,0 +1,183 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "simulation/graph_optimizer.h"
+
+#include <set>
+#include <unordered_map>
+
+#include "elements/neural_field.h"
+#include "elements/kernel.h"
+
+
+namespace dnf_composer
+{
+	namespace
+	{
+		std::string joinNames(const std::vector<std::string>& names)
+		{
+			std::string result;
+			for (size_t i = 0; i < names.size(); ++i)
+				result += (i == 0 ? "" : ", ") + names[i];
+			return result;
+		}
+	}
+
+	std::string GraphOptimizationReport::toString() const
+	{
+		size_t numberOfFoldedInputs = 0;
+		for (const auto& [field, inputs] : foldedInputs)
+			numberOfFoldedInputs += inputs.size();
+		size_t numberOfMergedKernels = 0;
+		for (const auto& [kernel, kernels] : mergedKernels)
+			numberOfMergedKernels += kernels.size();
+
+		std::string result = "Graph optimization folded " + std::to_string(numberOfFoldedInputs) + " static inputs into " +
+			std::to_string(foldedInputs.size()) + " fields, merged " + std::to_string(numberOfMergedKernels) + " kernels and dropped " +
+			std::to_string(droppedElements.size()) + " elements, " + std::to_string(numberOfSteppedElements) + " of " +
+			std::to_string(numberOfElements) + " elements are stepped.";
+		for (const auto& [field, inputs] : foldedInputs)
+			result += " Folded into '" + field + "': " + joinNames(inputs) + ".";
+		for (const auto& [kernel, kernels] : mergedKernels)
+			result += " Merged into '" + kernel + "': " + joinNames(kernels) + ".";
+		if (!droppedElements.empty())
+			result += " Dropped: " + joinNames(droppedElements) + ".";
+		return result;
+	}
+
+	std::vector<std::shared_ptr<element::Element>> GraphOptimizer::optimize(const std::vector<std::shared_ptr<element::Element>>& elements)
+	{
+		revert(elements);
+		const size_t n = elements.size();
+		report.numberOfElements = n;
+
+		std::unordered_map<std::string, size_t> indexOfName;
+		std::unordered_map<const element::Element*, size_t> indexOf;
+		for (size_t i = 0; i < n; ++i)
+		{
+			indexOfName[elements[i]->getUniqueName()] = i;
+			indexOf[elements[i].get()] = i;
+		}
+
+		// readers[u] holds every element that reads from element u, with the component it reads
+		std::vector<std::vector<std::pair<size_t, std::string>>> readers(n);
+		std::vector<std::vector<std::pair<size_t, std::string>>> sources(n);
+		for (size_t v = 0; v < n; ++v)
+		{
+			for (const auto& [input, inputComponent] : elements[v]->getOrderedInputs())
+			{
+				const auto it = indexOf.find(input.get());
+				if (it == indexOf.end())
+					continue;
+				readers[it->second].emplace_back(v, inputComponent);
+				sources[v].emplace_back(it->second, inputComponent);
+			}
+		}
+		for (auto& r : readers)
+			std::ranges::sort(r);
+
+		// the static inputs of every field are summed into its constant input, a connection
+		// from a folded input is no longer read during a step
+		std::set<std::pair<size_t, size_t>> foldedConnections;
+		for (size_t v = 0; v < n; ++v)
+		{
+			const auto field = std::dynamic_pointer_cast<element::NeuralField>(elements[v]);
+			if (!field)
+				continue;
+			const std::vector<std::string> folded = field->foldStaticInputs();
+			if (folded.empty())
+				continue;
+			for (const auto& name : folded)
+				foldedConnections.emplace(v, indexOfName.at(name));
+			report.foldedInputs.emplace_back(field->getUniqueName(), folded);
+		}
+
+		// kernels with the same input whose outputs are summed by the same fields are convolved as one,
+		// the first of them computes the sum and the others hold a zero output
+		std::vector<bool> held(n, false);
+		const auto isMergeable = [&](size_t u)
+		{
+			if (held[u] || elements[u]->isObservable() || sources[u].size() != 1 || readers[u].empty())
+				return false;
+			if (!dynamic_cast<element::Kernel*>(elements[u].get()))
+				return false;
+			return std::ranges::all_of(readers[u], [&](const auto& reader)
+			{
+				return reader.second == "output" && dynamic_cast<element::NeuralField*>(elements[reader.first].get());
+			});
+		};
+		for (size_t u = 0; u < n; ++u)
+		{
+			if (!isMergeable(u))
+				continue;
+			auto& kernel = static_cast<element::Kernel&>(*elements[u]);
+			std::vector<std::string> merged;
+			for (size_t w = u + 1; w < n; ++w)
+			{
+				if (!isMergeable(w) || sources[w] != sources[u] || readers[w] != readers[u] ||
+					elements[w]->getStepPeriod() != elements[u]->getStepPeriod())
+					continue;
+				if (!kernel.mergeKernel(static_cast<element::Kernel&>(*elements[w])))
+					continue;
+				held[w] = true;
+				merged.push_back(elements[w]->getUniqueName());
+			}
+			if (!merged.empty())
+				report.mergedKernels.emplace_back(kernel.getUniqueName(), merged);
+		}
+
+		// an element none of whose outputs reaches an observable element does not change what is observed,
+		// dropping an element may leave the elements it reads without readers too
+		bool dropped = true;
+		while (dropped)
+		{
+			dropped = false;
+			for (size_t u = 0; u < n; ++u)
+			{
+				if (held[u] || elements[u]->isObservable())
+					continue;
+				const bool isRead = std::ranges::any_of(readers[u], [&](const auto& reader)
+				{
+					return !held[reader.first] && !foldedConnections.contains({ reader.first, u });
+				});
+				if (isRead)
+					continue;
+				held[u] = true;
+				report.droppedElements.push_back(elements[u]->getUniqueName());
+				dropped = true;
+			}
+		}
+
+		std::vector<std::shared_ptr<element::Element>> steppedElements;
+		for (size_t u = 0; u < n; ++u)
+		{
+			if (held[u])
+				heldElements.push_back(elements[u]);
+			else
+				steppedElements.push_back(elements[u]);
+		}
+		report.numberOfSteppedElements = steppedElements.size();
+		return steppedElements;
+	}
+
+	void GraphOptimizer::revert(const std::vector<std::shared_ptr<element::Element>>& elements)
+	{
+		for (const auto& element : elements)
+			revert(*element);
+		// a held static element may have been given new parameters, which its published components do not show yet
+		for (const auto& element : heldElements)
+			if (element->isStatic())
+				element->publishComponents(false);
+		heldElements.clear();
+		report = {};
+	}
+
+	void GraphOptimizer::revert(element::Element& element)
+	{
+		if (auto* field = dynamic_cast<element::NeuralField*>(&element))
+			field->unfoldStaticInputs();
+		else if (auto* kernel = dynamic_cast<element::Kernel*>(&element))
+			kernel->separateKernels();
+	}
+}
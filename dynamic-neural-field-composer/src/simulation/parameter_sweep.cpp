@@ -0,0 +1,421 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "simulation/parameter_sweep.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+
+#include "simulation/simulation_file_manager.h"
+#include "tools/thread_pool.h"
+
+
+namespace dnf_composer
+{
+	namespace
+	{
+		// FNV-1a, stable across runs and platforms, so the hashes in a result file stay valid
+		std::uint64_t hashBytes(std::uint64_t hash, const void* data, size_t size)
+		{
+			const auto* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}
+
+		std::uint64_t hashPoint(const json& elements, const SweepSpecification& specification, const std::vector<std::string>& observedFields)
+		{
+			// the result of a point depends on the elements it is built from and on how it is run, not on how the sweep reached it
+			const std::string dump = elements.dump();
+			std::uint64_t hash = hashBytes(0xcbf29ce484222325ull, dump.data(), dump.size());
+			hash = hashBytes(hash, &specification.deltaT, sizeof(specification.deltaT));
+			hash = hashBytes(hash, &specification.runTime, sizeof(specification.runTime));
+			hash = hashBytes(hash, &specification.seed, sizeof(specification.seed));
+			for (const std::string& field : observedFields)
+				hash = hashBytes(hash, field.c_str(), field.size() + 1);
+			return hash;
+		}
+
+		std::string hashToString(std::uint64_t hash)
+		{
+			std::ostringstream oss;
+			oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+			return oss.str();
+		}
+
+		json& findParameter(json& elements, const SweepParameter& parameter)
+		{
+			for (json& elementJson : elements)
+			{
+				if (!elementJson.contains("uniqueName") || elementJson["uniqueName"] != parameter.elementName)
+					continue;
+
+				json* entry = &elementJson;
+				std::istringstream path(parameter.parameterName);
+				std::string key;
+				while (std::getline(path, key, '.'))
+				{
+					if (!entry->is_object() || !entry->contains(key))
+						entry = nullptr;
+					else
+						entry = &(*entry)[key];
+					if (!entry)
+						break;
+				}
+				if (!entry || !entry->is_number())
+				{
+					log(tools::logger::LogLevel::ERROR, "Element " + parameter.elementName + " has no numeric parameter " + parameter.parameterName + " to sweep.");
+					throw Exception(ErrorCode::ELEM_INVALID_PARAMETER, parameter.elementName);
+				}
+				return *entry;
+			}
+			throw Exception(ErrorCode::SIM_ELEM_NOT_FOUND, parameter.elementName);
+		}
+
+		json resultToJson(const SweepPointResult& result, const SweepSpecification& specification)
+		{
+			json resultJson;
+			resultJson["hash"] = hashToString(result.hash);
+			resultJson["parameters"] = json::array();
+			for (size_t i = 0; i < specification.parameters.size(); ++i)
+				resultJson["parameters"].push_back({ {"element", specification.parameters[i].elementName},
+					{"parameter", specification.parameters[i].parameterName}, {"value", result.values[i]} });
+			resultJson["fields"] = json::array();
+			for (const SweepFieldMetrics& field : result.fields)
+			{
+				json fieldJson = { {"name", field.fieldName}, {"bumps", field.numberOfBumps}, {"centroids", field.centroids} };
+				if (std::isnan(field.timeToStability))
+					fieldJson["timeToStability"] = nullptr;
+				else
+					fieldJson["timeToStability"] = field.timeToStability;
+				resultJson["fields"].push_back(fieldJson);
+			}
+			return resultJson;
+		}
+
+		SweepPointResult resultFromJson(const json& resultJson)
+		{
+			SweepPointResult result;
+			result.hash = std::stoull(resultJson.at("hash").get<std::string>(), nullptr, 16);
+			for (const json& parameter : resultJson.at("parameters"))
+				result.values.push_back(parameter.at("value"));
+			for (const json& fieldJson : resultJson.at("fields"))
+			{
+				SweepFieldMetrics field;
+				field.fieldName = fieldJson.at("name");
+				field.numberOfBumps = fieldJson.at("bumps");
+				field.centroids = fieldJson.at("centroids").get<std::vector<double>>();
+				if (!fieldJson.at("timeToStability").is_null())
+					field.timeToStability = fieldJson.at("timeToStability");
+				result.fields.push_back(field);
+			}
+			result.cached = true;
+			return result;
+		}
+
+		json readJsonFile(const std::string& filePath, const std::string& description)
+		{
+			std::ifstream file(filePath);
+			if (!file.is_open())
+				throw Exception("Unable to open " + description + " " + filePath + ".");
+			try
+			{
+				return json::parse(file);
+			}
+			catch (const json::exception& ex)
+			{
+				throw Exception("Unable to read " + description + " " + filePath + ": " + ex.what());
+			}
+		}
+
+		SweepPointResult runPoint(const json& elements, const SweepSpecification& specification, const std::vector<std::string>& observedFields,
+			std::uint64_t hash, size_t& numberOfPlanCompilations)
+		{
+			const auto simulation = std::make_shared<Simulation>("sweep point " + hashToString(hash), specification.deltaT, 0.0, 0.0);
+			const SimulationFileManager sfm{ simulation };
+			sfm.loadElementsFromJson(elements);
+			simulation->setSeed(specification.seed);
+			simulation->init();
+
+			std::vector<std::shared_ptr<element::NeuralField>> fields;
+			for (const std::string& name : observedFields)
+				fields.push_back(std::dynamic_pointer_cast<element::NeuralField>(simulation->getElement(name)));
+			std::vector<double> stableSince(fields.size(), std::numeric_limits<double>::quiet_NaN());
+			while (simulation->getT() < specification.runTime)
+			{
+				simulation->step();
+				for (size_t f = 0; f < fields.size(); ++f)
+					if (!fields[f]->isStable())
+						stableSince[f] = std::numeric_limits<double>::quiet_NaN();
+					else if (std::isnan(stableSince[f]))
+						stableSince[f] = simulation->getT();
+			}
+
+			SweepPointResult result;
+			result.hash = hash;
+			for (size_t f = 0; f < fields.size(); ++f)
+			{
+				SweepFieldMetrics metrics;
+				metrics.fieldName = observedFields[f];
+				const auto bumps = fields[f]->getBumps();
+				metrics.numberOfBumps = bumps.size();
+				for (const auto& bump : bumps)
+					metrics.centroids.push_back(bump.centroid);
+				metrics.timeToStability = stableSince[f];
+				result.fields.push_back(metrics);
+			}
+			numberOfPlanCompilations = simulation->getExecutionPlan().getNumberOfCompilations();
+
+			// the elements hold each other through their inputs and outputs, which would keep them alive
+			simulation->close();
+			for (const auto& element : simulation->getElements())
+				element->removeInputs();
+			return result;
+		}
+	}
+
+	ParameterSweep::ParameterSweep(std::string simulationFilePath, SweepSpecification specification, std::string resultFilePath)
+		: simulationFilePath(std::move(simulationFilePath)), resultFilePath(std::move(resultFilePath)),
+		specification(std::move(specification)), numberOfWorkers(0), numberOfPlanCompilations(0)
+	{
+		if (this->specification.runTime <= 0)
+			throw Exception(ErrorCode::SIM_RUNTIME_LESS_THAN_ZERO, static_cast<int>(this->specification.runTime));
+		if (this->specification.deltaT <= 0)
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+		for (const SweepParameter& parameter : this->specification.parameters)
+			if (parameter.values.empty() || (this->specification.mode == SweepMode::LIST &&
+				parameter.values.size() != this->specification.parameters.front().values.size()))
+				throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+	}
+
+	std::vector<SweepPointResult> ParameterSweep::run()
+	{
+		const json baseElements = readJsonFile(simulationFilePath, "simulation file");
+		readCache();
+
+		std::vector<std::string> observedFields = specification.observedFields;
+		for (const json& elementJson : baseElements)
+		{
+			const bool isNeuralField = elementJson.at("label")[0] == element::ElementLabel::NEURAL_FIELD;
+			if (specification.observedFields.empty() && isNeuralField)
+				observedFields.push_back(elementJson.at("uniqueName"));
+		}
+		for (const std::string& name : observedFields)
+		{
+			const bool found = std::any_of(baseElements.begin(), baseElements.end(), [&name](const json& elementJson)
+				{ return elementJson.at("uniqueName") == name && elementJson.at("label")[0] == element::ElementLabel::NEURAL_FIELD; });
+			if (!found)
+				throw Exception(ErrorCode::SIM_ELEM_NOT_FOUND, name);
+		}
+
+		// the points found in the result file are taken from it, every other point is run once
+		const std::vector<std::vector<double>> points = getPoints();
+		std::vector<SweepPointResult> results(points.size());
+		std::vector<size_t> pendingPoints;
+		std::vector<json> pendingElements;
+		std::vector<std::uint64_t> pendingPointHashes;
+		std::unordered_map<std::uint64_t, size_t> pendingHashes;
+		std::vector<std::pair<size_t, std::uint64_t>> repeatedPoints;
+		for (size_t p = 0; p < points.size(); ++p)
+		{
+			json elements = baseElements;
+			for (size_t i = 0; i < specification.parameters.size(); ++i)
+				findParameter(elements, specification.parameters[i]) = points[p][i];
+			const std::uint64_t hash = hashPoint(elements, specification, observedFields);
+
+			if (const auto cached = cache.find(hash); cached != cache.end())
+			{
+				results[p] = cached->second;
+				results[p].values = points[p];
+			}
+			else if (pendingHashes.contains(hash))
+				repeatedPoints.emplace_back(p, hash);
+			else
+			{
+				pendingHashes.emplace(hash, p);
+				pendingPoints.push_back(p);
+				pendingElements.push_back(std::move(elements));
+				pendingPointHashes.push_back(hash);
+			}
+		}
+
+		// a line cut short by an interrupted sweep must not swallow the first new one
+		bool endsWithNewline = true;
+		if (std::ifstream existingFile(resultFilePath, std::ios::binary | std::ios::ate); existingFile.is_open() && existingFile.tellg() > 0)
+		{
+			existingFile.seekg(-1, std::ios::end);
+			endsWithNewline = existingFile.get() == '\n';
+		}
+		std::ofstream resultFile(resultFilePath, std::ios::app);
+		if (!resultFile.is_open())
+			throw Exception("Unable to open result file " + resultFilePath + ".");
+		if (!endsWithNewline)
+			resultFile << '\n';
+		std::mutex resultMutex;
+		const auto runPendingPoint = [&](size_t i)
+		{
+			const size_t p = pendingPoints[i];
+			size_t pointPlanCompilations = 0;
+			SweepPointResult result = runPoint(pendingElements[i], specification, observedFields, pendingPointHashes[i], pointPlanCompilations);
+			result.values = points[p];
+			const std::string line = resultToJson(result, specification).dump();
+
+			// written as soon as it is known, so an interrupted sweep keeps every finished point
+			const std::lock_guard<std::mutex> lock(resultMutex);
+			resultFile << line << std::endl;
+			numberOfPlanCompilations += pointPlanCompilations;
+			cache[result.hash] = result;
+			cache[result.hash].cached = true;
+			results[p] = std::move(result);
+		};
+
+		numberOfPlanCompilations = 0;
+		const auto start = std::chrono::steady_clock::now();
+		int numberOfThreads = 1;
+		if (numberOfWorkers != 1 && pendingPoints.size() > 1)
+		{
+			tools::threading::ThreadPool threadPool(numberOfWorkers);
+			numberOfThreads = threadPool.getNumberOfThreads();
+			threadPool.parallelFor(pendingPoints.size(), runPendingPoint);
+		}
+		else
+			for (size_t i = 0; i < pendingPoints.size(); ++i)
+				runPendingPoint(i);
+		const double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		for (const auto& [p, hash] : repeatedPoints)
+		{
+			results[p] = results[pendingHashes.at(hash)];
+			results[p].values = points[p];
+		}
+
+		std::ostringstream oss;
+		oss << "Parameter sweep of " << points.size() << " points: " << points.size() - pendingPoints.size() - repeatedPoints.size()
+			<< " read from " << resultFilePath << ", " << pendingPoints.size() << " run in " << std::fixed << std::setprecision(3)
+			<< wallTime << "s using " << numberOfThreads << " thread(s).";
+		log(tools::logger::LogLevel::INFO, oss.str());
+		return results;
+	}
+
+	void ParameterSweep::setNumberOfWorkers(int numberOfWorkers)
+	{
+		if (numberOfWorkers < 0)
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+		this->numberOfWorkers = numberOfWorkers;
+	}
+
+	std::vector<std::vector<double>> ParameterSweep::getPoints() const
+	{
+		const auto& parameters = specification.parameters;
+		std::vector<std::vector<double>> points;
+		if (parameters.empty())
+			return { {} };
+
+		if (specification.mode == SweepMode::LIST)
+		{
+			for (size_t p = 0; p < parameters.front().values.size(); ++p)
+			{
+				std::vector<double> point;
+				for (const SweepParameter& parameter : parameters)
+					point.push_back(parameter.values[p]);
+				points.push_back(std::move(point));
+			}
+			return points;
+		}
+
+		// counts through the grid like an odometer, the last parameter turning fastest
+		std::vector<size_t> indices(parameters.size(), 0);
+		while (true)
+		{
+			std::vector<double> point;
+			for (size_t i = 0; i < parameters.size(); ++i)
+				point.push_back(parameters[i].values[indices[i]]);
+			points.push_back(std::move(point));
+
+			size_t i = parameters.size();
+			while (i > 0 && ++indices[i - 1] == parameters[i - 1].values.size())
+				indices[--i] = 0;
+			if (i == 0)
+				return points;
+		}
+	}
+
+	SweepSpecification ParameterSweep::readSpecification(const std::string& filePath)
+	{
+		const json specificationJson = readJsonFile(filePath, "sweep specification");
+		SweepSpecification specification;
+		try
+		{
+			specification.deltaT = specificationJson.value("deltaT", specification.deltaT);
+			specification.runTime = specificationJson.value("runTime", specification.runTime);
+			specification.seed = specificationJson.value("seed", specification.seed);
+			specification.observedFields = specificationJson.value("observedFields", specification.observedFields);
+			if (specificationJson.value("mode", std::string("grid")) == "list")
+				specification.mode = SweepMode::LIST;
+
+			for (const json& parameterJson : specificationJson.at("parameters"))
+			{
+				SweepParameter parameter{ parameterJson.at("element"), parameterJson.at("parameter"), {} };
+				if (parameterJson.contains("values"))
+					parameter.values = parameterJson.at("values").get<std::vector<double>>();
+				else
+				{
+					const double from = parameterJson.at("from");
+					const double to = parameterJson.at("to");
+					const double step = parameterJson.at("step");
+					if (step <= 0)
+						throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+					// counted rather than accumulated, and with some slack, so the last value is not lost to rounding
+					for (int i = 0; from + i * step <= to + step * 1e-9; ++i)
+						parameter.values.push_back(from + i * step);
+				}
+				specification.parameters.push_back(std::move(parameter));
+			}
+		}
+		catch (const json::exception& ex)
+		{
+			throw Exception("Unable to read sweep specification " + filePath + ": " + ex.what());
+		}
+		return specification;
+	}
+
+	void ParameterSweep::readCache()
+	{
+		std::ifstream file(resultFilePath);
+		if (!file.is_open())
+			return;
+
+		// a line may be cut short by an interrupted sweep, it is run again
+		size_t numberOfSkippedLines = 0;
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty())
+				continue;
+			const json resultJson = json::parse(line, nullptr, false);
+			try
+			{
+				if (resultJson.is_discarded())
+					throw Exception("Malformed sweep result.");
+				SweepPointResult result = resultFromJson(resultJson);
+				cache[result.hash] = std::move(result);
+			}
+			catch (const std::exception&)
+			{
+				numberOfSkippedLines++;
+			}
+		}
+		if (numberOfSkippedLines > 0)
+			log(tools::logger::LogLevel::WARNING, "Skipped " + std::to_string(numberOfSkippedLines) + " unreadable lines of " + resultFilePath + ".");
+	}
+}
@@ -5,6 +5,22 @@
 #include "simulation/simulation.h"
 #include "simulation/simulation_file_manager.h"
 
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+
+#include "tools/profiling.h"
+#include "elements/neural_field.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/gauss_kernel.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/oscillatory_kernel.h"
+#include "elements/asymmetric_gauss_kernel.h"
+#include "elements/normal_noise.h"
+#include "elements/field_coupling.h"
+#include "elements/gauss_field_coupling.h"
+
 
 
 namespace dnf_composer
@@ -15,7 +31,11 @@ namespace dnf_composer
 	}
 
 	Simulation::Simulation(const std::string& identifier, double deltaT, double tZero, double t)
-		: uniqueIdentifier(identifier), deltaT(deltaT), tZero(tZero), t(t)
+		: executionMode(ExecutionMode::SERIAL), numberOfWorkers(0), measuringBusyTime(false), busyTimeNanoseconds(0),
+			seed(std::random_device{}()), adaptiveStepping(false), currentDeltaT(deltaT), stepCount(0),
+			applyingStepPeriods(true), integrationStages(1), quiescenceSkipping(false), quiescenceTolerance(1e-6), elementStepCount(0),
+			skippedElementStepCount(0), optimizingGraph(false), optimizedParameterRevision(0), uniqueIdentifier(identifier),
+			deltaT(deltaT), tZero(tZero), t(t)
 	{
 		if (deltaT <= 0 || tZero > t)
 			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
@@ -24,6 +44,7 @@ namespace dnf_composer
 			generateUniqueIdentifier();
 		initialized = false;
 		paused = false;
+		doubleBuffered = false;
 		elements = {};
 		std::ostringstream oss;
 		oss << "Simulation '" << uniqueIdentifier << "' created. "
@@ -35,6 +56,24 @@ namespace dnf_composer
 	Simulation::Simulation(const Simulation& other)
 		:	initialized(other.initialized),
 			paused(other.paused),
+			doubleBuffered(other.doubleBuffered),
+			executionMode(other.executionMode),
+			numberOfWorkers(other.numberOfWorkers),
+			measuringBusyTime(false),
+			busyTimeNanoseconds(0),
+			seed(other.seed),
+			adaptiveStepping(other.adaptiveStepping),
+			adaptiveSteppingParameters(other.adaptiveSteppingParameters),
+			currentDeltaT(other.deltaT),
+			stepCount(other.stepCount),
+			applyingStepPeriods(true),
+			integrationStages(1),
+			quiescenceSkipping(other.quiescenceSkipping),
+			quiescenceTolerance(other.quiescenceTolerance),
+			elementStepCount(0),
+			skippedElementStepCount(0),
+			optimizingGraph(other.optimizingGraph),
+			optimizedParameterRevision(0),
 			uniqueIdentifier(other.uniqueIdentifier), 
 			deltaT(other.deltaT),
 			tZero(other.tZero),
@@ -46,6 +85,8 @@ namespace dnf_composer
 			[](const std::shared_ptr<element::Element>& originalElem) -> std::shared_ptr<element::Element> {
 				return originalElem->clone(); // This line assumes that Element has a clone() method
 			});
+		// the clones still point at the pool of the copied simulation
+		distributeThreadPool();
 	}
 
 	Simulation& Simulation::operator=(const Simulation& other)
@@ -56,15 +97,30 @@ namespace dnf_composer
 		// Copy simple and built-in type members
 		initialized = other.initialized;
 		paused = other.paused;
+		doubleBuffered = other.doubleBuffered;
 		uniqueIdentifier = other.uniqueIdentifier; // Make unique if necessary
+		seed = other.seed;
+		adaptiveStepping = other.adaptiveStepping;
+		adaptiveSteppingParameters = other.adaptiveSteppingParameters;
+		stepCount = other.stepCount;
+		quiescenceSkipping = other.quiescenceSkipping;
+		quiescenceTolerance = other.quiescenceTolerance;
+		optimizingGraph = other.optimizingGraph;
+		executionMode = other.executionMode;
+		if (numberOfWorkers != other.numberOfWorkers)
+			threadPool.reset();
+		numberOfWorkers = other.numberOfWorkers;
 		deltaT = other.deltaT;
 		tZero = other.tZero;
 		t = other.t;
 
 		// Clear the current elements and deep copy from other
+		graphOptimizer.revert(elements);
 		elements.clear();
 		for (const auto& elem : other.elements)
 			elements.push_back(elem->clone());
+		executionPlan.invalidate();
+		distributeThreadPool();
 
 		return *this;
 	}
@@ -72,7 +128,27 @@ namespace dnf_composer
 	Simulation::Simulation(Simulation&& other) noexcept
 		: initialized(other.initialized), // Transfer basic types
 		paused(other.paused),
+		doubleBuffered(other.doubleBuffered),
 		elements(std::move(other.elements)), // Use std::move for vector and other container types
+		executionMode(other.executionMode),
+		numberOfWorkers(other.numberOfWorkers),
+		threadPool(std::move(other.threadPool)),
+		measuringBusyTime(false),
+		busyTimeNanoseconds(0),
+		seed(other.seed),
+		adaptiveStepping(other.adaptiveStepping),
+		adaptiveSteppingParameters(other.adaptiveSteppingParameters),
+		currentDeltaT(other.deltaT),
+		stepCount(other.stepCount),
+		applyingStepPeriods(true),
+		integrationStages(1),
+		quiescenceSkipping(other.quiescenceSkipping),
+		quiescenceTolerance(other.quiescenceTolerance),
+		elementStepCount(0),
+		skippedElementStepCount(0),
+		optimizingGraph(other.optimizingGraph),
+		graphOptimizer(std::move(other.graphOptimizer)),
+		optimizedParameterRevision(other.optimizedParameterRevision),
 		uniqueIdentifier(std::move(other.uniqueIdentifier)), // std::move for std::string and similar
 		deltaT(other.deltaT),
 		tZero(other.tZero),
@@ -98,7 +174,21 @@ namespace dnf_composer
 		// Transfer basic types and resources
 		initialized = other.initialized;
 		paused = other.paused;
+		doubleBuffered = other.doubleBuffered;
+		graphOptimizer.revert(elements);
 		elements = std::move(other.elements); // Transfer ownership of vector
+		executionPlan.invalidate();
+		executionMode = other.executionMode;
+		numberOfWorkers = other.numberOfWorkers;
+		threadPool = std::move(other.threadPool);
+		seed = other.seed;
+		adaptiveStepping = other.adaptiveStepping;
+		adaptiveSteppingParameters = other.adaptiveSteppingParameters;
+		stepCount = other.stepCount;
+		quiescenceSkipping = other.quiescenceSkipping;
+		quiescenceTolerance = other.quiescenceTolerance;
+		optimizingGraph = other.optimizingGraph;
+		graphOptimizer = std::move(other.graphOptimizer);
 		uniqueIdentifier = std::move(other.uniqueIdentifier); // Transfer ownership of string
 		deltaT = other.deltaT;
 		tZero = other.tZero;
@@ -121,20 +211,352 @@ namespace dnf_composer
 	{
 		paused = false;
 		t = tZero;
+		stepCount = 0;
 		for (const auto& element : elements)
+		{
+			element->getStepRecord() = {};
+			element->setRandomSeed(seed);
 			element->init();
+			element->setDoubleBuffered(doubleBuffered);
+		}
+		compileExecutionPlan();
+		allocateComponentArena();
+		// the pool is created up front, so the first step does not allocate it
+		if (executionMode == ExecutionMode::PARALLEL_LEVELS && !threadPool)
+		{
+			threadPool = std::make_unique<tools::threading::ThreadPool>(numberOfWorkers);
+			distributeThreadPool();
+		}
 
 		initialized = true;
-		tools::logger::log(tools::logger::LogLevel::INFO, "Simulation initialized.");
+		tools::logger::log(tools::logger::LogLevel::INFO, "Simulation initialized with seed " + std::to_string(seed) + ".");
 	}
 
 	void Simulation::step()
 	{
 		if (paused)
 			return;
+		if (!isExecutionPlanUpToDate())
+			compileExecutionPlan();
+
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+		// once the plan is compiled and the buffers are in place a step must not touch the heap
+		const std::uint64_t parameterRevision = getParameterRevision();
+		const bool steadyState = initialized && (executionMode != ExecutionMode::PARALLEL_LEVELS || threadPool) &&
+			parameterRevision == steppedParameterRevision;
+		steppedParameterRevision = parameterRevision;
+		const size_t allocationsBeforeStep = getStepAllocationCount();
+#endif
+
 		t += deltaT;
-		for (const auto& element : elements)
-			element->step(t, deltaT);
+		currentDeltaT = deltaT;
+		stepElements();
+		stepCount++;
+
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+		const size_t allocationsDuringStep = getStepAllocationCount() - allocationsBeforeStep;
+		if (steadyState)
+			steadyStateStepAllocations += allocationsDuringStep;
+		if (steadyState && allocationsDuringStep != 0)
+		{
+			tools::logger::log(tools::logger::LogLevel::ERROR, "Simulation step at t = " + std::to_string(t) +
+				" made " + std::to_string(allocationsDuringStep) + " heap allocations.");
+			assert(allocationsDuringStep == 0 && "the steady-state simulation step must not allocate");
+		}
+#endif
+	}
+
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+	size_t Simulation::getStepAllocationCount() const
+	{
+		// the steps run on the calling thread and on the workers of the pool of this simulation only
+		size_t count = tools::profiling::getAllocationCount();
+		if (threadPool)
+			count += threadPool->getWorkerAllocationCount();
+		return count;
+	}
+
+	size_t Simulation::getSteadyStateStepAllocations() const
+	{
+		return steadyStateStepAllocations;
+	}
+#endif
+
+	void Simulation::stepElements()
+	{
+		integrationStages = getIntegrationStages();
+		if (integrationStages == 1)
+		{
+			sweepElements(SweepPass::ALL);
+			return;
+		}
+
+		// a multi-stage integrator takes the step in several sweeps, in each of them every other element is evaluated
+		// at the state the neural fields reached in the sweep before, and only then are the fields advanced, so every
+		// field sees the inputs of the same state, also those computed from the other fields
+		for (int stage = 0; stage < integrationStages; stage++)
+		{
+			beginIntegrationStage(stage);
+			sweepElements(SweepPass::INPUTS);
+			sweepElements(SweepPass::NEURAL_FIELDS);
+		}
+		beginIntegrationStage(0);
+	}
+
+	int Simulation::getIntegrationStages() const
+	{
+		int stages = 1;
+		for (const element::Element* element : executionPlan.getOrderedElements())
+		{
+			if (element->getLabel() != element::ElementLabel::NEURAL_FIELD)
+				continue;
+			const int fieldStages = static_cast<const element::NeuralField*>(element)->getIntegrationStages();
+			if (fieldStages > 1 && doubleBuffered)
+			{
+				log(tools::logger::LogLevel::ERROR, "Neural field '" + element->getUniqueName() + "' is integrated in " +
+					std::to_string(fieldStages) + " stages, whose inputs double buffering would delay by a stage.");
+				throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+			}
+			stages = std::max(stages, fieldStages);
+		}
+		return stages;
+	}
+
+	void Simulation::beginIntegrationStage(int stage)
+	{
+		for (element::Element* element : executionPlan.getOrderedElements())
+			element->getStepRecord().stage = stage;
+		for (const auto& sum : sharedInputSums)
+			sum->invalidate();
+	}
+
+	bool Simulation::isInSweepPass(const element::Element* element, SweepPass pass)
+	{
+		return pass == SweepPass::ALL || (element->getLabel() == element::ElementLabel::NEURAL_FIELD) == (pass == SweepPass::NEURAL_FIELDS);
+	}
+
+	bool Simulation::isInSweepPass(const element::ElementBatch& batch, SweepPass pass)
+	{
+		return pass == SweepPass::ALL || std::holds_alternative<std::vector<element::NeuralField*>>(batch) == (pass == SweepPass::NEURAL_FIELDS);
+	}
+
+	void Simulation::sweepElements(SweepPass pass)
+	{
+		const auto& orderedElements = executionPlan.getOrderedElements();
+		for (const auto& sum : sharedInputSums)
+			sum->invalidate();
+
+		if (executionMode == ExecutionMode::SERIAL)
+		{
+			// the state written during the last step becomes the state every element reads during this one
+			if (doubleBuffered)
+				for (element::Element* element : orderedElements)
+					publishElement(element);
+			for (element::Element* element : orderedElements)
+				if (isInSweepPass(element, pass))
+					stepElement(element);
+			return;
+		}
+
+		if (executionMode == ExecutionMode::TYPE_SORTED)
+		{
+			if (doubleBuffered)
+				for (element::Element* element : orderedElements)
+					publishElement(element);
+			for (const element::ElementBatch& batch : executionPlan.getBatches())
+				if (isInSweepPass(batch, pass))
+					stepBatch(batch);
+			return;
+		}
+
+		if (!threadPool)
+		{
+			threadPool = std::make_unique<tools::threading::ThreadPool>(numberOfWorkers);
+			distributeThreadPool();
+		}
+
+		// elements only read published state, so once it is published they can all be stepped at once
+		if (doubleBuffered)
+		{
+			threadPool->parallelFor(orderedElements.size(), [this, &orderedElements](size_t i) { publishElement(orderedElements[i]); });
+			threadPool->parallelFor(orderedElements.size(), [this, &orderedElements](size_t i) { stepElement(orderedElements[i]); });
+			return;
+		}
+
+		// the pool returns once the whole level is stepped, so every level sees the finished outputs of the previous ones
+		for (const auto& level : executionPlan.getLevels())
+			threadPool->parallelFor(level.size(), [this, &level, pass](size_t i)
+			{
+				if (isInSweepPass(level[i], pass))
+					stepElement(level[i]);
+			});
+	}
+
+	void Simulation::beginEnsembleStep()
+	{
+		t += deltaT;
+		currentDeltaT = deltaT;
+		integrationStages = getIntegrationStages();
+		for (const auto& sum : sharedInputSums)
+			sum->invalidate();
+		if (doubleBuffered)
+			for (element::Element* element : executionPlan.getOrderedElements())
+				publishElement(element);
+	}
+
+	void Simulation::endEnsembleStep()
+	{
+		stepCount++;
+	}
+
+	template <typename ConcreteElement>
+	void Simulation::stepElement(ConcreteElement* element)
+	{
+		double elementDeltaT;
+		if (!isElementStepped(element, elementDeltaT))
+			return;
+
+		// a qualified call is not dispatched through the virtual table
+		const auto stepConcreteElement = [this, element, elementDeltaT]
+		{
+			if constexpr (std::is_same_v<ConcreteElement, element::Element>)
+				element->step(t, elementDeltaT);
+			else
+				element->ConcreteElement::step(t, elementDeltaT);
+		};
+		if (!measuringBusyTime)
+			stepConcreteElement();
+		else
+		{
+			const auto start = std::chrono::steady_clock::now();
+			stepConcreteElement();
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			busyTimeNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+		}
+
+		recordStep(element);
+	}
+
+	void Simulation::stepBatch(const element::ElementBatch& batch)
+	{
+		std::visit([this](const auto& batchElements)
+		{
+			if constexpr (std::is_same_v<std::decay_t<decltype(batchElements)>, std::vector<element::NeuralField*>>)
+				stepFieldBatch(batchElements);
+			else
+				for (auto* element : batchElements)
+					stepElement(element);
+		}, batch);
+	}
+
+	void Simulation::stepFieldBatch(const std::vector<element::NeuralField*>& fields)
+	{
+		fieldBatch.clear();
+		for (element::NeuralField* field : fields)
+		{
+			double elementDeltaT;
+			if (isElementStepped(field, elementDeltaT))
+				fieldBatch.add(field, elementDeltaT);
+		}
+
+		if (!measuringBusyTime)
+			fieldBatch.step(t);
+		else
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fieldBatch.step(t);
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			busyTimeNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+		}
+
+		for (element::NeuralField* field : fieldBatch.getFields())
+			recordStep(field);
+	}
+
+	bool Simulation::isElementStepped(element::Element* element, double& elementDeltaT)
+	{
+		// the later stages of a step step again the elements stepped in its first one, and only those
+		if (element->getStepRecord().stage > 0)
+		{
+			if (element->getStepRecord().lastStep != static_cast<std::int64_t>(stepCount))
+				return false;
+		}
+		else
+		{
+			if (!isElementDue(element, stepCount))
+			{
+				element->keepPublishedComponents();
+				return false;
+			}
+			if (quiescenceSkipping && applyingStepPeriods)
+			{
+				elementStepCount.fetch_add(1, std::memory_order_relaxed);
+				if (isElementQuiescent(element))
+				{
+					skippedElementStepCount.fetch_add(1, std::memory_order_relaxed);
+					// published before it was known to be held, the swap left the values of the step before in the element
+					element->keepPublishedComponents();
+					return false;
+				}
+			}
+		}
+		// an element stepped every k-th step covers k steps at once
+		elementDeltaT = applyingStepPeriods ? currentDeltaT * element->getStepPeriod() : currentDeltaT;
+		return true;
+	}
+
+	bool Simulation::isElementQuiescent(const element::Element* element) const
+	{
+		const element::StepRecord& record = element->getStepRecord();
+		// the element must have settled in its last step, and nothing it reads may have changed since
+		if (!element->canHoldOutputs() || record.lastChange >= record.lastStep)
+			return false;
+		return !element->haveInputsChangedSince(record.lastStep, doubleBuffered);
+	}
+
+	void Simulation::recordStep(element::Element* element) const
+	{
+		element::StepRecord& record = element->getStepRecord();
+		const auto step = static_cast<std::int64_t>(stepCount);
+		record.lastStep = step;
+		if (!quiescenceSkipping || !element->canHoldOutputs())
+		{
+			record.lastChange = step;
+			return;
+		}
+
+		// compared with the state at the last change, so a slow drift adds up until it counts as a change,
+		// a woken element counts as changed in any case
+		const element::Component& state = element->getComponents()->at(element->getStateSlot());
+		bool changed = record.lastChange > step || record.reference.size() != state.size();
+		for (size_t i = 0; i < state.size() && !changed; i++)
+			changed = std::abs(state[i] - record.reference[i]) > quiescenceTolerance;
+		if (changed)
+		{
+			record.reference.assign(state.begin(), state.end());
+			record.lastChange = step;
+		}
+	}
+
+	void Simulation::publishElement(element::Element* element) const
+	{
+		// what an element wrote in its last step is published once, the step after it, publishing it again
+		// would swap the published buffers back to older values while the element is not stepped
+		element::StepRecord& record = element->getStepRecord();
+		// a static element computes its outputs when given new parameters rather than in a step
+		const bool changedOutsideStep = element->isStatic() && record.lastChange > record.lastStep &&
+			record.publishedLastChange != record.lastChange;
+		if (!applyingStepPeriods || record.lastStep == static_cast<std::int64_t>(stepCount) - 1 || changedOutsideStep)
+			element->publishComponents(isElementDue(element, stepCount));
+		record.publishedLastChange = record.lastChange;
+	}
+
+	bool Simulation::isElementDue(const element::Element* element, std::uint64_t step) const
+	{
+		if (!applyingStepPeriods)
+			return true;
+		const int stepPeriod = element->getStepPeriod();
+		return stepPeriod == 1 || step % static_cast<std::uint64_t>(stepPeriod) == 0;
 	}
 
 	void Simulation::close()
@@ -160,7 +582,9 @@ namespace dnf_composer
 
 	void Simulation::clean()
 	{
+		graphOptimizer.revert(elements);
 		elements.clear();
+		executionPlan.invalidate();
 		initialized = false;
 		paused = false;
 		t = tZero;
@@ -191,13 +615,181 @@ namespace dnf_composer
 
 		if (!initialized)
 			init();
-
-		while (t < simTime)
-			step();
+		// adaptive stepping steps every element every time
+		if (adaptiveStepping)
+			for (const auto& element : elements)
+				if (element->getStepPeriod() != 1)
+				{
+					log(tools::logger::LogLevel::ERROR, "Adaptive stepping cannot step element '" + element->getUniqueName() +
+						"' with a step period of " + std::to_string(element->getStepPeriod()) + ".");
+					throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+				}
+
+		measuringBusyTime = true;
+		busyTimeNanoseconds = 0;
+		stepStatistics = {};
+		elementStepCount = 0;
+		skippedElementStepCount = 0;
+		const double startTime = t;
+		const auto start = std::chrono::steady_clock::now();
+		if (adaptiveStepping)
+			runAdaptive(simTime);
+		else
+		{
+			while (t < simTime)
+			{
+				step();
+				stepStatistics.acceptedSteps++;
+				stepStatistics.elementSweeps += static_cast<size_t>(integrationStages);
+			}
+			stepStatistics.smallestDeltaT = deltaT;
+			stepStatistics.largestDeltaT = deltaT;
+		}
+		const double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		measuringBusyTime = false;
+		if (stepStatistics.elementSweeps > 0)
+			stepStatistics.speedup = (t - startTime) / deltaT / static_cast<double>(stepStatistics.elementSweeps);
+		stepStatistics.elementSteps = elementStepCount.load();
+		stepStatistics.skippedElementSteps = skippedElementStepCount.load();
+		const size_t numberOfSteps = stepStatistics.acceptedSteps;
+
+		// speedup is the time the elements were busy over the elapsed time,
+		// i.e. how many workers were stepping elements on average
+		const double busyTime = static_cast<double>(busyTimeNanoseconds.load()) * 1e-9;
+		const int workers = executionMode == ExecutionMode::PARALLEL_LEVELS ? getNumberOfWorkers() : 1;
+		const double speedup = wallTime > 0 ? busyTime / wallTime : 0;
+		std::ostringstream oss;
+		oss << "Simulation ran " << numberOfSteps << " steps in " << std::fixed << std::setprecision(3) << wallTime << "s ("
+			<< std::setprecision(1) << (wallTime > 0 ? numberOfSteps / wallTime : 0) << " steps/s) using " << workers << " worker(s). "
+			<< "Speedup " << std::setprecision(2) << speedup << ", efficiency " << std::setprecision(1) << 100 * speedup / workers << "%.";
+		log(tools::logger::LogLevel::INFO, oss.str());
+		if (adaptiveStepping)
+		{
+			std::ostringstream adaptiveOss;
+			adaptiveOss << "Adaptive stepping accepted " << stepStatistics.acceptedSteps << " and rejected " << stepStatistics.rejectedSteps
+				<< " steps of " << std::setprecision(3) << stepStatistics.smallestDeltaT << "s to " << stepStatistics.largestDeltaT << "s, "
+				<< stepStatistics.elementSweeps << " sweeps instead of " << std::setprecision(0) << (t - startTime) / deltaT
+				<< " (speedup " << std::setprecision(2) << stepStatistics.speedup << ").";
+			log(tools::logger::LogLevel::INFO, adaptiveOss.str());
+		}
+		if (quiescenceSkipping && stepStatistics.elementSteps > 0)
+		{
+			std::ostringstream quiescenceOss;
+			quiescenceOss << "Quiescence skipping skipped " << stepStatistics.skippedElementSteps << " of " << stepStatistics.elementSteps
+				<< " element steps (" << std::fixed << std::setprecision(1)
+				<< 100.0 * static_cast<double>(stepStatistics.skippedElementSteps) / static_cast<double>(stepStatistics.elementSteps) << "%).";
+			log(tools::logger::LogLevel::INFO, quiescenceOss.str());
+		}
 
 		close();
 	}
 
+	void Simulation::runAdaptive(double endTime)
+	{
+		if (!isExecutionPlanUpToDate())
+			compileExecutionPlan();
+		if (executionMode == ExecutionMode::PARALLEL_LEVELS && !threadPool)
+		{
+			threadPool = std::make_unique<tools::threading::ThreadPool>(numberOfWorkers);
+			distributeThreadPool();
+		}
+
+		// the error estimate compares the same elements over the same interval, so all of them are stepped every time
+		applyingStepPeriods = false;
+		const double minimumDeltaT = adaptiveSteppingParameters.minimumDeltaT > 0 ? adaptiveSteppingParameters.minimumDeltaT : deltaT / 16;
+		const double maximumDeltaT = adaptiveSteppingParameters.maximumDeltaT > 0 ? adaptiveSteppingParameters.maximumDeltaT
+			: std::max(deltaT * 16, minimumDeltaT);
+		const double tolerance = adaptiveSteppingParameters.tolerance;
+
+		// the error is measured on the activation of the neural fields, the state the simulation integrates
+		errorComponents.clear();
+		for (const auto& element : elements)
+			if (element->getLabel() == element::ElementLabel::NEURAL_FIELD)
+				errorComponents.push_back(element->getComponentPtr("activation"));
+		wholeStepActivations.resize(errorComponents.size());
+		savedStates.resize(elements.size());
+
+		stepStatistics.smallestDeltaT = maximumDeltaT;
+		stepStatistics.largestDeltaT = 0;
+		double stepSize = std::clamp(deltaT, minimumDeltaT, maximumDeltaT);
+		// what is left once the steps have added up to the end time is rounding
+		while (endTime - t > 1e-9 * deltaT)
+		{
+			const double startTime = t;
+			// the last step ends exactly at the end of the run
+			const bool lastStep = stepSize >= endTime - t;
+			const double size = lastStep ? endTime - t : stepSize;
+			const double error = attemptStep(size);
+
+			// the local error of the field dynamics grows with the square of the step size
+			const double factor = error > 0 ? std::clamp(0.9 * std::sqrt(tolerance / error), 0.2, 2.0) : 2.0;
+			if (error <= tolerance || size <= minimumDeltaT)
+			{
+				stepCount++;
+				stepStatistics.acceptedSteps++;
+				stepStatistics.smallestDeltaT = std::min(stepStatistics.smallestDeltaT, size);
+				stepStatistics.largestDeltaT = std::max(stepStatistics.largestDeltaT, size);
+				if (lastStep)
+					t = endTime;
+				else
+					stepSize = std::clamp(size * factor, minimumDeltaT, maximumDeltaT);
+				continue;
+			}
+
+			stepStatistics.rejectedSteps++;
+			restoreStates();
+			t = startTime;
+			stepSize = std::clamp(size * std::min(factor, 0.5), minimumDeltaT, maximumDeltaT);
+		}
+		currentDeltaT = deltaT;
+		applyingStepPeriods = true;
+	}
+
+	double Simulation::attemptStep(double stepSize)
+	{
+		const double startTime = t;
+		saveStates();
+
+		// once whole
+		currentDeltaT = stepSize;
+		t = startTime + stepSize;
+		stepElements();
+		for (size_t i = 0; i < errorComponents.size(); i++)
+			wholeStepActivations[i].assign(errorComponents[i]->begin(), errorComponents[i]->end());
+		restoreStates();
+
+		// and as two halves, which are kept if the step is accepted
+		currentDeltaT = stepSize / 2;
+		t = startTime + stepSize / 2;
+		stepElements();
+		t = startTime + stepSize;
+		stepElements();
+		stepStatistics.elementSweeps += 3 * static_cast<size_t>(integrationStages);
+
+		double error = 0;
+		for (size_t i = 0; i < errorComponents.size(); i++)
+		{
+			const element::Component& halfStepActivation = *errorComponents[i];
+			const std::vector<double>& wholeStepActivation = wholeStepActivations[i];
+			for (size_t j = 0; j < halfStepActivation.size(); j++)
+				error = std::max(error, std::abs(halfStepActivation[j] - wholeStepActivation[j]));
+		}
+		// a diverged step must be rejected
+		return std::isfinite(error) ? error : std::numeric_limits<double>::infinity();
+	}
+
+	void Simulation::saveStates()
+	{
+		for (size_t i = 0; i < elements.size(); i++)
+			elements[i]->saveState(savedStates[i]);
+	}
+
+	void Simulation::restoreStates()
+	{
+		for (size_t i = 0; i < elements.size(); i++)
+			elements[i]->restoreState(savedStates[i]);
+	}
+
 	void Simulation::addElement(const std::shared_ptr<element::Element>& element)
 	{
 		// Check if an element with the same id already exists
@@ -212,6 +804,9 @@ namespace dnf_composer
 		}
 
 		elements.emplace_back(element);
+		element->setDoubleBuffered(doubleBuffered);
+		element->setRandomSeed(seed);
+		executionPlan.invalidate();
 
 		const std::string logMessage = "Element '" + newElementName + "' was added to the simulation.";
 		log(tools::logger::LogLevel::INFO, logMessage);
@@ -226,7 +821,12 @@ namespace dnf_composer
 		{
 			if (elements[i]->getUniqueName() == elementId)
 			{
+				// the element may outlive the simulation, so it must not keep pointing at its pool
+				elements[i]->setThreadPool(nullptr);
+				elements[i]->setSharedInputSum(nullptr);
+				GraphOptimizer::revert(*elements[i]);
 				elements.erase(elements.begin() + i);
+				executionPlan.invalidate();
 				const std::string logMessage = "Element '" + elementId + "' was removed from the simulation.";
 				log(tools::logger::LogLevel::INFO, logMessage);
 				return;
@@ -244,8 +844,14 @@ namespace dnf_composer
 		{
 			if (element->getUniqueName() == idOfElementToReset) 
 			{
+				element->setThreadPool(nullptr);
+				element->setSharedInputSum(nullptr);
+				GraphOptimizer::revert(*element);
 				element = newElement;
+				element->setRandomSeed(seed);
 				element->init();
+				element->setDoubleBuffered(doubleBuffered);
+				executionPlan.invalidate();
 				const std::string logMessage = "Element '" + idOfElementToReset + "' was reset in the simulation.";
 				log(tools::logger::LogLevel::INFO, logMessage);
 				elementFound = true;
@@ -330,7 +936,7 @@ namespace dnf_composer
 		return foundElement->getComponent(componentName);
 	}
 
-	std::vector<double>* Simulation::getComponentPtr(const std::string& id, const std::string& componentName) const
+	element::Component* Simulation::getComponentPtr(const std::string& id, const std::string& componentName) const
 	{
 		const std::shared_ptr<element::Element> foundElement = getElement(id);
 		return foundElement->getComponentPtr(componentName);
@@ -399,6 +1005,151 @@ namespace dnf_composer
 		return initialized;
 	}
 
+	const ExecutionPlan& Simulation::getExecutionPlan() const
+	{
+		return executionPlan;
+	}
+
+	void Simulation::setSeed(std::uint64_t seed)
+	{
+		this->seed = seed;
+		for (const auto& element : elements)
+			element->setRandomSeed(seed);
+	}
+
+	void Simulation::setAdaptiveStepping(bool adaptive)
+	{
+		if (adaptive && quiescenceSkipping)
+		{
+			log(tools::logger::LogLevel::ERROR, "Adaptive stepping cannot be combined with quiescence skipping.");
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+		}
+
+		adaptiveStepping = adaptive;
+	}
+
+	void Simulation::setAdaptiveSteppingParameters(const AdaptiveSteppingParameters& parameters)
+	{
+		if (parameters.tolerance <= 0 || parameters.minimumDeltaT < 0 || parameters.maximumDeltaT < 0 ||
+			(parameters.maximumDeltaT > 0 && parameters.minimumDeltaT > parameters.maximumDeltaT))
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+
+		adaptiveSteppingParameters = parameters;
+	}
+
+	void Simulation::setQuiescenceSkipping(bool skipping)
+	{
+		if (skipping && adaptiveStepping)
+		{
+			log(tools::logger::LogLevel::ERROR, "Quiescence skipping cannot be combined with adaptive stepping.");
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+		}
+
+		quiescenceSkipping = skipping;
+	}
+
+	void Simulation::setQuiescenceTolerance(double tolerance)
+	{
+		if (tolerance < 0)
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+
+		quiescenceTolerance = tolerance;
+	}
+
+	void Simulation::setGraphOptimization(bool optimizing)
+	{
+		optimizingGraph = optimizing;
+		executionPlan.invalidate();
+	}
+
+	void Simulation::setExecutionMode(ExecutionMode mode)
+	{
+		executionMode = mode;
+		distributeThreadPool();
+	}
+
+	void Simulation::setNumberOfWorkers(int numberOfWorkers)
+	{
+		if (numberOfWorkers < 0)
+			throw Exception(ErrorCode::SIM_INVALID_PARAMETER);
+
+		if (this->numberOfWorkers != numberOfWorkers)
+		{
+			threadPool.reset();
+			distributeThreadPool();
+		}
+		this->numberOfWorkers = numberOfWorkers;
+	}
+
+	void Simulation::setDoubleBuffered(bool doubleBuffered)
+	{
+		this->doubleBuffered = doubleBuffered;
+		for (const auto& element : elements)
+			element->setDoubleBuffered(doubleBuffered);
+	}
+
+	const std::shared_ptr<tools::memory::Arena>& Simulation::getComponentArena() const
+	{
+		return componentArena;
+	}
+
+	ExecutionMode Simulation::getExecutionMode() const
+	{
+		return executionMode;
+	}
+
+	bool Simulation::isDoubleBuffered() const
+	{
+		return doubleBuffered;
+	}
+
+	std::uint64_t Simulation::getSeed() const
+	{
+		return seed;
+	}
+
+	bool Simulation::isQuiescenceSkipping() const
+	{
+		return quiescenceSkipping;
+	}
+
+	double Simulation::getQuiescenceTolerance() const
+	{
+		return quiescenceTolerance;
+	}
+
+	bool Simulation::isOptimizingGraph() const
+	{
+		return optimizingGraph;
+	}
+
+	const GraphOptimizationReport& Simulation::getGraphOptimizationReport() const
+	{
+		return graphOptimizer.getReport();
+	}
+
+	bool Simulation::isAdaptiveStepping() const
+	{
+		return adaptiveStepping;
+	}
+
+	AdaptiveSteppingParameters Simulation::getAdaptiveSteppingParameters() const
+	{
+		return adaptiveSteppingParameters;
+	}
+
+	const StepStatistics& Simulation::getStepStatistics() const
+	{
+		return stepStatistics;
+	}
+
+	int Simulation::getNumberOfWorkers() const
+	{
+		if (threadPool)
+			return threadPool->getNumberOfThreads();
+		return numberOfWorkers > 0 ? numberOfWorkers : tools::threading::ThreadPool::getHardwareConcurrency();
+	}
+
 	void Simulation::generateUniqueIdentifier()
 	{
 		const auto now = std::chrono::system_clock::now();
@@ -409,6 +1160,141 @@ namespace dnf_composer
 		uniqueIdentifier = oss.str();
 	}
 
+	void Simulation::compileExecutionPlan()
+	{
+		if (optimizingGraph)
+		{
+			const auto steppedElements = graphOptimizer.optimize(elements);
+			executionPlan.compile(steppedElements, getConnectionRevision(), graphOptimizer.getHeldElements());
+			optimizedParameterRevision = getParameterRevision();
+			log(tools::logger::LogLevel::INFO, graphOptimizer.getReport().toString());
+		}
+		else
+		{
+			graphOptimizer.revert(elements);
+			executionPlan.compile(elements, getConnectionRevision());
+		}
+		size_t largestFieldBatch = 0;
+		for (const element::ElementBatch& batch : executionPlan.getBatches())
+			if (const auto* fields = std::get_if<std::vector<element::NeuralField*>>(&batch))
+				largestFieldBatch = std::max(largestFieldBatch, fields->size());
+		fieldBatch.reserve(largestFieldBatch);
+		// elements added or replaced since the last compilation have not been handed the pool yet
+		distributeThreadPool();
+		shareInputSums();
+		// an element whose inputs changed must not keep holding the outputs it computed from the old ones,
+		// and reads them through the components they publish now
+		for (const auto& element : elements)
+		{
+			element->wake();
+			element->compileInputGather();
+		}
+	}
+
+	bool Simulation::isExecutionPlanUpToDate() const
+	{
+		// the optimized graph depends on the parameters of the elements as well, e.g. on whether a coupling learns
+		if (optimizingGraph && optimizedParameterRevision != getParameterRevision())
+			return false;
+		return executionPlan.isUpToDate(getConnectionRevision());
+	}
+
+	std::uint64_t Simulation::getConnectionRevision() const
+	{
+		std::uint64_t revision = 0;
+		for (const auto& element : elements)
+			revision += element->getConnectionRevision();
+		return revision;
+	}
+
+	std::uint64_t Simulation::getParameterRevision() const
+	{
+		std::uint64_t revision = 0;
+		for (const auto& element : elements)
+			revision += element->getParameterRevision();
+		return revision;
+	}
+
+	void Simulation::shareInputSums()
+	{
+		// elements that sum the same inputs share one sum, sized for the largest of their input components
+		std::map<std::vector<std::pair<const element::Element*, std::string>>, std::vector<element::Element*>> consumers;
+		for (element::Element* element : executionPlan.getOrderedElements())
+		{
+			element->setSharedInputSum(nullptr);
+			const auto inputs = element->getInputsAndComponents();
+			if (!element->isReadingInputView() || inputs.size() < 2)
+				continue;
+			std::vector<std::pair<const element::Element*, std::string>> key;
+			for (const auto& [input, inputComponent] : inputs)
+				key.emplace_back(input.get(), inputComponent);
+			std::ranges::sort(key);
+			consumers[std::move(key)].push_back(element);
+		}
+
+		sharedInputSums.clear();
+		size_t numberOfConsumers = 0;
+		for (const auto& [key, group] : consumers)
+		{
+			if (group.size() < 2)
+				continue;
+			size_t size = 0;
+			for (const element::Element* element : group)
+				size = std::max(size, element->getComponents()->at("input").size());
+			const auto sum = std::make_shared<element::SharedInputSum>(size, key.size());
+			for (element::Element* element : group)
+				element->setSharedInputSum(sum);
+			sharedInputSums.push_back(sum);
+			numberOfConsumers += group.size();
+		}
+		if (!sharedInputSums.empty())
+			log(tools::logger::LogLevel::INFO, std::to_string(sharedInputSums.size()) + " input sums are shared by " +
+				std::to_string(numberOfConsumers) + " elements.");
+	}
+
+	void Simulation::distributeThreadPool()
+	{
+		// in the parallel mode large elements split their own work over the pool, for instance a coupling
+		// that is alone in its level, calls made while a whole level is being stepped run on the calling worker
+		tools::threading::ThreadPool* pool = executionMode == ExecutionMode::PARALLEL_LEVELS ? threadPool.get() : nullptr;
+		for (const auto& element : elements)
+			element->setThreadPool(pool);
+	}
+
+	void Simulation::allocateComponentArena()
+	{
+		const auto& orderedElements = executionPlan.getOrderedElements();
+
+		size_t footprint = 0;
+		for (const element::Element* element : orderedElements)
+			footprint += element->getComponentFootprint();
+
+		// the components are moved in execution-plan order, so a step streams through the block
+		const auto arena = std::make_shared<tools::memory::Arena>(footprint);
+		// the components of the neural fields stepped together are placed slot by slot, so the rows of every slot form one matrix
+		for (const element::ElementBatch& batch : executionPlan.getBatches())
+		{
+			const auto* fields = std::get_if<std::vector<element::NeuralField*>>(&batch);
+			if (!fields)
+				continue;
+			for (const element::ComponentSlot slot : { element::ComponentSlot::ACTIVATION, element::ComponentSlot::INPUT,
+				element::ComponentSlot::OUTPUT, element::ComponentSlot::RESTING_LEVEL })
+				for (element::NeuralField* field : *fields)
+					field->relocateComponents(arena, slot);
+		}
+		std::ostringstream oss;
+		oss << "Component arena allocated with " << arena->getCapacity() << " bytes. Footprint per element [";
+		for (element::Element* element : orderedElements)
+		{
+			element->relocateComponents(arena);
+			oss << element->getUniqueName() << ": " << element->getComponentFootprint() << " bytes"
+				<< (element == orderedElements.back() ? "" : ", ");
+		}
+		oss << "].";
+		componentArena = arena;
+		log(tools::logger::LogLevel::INFO, oss.str());
+	}
+
 	void Simulation::exportComponentToFile(const std::string& id, const std::string& componentName) const
 	{
 		const std::shared_ptr<element::Element> foundElement = getElement(id);
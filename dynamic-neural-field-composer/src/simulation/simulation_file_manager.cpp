@@ -59,6 +59,11 @@ namespace dnf_composer
 
     }
 
+    void SimulationFileManager::loadElementsFromJson(const json& elementsJson) const
+    {
+        jsonToElements(elementsJson);
+    }
+
     json SimulationFileManager::elementToJson(const std::shared_ptr<element::Element>& element)
     {
         json elementJson;
@@ -71,6 +76,7 @@ namespace dnf_composer
         elementJson["label"] = { commonParams.identifiers.label, element::ElementLabelToString.at(commonParams.identifiers.label) };
         elementJson["x_max"] = commonParams.dimensionParameters.x_max;
         elementJson["d_x"] = commonParams.dimensionParameters.d_x;
+        elementJson["stepPeriod"] = commonParams.stepPeriod;
 
         // Add interactions to the JSON object
         const std::unordered_map<std::shared_ptr<element::Element>, std::string> inputs = element->getInputsAndComponents();
@@ -98,6 +104,7 @@ namespace dnf_composer
             const auto activationFunctionType = neuralFieldParameters.activationFunction->type;
             elementJson["tau"] = neuralFieldParameters.tau;
             elementJson["restingLevel"] = neuralFieldParameters.startingRestingLevel;
+            elementJson["integrator"] = element::IntegratorToString.at(neuralFieldParameters.integrator);
 
             switch (activationFunctionType) {
             case element::ActivationFunctionType::HEAVISIDE:
@@ -120,6 +127,8 @@ namespace dnf_composer
                         {"x_shift", sigmoidActivationFunction->getXShift()},
                         {"steepness", sigmoidActivationFunction->getSteepness()},
                     };
+                    if (sigmoidActivationFunction->getExpApproximation() == element::ExpApproximation::POLYNOMIAL)
+                        elementJson["activationFunction"]["exp"] = "polynomial";
                 }
             }
             break;
@@ -175,6 +184,7 @@ namespace dnf_composer
             elementJson["learningRate"] = fieldCouplingParameters.learningRate;
             elementJson["learningRule"] = fieldCouplingParameters.learningRule;
             elementJson["scalar"] = fieldCouplingParameters.scalar;
+            elementJson["learningPeriod"] = fieldCouplingParameters.learningPeriod;
             elementJson["input_x_max"] = fieldCouplingParameters.inputFieldDimensions.x_max;
             elementJson["input_d_x"] = fieldCouplingParameters.inputFieldDimensions.d_x;
         }
@@ -230,6 +240,21 @@ namespace dnf_composer
 		            // Parse specific parameters for neural field
 		            const double tau = elementJson["tau"];
 		            const double restingLevel = elementJson["restingLevel"];
+		            // files written before the integrator could be chosen use explicit Euler
+		            element::Integrator integrator = element::Integrator::EULER;
+		            if (elementJson.contains("integrator"))
+		            {
+		                bool isKnownIntegrator = false;
+		                for (const auto& [value, name] : element::IntegratorToString)
+		                    if (elementJson["integrator"] == name)
+		                    {
+		                        integrator = value;
+		                        isKnownIntegrator = true;
+		                    }
+		                if (!isKnownIntegrator)
+		                    log(tools::logger::WARNING, "Unknown integrator " + elementJson["integrator"].dump() +
+		                        " of element " + uniqueName + ", using Euler.");
+		            }
 
 		            // Check activation function type and parameters
 		            auto activationFunctionJson = elementJson["activationFunction"];
@@ -243,13 +268,16 @@ namespace dnf_composer
 		                else if (activationFunctionType == "sigmoid") {
 		                    double x_shift = activationFunctionJson["x_shift"];
 		                    double steepness = activationFunctionJson["steepness"];
-		                    activationFunction = std::make_unique<element::SigmoidFunction>(x_shift, steepness);
+		                    // files written before the exp could be approximated have no "exp" entry
+		                    const element::ExpApproximation expApproximation = activationFunctionJson.contains("exp") &&
+		                        activationFunctionJson["exp"] == "polynomial" ? element::ExpApproximation::POLYNOMIAL : element::ExpApproximation::EXACT;
+		                    activationFunction = std::make_unique<element::SigmoidFunction>(x_shift, steepness, expApproximation);
 		                }
 		            }
 		            // Reconstruct neural field element
 		            auto neuralField = std::make_shared<element::NeuralField>(
 		                element::ElementCommonParameters(uniqueName, element::ElementDimensions(x_max, d_x)),
-		                element::NeuralFieldParameters(tau, restingLevel, *activationFunction)
+		                element::NeuralFieldParameters(tau, restingLevel, *activationFunction, integrator)
 		            );
 		            // Add the reconstructed element to the simulation
 		            simulation->addElement(neuralField);
@@ -320,9 +348,10 @@ namespace dnf_composer
                 const double scalar = elementJson["scalar"];
                 const int input_x_max = elementJson["input_x_max"];
                 const double input_d_x = elementJson["input_d_x"];
+                const int learningPeriod = elementJson.contains("learningPeriod") ? static_cast<int>(elementJson["learningPeriod"]) : 1;
                 auto coupling = std::make_shared<element::FieldCoupling>(
                     element::ElementCommonParameters(uniqueName, element::ElementDimensions(x_max, d_x)),
-                    element::FieldCouplingParameters({input_x_max, input_d_x}, learningRule, scalar, learningRate)
+                    element::FieldCouplingParameters({input_x_max, input_d_x}, learningRule, scalar, learningRate, learningPeriod)
                 );
                 simulation->addElement(coupling);
             }
@@ -374,6 +403,11 @@ namespace dnf_composer
                 tools::logger::log(tools::logger::ERROR, "Element label not recognized.");
             break;
 	        }
+
+            // files written before elements had a step period step them every step
+            const auto element = simulation->getElement(uniqueName);
+            if (element && elementJson.contains("stepPeriod"))
+                element->setStepPeriod(elementJson["stepPeriod"]);
     }
 
 	    // Iterate to create interactions
@@ -0,0 +1,68 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "tools/arena.h"
+
+#include <new>
+#include <functional>
+
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace memory
+		{
+			Arena::Arena(size_t capacity, std::pmr::memory_resource* upstream)
+				: block(nullptr), capacity(roundUp(capacity)), used(0), overflowAllocations(0), upstream(upstream)
+			{
+				if (this->capacity > 0)
+					block = static_cast<std::byte*>(::operator new(this->capacity, std::align_val_t{ alignment }));
+			}
+
+			Arena::~Arena()
+			{
+				if (block)
+					::operator delete(block, std::align_val_t{ alignment });
+			}
+
+			bool Arena::owns(const void* pointer) const
+			{
+				const auto* bytePointer = static_cast<const std::byte*>(pointer);
+				return block && !std::less<const std::byte*>()(bytePointer, block) &&
+					std::less<const std::byte*>()(bytePointer, block + capacity);
+			}
+
+			size_t Arena::roundUp(size_t bytes)
+			{
+				return (bytes + alignment - 1) / alignment * alignment;
+			}
+
+			void* Arena::do_allocate(size_t bytes, size_t alignment)
+			{
+				const size_t size = roundUp(bytes);
+				std::lock_guard lock(mutex);
+				if (alignment <= Arena::alignment && used + size <= capacity)
+				{
+					void* pointer = block + used;
+					used += size;
+					return pointer;
+				}
+				overflowAllocations++;
+				return upstream->allocate(bytes, alignment);
+			}
+
+			void Arena::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+			{
+				if (!owns(pointer))
+					upstream->deallocate(pointer, bytes, alignment);
+			}
+
+			bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+			{
+				return this == &other;
+			}
+		}
+	}
+}
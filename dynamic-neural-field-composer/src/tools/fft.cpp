@@ -0,0 +1,177 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "tools/fft.h"
+
+#include <algorithm>
+#include <numbers>
+#include <cmath>
+#include <bit>
+
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace math
+		{
+			namespace
+			{
+				// plain complex product, std::complex's operator* also handles infinities and is much slower
+				std::complex<double> multiply(const std::complex<double>& a, const std::complex<double>& b)
+				{
+					return { a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real() };
+				}
+			}
+
+			FftConvolution::FftConvolution()
+				: signalSize(0), outputOffset(0), outputSize(0), transformSize(0)
+			{}
+
+			void FftConvolution::planValid(size_t signalSize, std::span<const double> kernel)
+			{
+				// out[i] = sum_j kernel[j] * signal[i + K - 1 - j], the valid part of the full convolution
+				const size_t kernelSize = kernel.size();
+				plan(signalSize, kernel, false, kernelSize - 1, signalSize - kernelSize + 1);
+			}
+
+			void FftConvolution::planSame(size_t signalSize, std::span<const double> kernel)
+			{
+				// out[i] = sum_j kernel[j] * signal[i + j - pad], a correlation, so the kernel is reversed
+				const size_t kernelSize = kernel.size();
+				const size_t pad = (kernelSize - 1) / 2;
+				plan(signalSize, kernel, true, kernelSize - 1 - pad, signalSize);
+			}
+
+			void FftConvolution::plan(size_t signalSize, std::span<const double> kernel, bool reverseKernel,
+				size_t outputOffset, size_t outputSize)
+			{
+				this->signalSize = signalSize;
+				this->outputOffset = outputOffset;
+				this->outputSize = outputSize;
+
+				// the transform must hold every output sample, and the wrapped-around tail of the
+				// full convolution (length N + K - 1) must not reach the first output sample
+				const size_t fullSize = signalSize + kernel.size() - 1;
+				const size_t requiredSize = std::max(fullSize - outputOffset, outputOffset + outputSize);
+				transformSize = std::max<size_t>(std::bit_ceil(requiredSize), 4);
+
+				const size_t half = transformSize / 2;
+				const int bits = std::countr_zero(half);
+				bitReversal.resize(half);
+				for (size_t i = 0; i < half; i++)
+				{
+					size_t reversed = 0;
+					for (int b = 0; b < bits; b++)
+						reversed |= ((i >> b) & 1) << (bits - 1 - b);
+					bitReversal[i] = reversed;
+				}
+
+				twiddles.resize(half / 2);
+				for (size_t k = 0; k < twiddles.size(); k++)
+					twiddles[k] = std::polar(1.0, -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(half));
+				realTwiddles.resize(half + 1);
+				for (size_t k = 0; k < realTwiddles.size(); k++)
+					realTwiddles[k] = std::polar(1.0, -2.0 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(transformSize));
+
+				buffer.resize(half);
+				spectrum.resize(half + 1);
+				forward(kernel, reverseKernel);
+				kernelSpectrum = spectrum;
+			}
+
+			void FftConvolution::convolve(std::span<const double> signal, std::span<double> output)
+			{
+				const size_t half = transformSize / 2;
+				forward(signal.first(std::min(signal.size(), signalSize)), false);
+
+				// multiply the spectra and pack the half-length inverse transform
+				for (size_t k = 0; k <= half; k++)
+					spectrum[k] = multiply(spectrum[k], kernelSpectrum[k]);
+				for (size_t k = 0; k < half; k++)
+				{
+					const std::complex<double> mirrored = std::conj(spectrum[half - k]);
+					const std::complex<double> even = 0.5 * (spectrum[k] + mirrored);
+					const std::complex<double> odd = 0.5 * multiply(spectrum[k] - mirrored, std::conj(realTwiddles[k]));
+					buffer[k] = { even.real() - odd.imag(), even.imag() + odd.real() };
+				}
+				transform(true);
+
+				const double scale = 1.0 / static_cast<double>(half);
+				const size_t count = std::min(output.size(), outputSize);
+				for (size_t i = 0; i < count; i++)
+				{
+					const size_t index = outputOffset + i;
+					const std::complex<double>& pair = buffer[index / 2];
+					output[i] = scale * ((index % 2 == 0) ? pair.real() : pair.imag());
+				}
+			}
+
+			bool FftConvolution::isWorthwhile(size_t outputSize, size_t kernelSize)
+			{
+				// below this kernel size the direct loop wins whatever the field size
+				static constexpr size_t minimumKernelSize = 48;
+				// cost of the transforms per point and level, relative to one multiply-add of the direct loop
+				static constexpr double transformCost = 6.0;
+
+				if (kernelSize < minimumKernelSize)
+					return false;
+				const auto transformSize = static_cast<double>(std::bit_ceil(outputSize + kernelSize - 1));
+				return static_cast<double>(outputSize * kernelSize) > transformCost * transformSize * std::log2(transformSize);
+			}
+
+			void FftConvolution::forward(std::span<const double> signal, bool reverse)
+			{
+				const size_t half = transformSize / 2;
+				const size_t size = signal.size();
+				const auto sample = [&](size_t i)
+				{
+					if (i >= size)
+						return 0.0;
+					return reverse ? signal[size - 1 - i] : signal[i];
+				};
+
+				// a real sequence of length M is transformed as a complex sequence of length M / 2
+				for (size_t k = 0; k < half; k++)
+					buffer[k] = { sample(2 * k), sample(2 * k + 1) };
+				transform(false);
+
+				for (size_t k = 0; k <= half; k++)
+				{
+					const std::complex<double> current = buffer[k % half];
+					const std::complex<double> mirrored = std::conj(buffer[(half - k) % half]);
+					const std::complex<double> even = 0.5 * (current + mirrored);
+					const std::complex<double> difference = current - mirrored;
+					const std::complex<double> odd = { 0.5 * difference.imag(), -0.5 * difference.real() };
+					spectrum[k] = even + multiply(realTwiddles[k], odd);
+				}
+			}
+
+			void FftConvolution::transform(bool inverse)
+			{
+				const size_t n = buffer.size();
+				for (size_t i = 0; i < n; i++)
+					if (i < bitReversal[i])
+						std::swap(buffer[i], buffer[bitReversal[i]]);
+
+				for (size_t length = 2; length <= n; length <<= 1)
+				{
+					const size_t halfLength = length / 2;
+					const size_t stride = n / length;
+					for (size_t start = 0; start < n; start += length)
+					{
+						for (size_t k = 0; k < halfLength; k++)
+						{
+							const std::complex<double> twiddle = inverse ? std::conj(twiddles[k * stride]) : twiddles[k * stride];
+							const std::complex<double> even = buffer[start + k];
+							const std::complex<double> odd = multiply(buffer[start + k + halfLength], twiddle);
+							buffer[start + k] = even + odd;
+							buffer[start + k + halfLength] = even - odd;
+						}
+					}
+				}
+			}
+		}
+	}
+}
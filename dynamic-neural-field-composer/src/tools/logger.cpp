@@ -4,6 +4,8 @@
 
 #include "tools/logger.h"
 
+#include <mutex>
+
 namespace dnf_composer
 {
 
@@ -11,6 +13,12 @@ namespace dnf_composer
     {
         namespace logger
         {
+            namespace
+            {
+                // elements may log while they are stepped by the worker threads of a simulation
+                std::mutex logMutex;
+            }
+
         	LogLevel Logger::minLogLevel = LogLevel::DEBUG; 
 
             Logger::Logger(LogLevel level, LogOutputMode mode)
@@ -88,6 +96,7 @@ namespace dnf_composer
                     return;
 #endif
 
+                const std::lock_guard lock(logMutex);
                 logger = Logger(level, mode);
                 logger.log(message);
             }
@@ -3,6 +3,8 @@
 // PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
 
 #include "tools/math.h"
+#include "tools/thread_pool.h"
+#include "tools/simd.h"
 
 
 namespace dnf_composer
@@ -66,6 +68,135 @@ namespace dnf_composer
 
 				return vec;
 			}
+
+			void conv_valid(std::span<const double> f, std::span<const double> g, std::span<double> out)
+			{
+				const std::span<const double> min_v = (f.size() < g.size()) ? f : g;
+				const std::span<const double> max_v = (f.size() < g.size()) ? g : f;
+				const size_t n = std::min(max_v.size() - min_v.size() + 1, out.size());
+				for (size_t i = 0; i < n; ++i)
+				{
+					double sum = 0.0;
+					for (size_t j = min_v.size(), k = i; j-- > 0; ++k)
+						sum += min_v[j] * max_v[k];
+					out[i] = sum;
+				}
+			}
+
+			void conv_same(std::span<const double> f, std::span<const double> g, std::span<double> out)
+			{
+				const int nf = static_cast<int>(f.size());
+				const int ng = static_cast<int>(g.size());
+				const int pad = (ng - 1) / 2;
+				for (int i = 0; i < nf; ++i)
+				{
+					// only the part of the kernel that overlaps the input contributes
+					const int jStart = std::max(0, pad - i);
+					const int jEnd = std::min(ng, nf + pad - i);
+					double sum = 0.0;
+					for (int j = jStart; j < jEnd; ++j)
+						sum += f[i + j - pad] * g[j];
+					out[i] = sum;
+				}
+			}
+
+			void obtainCircularVector(const std::vector<int>& indices, std::span<const double> contents, std::span<double> out)
+			{
+				for (size_t i = 0; i < indices.size(); i++)
+					out[i] = contents[indices[i] - 1];
+			}
+
+			void sigmoid(std::span<const double> x, double beta, double x0, std::span<double> out)
+			{
+				for (size_t i = 0; i < x.size(); ++i)
+					out[i] = 1 / (1 + std::exp(-beta * (x[i] - x0)));
+			}
+
+			void heaviside(std::span<const double> x, double threshold, std::span<double> out)
+			{
+				simd::heaviside(x, threshold, out);
+			}
+
+			void matrixVectorMultiply(std::span<const double> weights, std::span<const double> input, std::span<double> output,
+				double scalar, threading::ThreadPool* threadPool)
+			{
+				// outputs accumulated per block, 8 KB, so the block stays in the L1 cache
+				static constexpr size_t blockSize = 1024;
+				// multiply-adds below which splitting the product over threads does not pay off
+				static constexpr size_t parallelThreshold = 128 * 1024;
+
+				const size_t inputSize = input.size();
+				const size_t outputSize = output.size();
+				if (outputSize == 0)
+					return;
+
+				size_t blockLength = std::min(blockSize, outputSize);
+				if (threadPool && inputSize * outputSize >= parallelThreshold)
+				{
+					// one block per thread, whole cache lines each so threads never write to the same line
+					const size_t perThread = (outputSize + threadPool->getNumberOfThreads() - 1) / threadPool->getNumberOfThreads();
+					blockLength = std::min(blockLength, (perThread + 7) / 8 * 8);
+				}
+				const size_t numberOfBlocks = (outputSize + blockLength - 1) / blockLength;
+
+				const auto multiplyBlock = [&](size_t block)
+				{
+					const size_t begin = block * blockLength;
+					const size_t end = std::min(begin + blockLength, outputSize);
+					double* const out = output.data();
+					std::fill(out + begin, out + end, 0.0);
+
+					// four input rows per pass, so each output is loaded and stored once for four of them,
+					// the terms are still added one input after the other
+					size_t j = 0;
+					for (; j + 4 <= inputSize; j += 4)
+					{
+						const double* const row0 = weights.data() + j * outputSize;
+						const double* const row1 = row0 + outputSize;
+						const double* const row2 = row1 + outputSize;
+						const double* const row3 = row2 + outputSize;
+						const double x0 = input[j], x1 = input[j + 1], x2 = input[j + 2], x3 = input[j + 3];
+						for (size_t i = begin; i < end; i++)
+						{
+							double sum = out[i];
+							sum += scalar * row0[i] * x0;
+							sum += scalar * row1[i] * x1;
+							sum += scalar * row2[i] * x2;
+							sum += scalar * row3[i] * x3;
+							out[i] = sum;
+						}
+					}
+					for (; j < inputSize; j++)
+					{
+						const double* const row = weights.data() + j * outputSize;
+						const double x = input[j];
+						for (size_t i = begin; i < end; i++)
+							out[i] += scalar * row[i] * x;
+					}
+				};
+
+				if (threadPool && numberOfBlocks > 1)
+					threadPool->parallelFor(numberOfBlocks, multiplyBlock);
+				else
+					for (size_t block = 0; block < numberOfBlocks; block++)
+						multiplyBlock(block);
+			}
+
+			void normalize(std::span<const double> x, std::span<double> out)
+			{
+				static constexpr double epsilon = 1e-6;
+				static constexpr double offset = 1.0;
+
+				const double minVal = *std::ranges::min_element(x) - epsilon;
+				for (size_t i = 0; i < x.size(); ++i)
+					out[i] = x[i] + minVal;
+
+				sigmoid(out, 0.2, std::abs(minVal) + offset, out);
+				const double newMinVal = *std::ranges::min_element(out);
+
+				for (double& val : out)
+					val -= newMinVal;
+			}
 		}
 	}
 }
@@ -4,6 +4,61 @@
 
 #include "tools/profiling.h"
 
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	// counted per thread, so a thread sees only its own allocations and not those of simulations running on other threads
+	thread_local size_t allocationCount = 0;
+
+	void* allocate(size_t size)
+	{
+		allocationCount++;
+		if (void* pointer = std::malloc(size ? size : 1))
+			return pointer;
+		throw std::bad_alloc();
+	}
+
+	void* allocateAligned(size_t size, std::align_val_t alignment)
+	{
+		allocationCount++;
+		const auto align = static_cast<size_t>(alignment);
+		size = (size ? size + align - 1 : align) / align * align;
+#ifdef _MSC_VER
+		if (void* pointer = _aligned_malloc(size, align))
+#else
+		if (void* pointer = std::aligned_alloc(align, size))
+#endif
+			return pointer;
+		throw std::bad_alloc();
+	}
+
+	void deallocateAligned(void* pointer)
+	{
+#ifdef _MSC_VER
+		_aligned_free(pointer);
+#else
+		std::free(pointer);
+#endif
+	}
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { deallocateAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { deallocateAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { deallocateAligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { deallocateAligned(pointer); }
+#endif
+
 
 namespace dnf_composer
 {
@@ -33,6 +88,13 @@ namespace dnf_composer
 				    //<< " Duration (ms): " << static_cast<double>(duration.count()) * 0.001
 					<< std::endl;
 			}
+
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+			size_t getAllocationCount()
+			{
+				return allocationCount;
+			}
+#endif
 		}
 	}
 }
@@ -0,0 +1,105 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "tools/recursive_gaussian.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace math
+		{
+			RecursiveGaussian::RecursiveGaussian()
+				: b1(0.0), b2(0.0), b3(0.0), gain(1.0), scale(1.0), signalSize(0), padding(0), circular(false)
+			{}
+
+			void RecursiveGaussian::plan(double width, double scale, size_t signalSize, size_t padding, bool circular)
+			{
+				const double sigma = std::max(width, minimumWidth);
+				const double q = sigma >= 2.5 ? 0.98711 * sigma - 0.96330
+					: 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+				const double q2 = q * q;
+				const double q3 = q2 * q;
+
+				const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+				b1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+				b2 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+				b3 = 0.422205 * q3 / b0;
+				gain = 1.0 - (b1 + b2 + b3);
+
+				this->scale = scale;
+				this->signalSize = signalSize;
+				this->padding = padding;
+				this->circular = circular;
+				buffer.resize(signalSize + 2 * padding);
+			}
+
+			bool RecursiveGaussian::isWorthwhile(size_t signalSize, size_t kernelSize, size_t numberOfFilters, size_t padding)
+			{
+				// cost of filtering one sample, both passes included, relative to one multiply-add of the direct loop,
+				// the passes are serial chains of dependent multiply-adds
+				static constexpr double filterCost = 16.0;
+
+				return static_cast<double>(signalSize * kernelSize) >
+					filterCost * static_cast<double>(numberOfFilters * (signalSize + 2 * padding));
+			}
+
+			void RecursiveGaussian::filter(std::span<const double> input, std::span<double> output, bool accumulate)
+			{
+				if (signalSize == 0)
+					return;
+
+				if (circular)
+				{
+					// the padding may wrap around the signal several times
+					size_t index = (signalSize - padding % signalSize) % signalSize;
+					for (double& value : buffer)
+					{
+						value = input[index];
+						if (++index == signalSize)
+							index = 0;
+					}
+				}
+				else
+				{
+					std::fill_n(buffer.begin(), padding, 0.0);
+					std::copy_n(input.begin(), signalSize, buffer.begin() + static_cast<std::ptrdiff_t>(padding));
+					std::fill(buffer.begin() + static_cast<std::ptrdiff_t>(padding + signalSize), buffer.end(), 0.0);
+				}
+
+				// both passes start from the steady state of a constant signal equal to the first sample
+				double w1 = buffer.front(), w2 = w1, w3 = w1;
+				for (double& value : buffer)
+				{
+					const double w = gain * value + b1 * w1 + b2 * w2 + b3 * w3;
+					value = w;
+					w3 = w2;
+					w2 = w1;
+					w1 = w;
+				}
+
+				w1 = buffer.back(), w2 = w1, w3 = w1;
+				for (auto it = buffer.rbegin(); it != buffer.rend(); ++it)
+				{
+					const double w = gain * *it + b1 * w1 + b2 * w2 + b3 * w3;
+					*it = w;
+					w3 = w2;
+					w2 = w1;
+					w1 = w;
+				}
+
+				const size_t count = std::min(output.size(), signalSize);
+				for (size_t i = 0; i < count; i++)
+				{
+					const double value = scale * buffer[padding + i];
+					output[i] = accumulate ? output[i] + value : value;
+				}
+			}
+		}
+	}
+}
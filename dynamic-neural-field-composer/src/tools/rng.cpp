@@ -0,0 +1,113 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "tools/rng.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "tools/simd.h"
+
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace rng
+		{
+			namespace
+			{
+				constexpr std::uint32_t multiplier0 = 0xD2511F53;
+				constexpr std::uint32_t multiplier1 = 0xCD9E8D57;
+				constexpr std::uint32_t weyl0 = 0x9E3779B9;
+				constexpr std::uint32_t weyl1 = 0xBB67AE85;
+				constexpr int rounds = 10;
+
+				// maps 32 random bits to (0, 1), never returning 0 so the logarithm stays finite
+				double toUnitInterval(std::uint32_t bits)
+				{
+					return (static_cast<double>(bits) + 0.5) * 0x1.0p-32;
+				}
+			}
+
+			PhiloxGenerator::PhiloxGenerator(std::uint64_t seed, std::uint64_t stream)
+				: key(seed), stream(stream), counter(0)
+			{}
+
+			void PhiloxGenerator::setSeed(std::uint64_t seed, std::uint64_t stream)
+			{
+				key = seed;
+				this->stream = stream;
+				counter = 0;
+			}
+
+			void PhiloxGenerator::reset()
+			{
+				counter = 0;
+			}
+
+			std::array<std::uint32_t, 4> PhiloxGenerator::generateBlock(std::uint64_t key, std::uint64_t stream, std::uint64_t counter)
+			{
+				std::array<std::uint32_t, 4> x = {
+					static_cast<std::uint32_t>(counter), static_cast<std::uint32_t>(counter >> 32),
+					static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)
+				};
+				std::uint32_t k0 = static_cast<std::uint32_t>(key);
+				std::uint32_t k1 = static_cast<std::uint32_t>(key >> 32);
+
+				for (int round = 0; round < rounds; round++)
+				{
+					const std::uint64_t product0 = static_cast<std::uint64_t>(multiplier0) * x[0];
+					const std::uint64_t product1 = static_cast<std::uint64_t>(multiplier1) * x[2];
+					x = {
+						static_cast<std::uint32_t>(product1 >> 32) ^ x[1] ^ k0,
+						static_cast<std::uint32_t>(product1),
+						static_cast<std::uint32_t>(product0 >> 32) ^ x[3] ^ k1,
+						static_cast<std::uint32_t>(product0)
+					};
+					k0 += weyl0;
+					k1 += weyl1;
+				}
+				return x;
+			}
+
+			void PhiloxGenerator::fillUniform(std::span<double> output)
+			{
+				for (size_t offset = 0; offset < output.size(); offset += 4)
+				{
+					const auto block = generateBlock(key, stream, counter++);
+					const size_t count = std::min<size_t>(4, output.size() - offset);
+					for (size_t i = 0; i < count; i++)
+						output[offset + i] = toUnitInterval(block[i]);
+				}
+			}
+
+			void PhiloxGenerator::fillNormal(std::span<double> output)
+			{
+				// the uniform numbers of fillUniform, every pair of them in a block becomes a pair of normal numbers
+				fillUniform(output);
+				const size_t paired = output.size() & ~size_t{ 1 };
+				simd::boxMuller(output.first(paired));
+				if (paired == output.size())
+					return;
+				// the partner of the last number was drawn in the last block but not stored
+				const auto block = generateBlock(key, stream, counter - 1);
+				std::array<double, 2> pair{ output.back(), toUnitInterval(block[paired % 4 + 1]) };
+				simd::boxMuller(pair);
+				output.back() = pair[0];
+			}
+
+			std::uint64_t hashName(const std::string& name)
+			{
+				std::uint64_t hash = 0xCBF29CE484222325;
+				for (const char character : name)
+				{
+					hash ^= static_cast<unsigned char>(character);
+					hash *= 0x100000001B3;
+				}
+				return hash;
+			}
+		}
+	}
+}
@@ -0,0 +1,850 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "tools/simd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DNF_COMPOSER_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only emit AVX instructions in functions that ask for them,
+// msvc accepts the intrinsics anywhere, which is what runtime dispatch needs
+#if defined(__GNUC__) || defined(__clang__)
+#define DNF_COMPOSER_TARGET_AVX2 __attribute__((target("avx2")))
+#define DNF_COMPOSER_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define DNF_COMPOSER_TARGET_AVX2
+#define DNF_COMPOSER_TARGET_AVX512
+#endif
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace simd
+		{
+			namespace
+			{
+				// exp(x) = 2^n * exp(r), n = round(x / ln2), r = x - n * ln2 split in two parts so r is exact
+				constexpr double log2e = 1.4426950408889634;
+				constexpr double ln2High = 0.693145751953125;
+				constexpr double ln2Low = 1.42860682030941723212e-6;
+				// adding 1.5 * 2^52 rounds to an integer, which is then found in the low bits of the mantissa
+				constexpr double roundingShift = 6755399441055744.0;
+				constexpr double minArgument = -708.0;
+				constexpr double maxArgument = 708.0;
+				// taylor coefficients 1/k!, the remainder on |r| <= ln2/2 is below 5.2e-9
+				constexpr double c0 = 1.0;
+				constexpr double c1 = 1.0;
+				constexpr double c2 = 1.0 / 2.0;
+				constexpr double c3 = 1.0 / 6.0;
+				constexpr double c4 = 1.0 / 24.0;
+				constexpr double c5 = 1.0 / 120.0;
+				constexpr double c6 = 1.0 / 720.0;
+				constexpr double c7 = 1.0 / 5040.0;
+
+				InstructionSet detectInstructionSet()
+				{
+#if defined(DNF_COMPOSER_SIMD_X86)
+#if defined(_MSC_VER)
+					int info[4];
+					__cpuid(info, 0);
+					if (info[0] < 7)
+						return InstructionSet::SCALAR;
+					__cpuid(info, 1);
+					const bool osUsesXsave = (info[2] & (1 << 27)) != 0;
+					if (!osUsesXsave)
+						return InstructionSet::SCALAR;
+					// the operating system must also save the wider registers on a context switch
+					const unsigned long long enabledState = _xgetbv(0);
+					const bool ymmEnabled = (enabledState & 0x6) == 0x6;
+					const bool zmmEnabled = (enabledState & 0xe6) == 0xe6;
+					__cpuidex(info, 7, 0);
+					const bool hasAvx2 = (info[1] & (1 << 5)) != 0;
+					const bool hasAvx512 = (info[1] & (1 << 16)) != 0;
+					if (zmmEnabled && hasAvx512)
+						return InstructionSet::AVX512;
+					if (ymmEnabled && hasAvx2)
+						return InstructionSet::AVX2;
+#else
+					__builtin_cpu_init();
+					if (__builtin_cpu_supports("avx512f"))
+						return InstructionSet::AVX512;
+					if (__builtin_cpu_supports("avx2"))
+						return InstructionSet::AVX2;
+#endif
+#endif
+					return InstructionSet::SCALAR;
+				}
+
+				const InstructionSet supportedInstructionSet = detectInstructionSet();
+				std::atomic<InstructionSet> activeInstructionSet = supportedInstructionSet;
+
+				double expScalar(double x)
+				{
+					x = std::min(std::max(x, minArgument), maxArgument);
+					const double shifted = x * log2e + roundingShift;
+					const double n = shifted - roundingShift;
+					double r = x - n * ln2High;
+					r = r - n * ln2Low;
+					const double p = c0 + r * (c1 + r * (c2 + r * (c3 + r * (c4 + r * (c5 + r * (c6 + r * c7))))));
+					const auto exponent = static_cast<std::uint64_t>(static_cast<std::int64_t>(n) + 1023) << 52;
+					return p * std::bit_cast<double>(exponent);
+				}
+
+				// ln u = e ln2 + ln m, with u = m 2^e and m in [sqrt(1/2), sqrt(2)], ln m = 2 atanh(s) for s = (m - 1) / (m + 1),
+				// whose series in s^2 <= 0.0295 is cut after the tenth term, with a remainder below 1e-17
+				constexpr double sqrtTwo = 1.4142135623730951;
+				// 2^52, whose mantissa takes the biased exponent of a double shifted to the low bits
+				constexpr double exponentShift = 4503599627370496.0;
+				constexpr std::uint64_t exponentShiftBits = 0x4330000000000000;
+				constexpr std::uint64_t mantissaBits = 0x000FFFFFFFFFFFFF;
+				constexpr std::uint64_t oneBits = 0x3FF0000000000000;
+				// 2 / (2k + 1)
+				constexpr double l0 = 2.0;
+				constexpr double l1 = 2.0 / 3.0;
+				constexpr double l2 = 2.0 / 5.0;
+				constexpr double l3 = 2.0 / 7.0;
+				constexpr double l4 = 2.0 / 9.0;
+				constexpr double l5 = 2.0 / 11.0;
+				constexpr double l6 = 2.0 / 13.0;
+				constexpr double l7 = 2.0 / 15.0;
+				constexpr double l8 = 2.0 / 17.0;
+				constexpr double l9 = 2.0 / 19.0;
+
+				// cos 2pi v and sin 2pi v: v = q / 4 + f, exactly, with |f| <= 1/8, so x = 2pi f is within pi/4, where the
+				// taylor series cut after x^15 and x^16 are exact to 1e-16, and the quadrant q rotates the pair
+				constexpr double twoPi = 6.283185307179586;
+				constexpr double s1 = -1.0 / 6.0;
+				constexpr double s2 = 1.0 / 120.0;
+				constexpr double s3 = -1.0 / 5040.0;
+				constexpr double s4 = 1.0 / 362880.0;
+				constexpr double s5 = -1.0 / 39916800.0;
+				constexpr double s6 = 1.0 / 6227020800.0;
+				constexpr double s7 = -1.0 / 1307674368000.0;
+				constexpr double k1 = -1.0 / 2.0;
+				constexpr double k2 = 1.0 / 24.0;
+				constexpr double k3 = -1.0 / 720.0;
+				constexpr double k4 = 1.0 / 40320.0;
+				constexpr double k5 = -1.0 / 3628800.0;
+				constexpr double k6 = 1.0 / 479001600.0;
+				constexpr double k7 = -1.0 / 87178291200.0;
+				constexpr double k8 = 1.0 / 20922789888000.0;
+
+				double logScalar(double u)
+				{
+					const auto bits = std::bit_cast<std::uint64_t>(u);
+					double e = std::bit_cast<double>((bits >> 52) | exponentShiftBits) - exponentShift - 1023.0;
+					double m = std::bit_cast<double>((bits & mantissaBits) | oneBits);
+					const bool above = m > sqrtTwo;
+					m = above ? m * 0.5 : m;
+					e = e + (above ? 1.0 : 0.0);
+					const double s = (m - 1.0) / (m + 1.0);
+					const double z = s * s;
+					const double p = l0 + z * (l1 + z * (l2 + z * (l3 + z * (l4 + z * (l5 + z * (l6 + z * (l7 + z * (l8 + z * l9))))))));
+					return e * ln2High + (e * ln2Low + s * p);
+				}
+
+				void sinCosTwoPiScalar(double v, double& cosine, double& sine)
+				{
+					const double shifted = v * 4.0 + roundingShift;
+					const double q = shifted - roundingShift;
+					const auto quadrant = std::bit_cast<std::uint64_t>(shifted);
+					const double x = (v - q * 0.25) * twoPi;
+					const double z = x * x;
+					const double sp = s1 + z * (s2 + z * (s3 + z * (s4 + z * (s5 + z * (s6 + z * s7)))));
+					const double kp = k1 + z * (k2 + z * (k3 + z * (k4 + z * (k5 + z * (k6 + z * (k7 + z * k8))))));
+					const double sx = x + x * z * sp;
+					const double cx = 1.0 + z * kp;
+					cosine = (quadrant & 1) ? sx : cx;
+					sine = (quadrant & 1) ? cx : sx;
+					if ((quadrant + 1) & 2)
+						cosine = -cosine;
+					if (quadrant & 2)
+						sine = -sine;
+				}
+
+				void boxMullerScalar(double& first, double& second)
+				{
+					const double radius = std::sqrt(-2.0 * logScalar(first));
+					double cosine, sine;
+					sinCosTwoPiScalar(second, cosine, sine);
+					first = radius * cosine;
+					second = radius * sine;
+				}
+
+				// the order of tools::math::conv_valid
+				void convolveInterleavedRowsScalar(const double* input, const double* kernel, double* output,
+					size_t rows, size_t kernelSize, size_t outputSize)
+				{
+					for (size_t i = 0; i < outputSize; i++)
+						for (size_t r = 0; r < rows; r++)
+						{
+							double sum = 0.0;
+							for (size_t j = kernelSize, k = i; j-- > 0; ++k)
+								sum += kernel[j * rows + r] * input[k * rows + r];
+							output[i * rows + r] = sum;
+						}
+				}
+
+#if defined(DNF_COMPOSER_SIMD_X86)
+				// separate multiplies and adds, like expScalar, so every instruction set rounds the same way
+				DNF_COMPOSER_TARGET_AVX2 inline __m256d expAvx2(__m256d x)
+				{
+					x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(minArgument)), _mm256_set1_pd(maxArgument));
+					const __m256d shifted = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(log2e)), _mm256_set1_pd(roundingShift));
+					const __m256d n = _mm256_sub_pd(shifted, _mm256_set1_pd(roundingShift));
+					__m256d r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(ln2High)));
+					r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(ln2Low)));
+					__m256d p = _mm256_set1_pd(c7);
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c6));
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c5));
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c4));
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c3));
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c2));
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c1));
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(c0));
+					const __m256i exponent = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(shifted), _mm256_set1_epi64x(1023)), 52);
+					return _mm256_mul_pd(p, _mm256_castsi256_pd(exponent));
+				}
+
+				// lanes [0, remaining) of a 4-wide vector
+				DNF_COMPOSER_TARGET_AVX2 inline __m256i maskAvx2(size_t remaining)
+				{
+					const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+					return _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(remaining)), lanes);
+				}
+
+				DNF_COMPOSER_TARGET_AVX2 void polynomialExpAvx2(const double* x, double* out, size_t size)
+				{
+					size_t i = 0;
+					for (; i + 4 <= size; i += 4)
+						_mm256_storeu_pd(out + i, expAvx2(_mm256_loadu_pd(x + i)));
+					if (i < size)
+					{
+						const __m256i mask = maskAvx2(size - i);
+						_mm256_maskstore_pd(out + i, mask, expAvx2(_mm256_maskload_pd(x + i, mask)));
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX2 inline __m256d sigmoidAvx2(__m256d x, __m256d beta, __m256d x0)
+				{
+					const __m256d one = _mm256_set1_pd(1.0);
+					const __m256d e = expAvx2(_mm256_mul_pd(_mm256_sub_pd(x0, x), beta));
+					return _mm256_div_pd(one, _mm256_add_pd(one, e));
+				}
+
+				DNF_COMPOSER_TARGET_AVX2 void polynomialSigmoidAvx2(const double* x, double beta, double x0, double* out, size_t size)
+				{
+					const __m256d betaVector = _mm256_set1_pd(beta);
+					const __m256d x0Vector = _mm256_set1_pd(x0);
+					size_t i = 0;
+					for (; i + 4 <= size; i += 4)
+						_mm256_storeu_pd(out + i, sigmoidAvx2(_mm256_loadu_pd(x + i), betaVector, x0Vector));
+					if (i < size)
+					{
+						const __m256i mask = maskAvx2(size - i);
+						_mm256_maskstore_pd(out + i, mask, sigmoidAvx2(_mm256_maskload_pd(x + i, mask), betaVector, x0Vector));
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX2 void heavisideAvx2(const double* x, double threshold, double* out, size_t size)
+				{
+					const __m256d thresholdVector = _mm256_set1_pd(threshold);
+					const __m256d one = _mm256_set1_pd(1.0);
+					size_t i = 0;
+					for (; i + 4 <= size; i += 4)
+						_mm256_storeu_pd(out + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i), thresholdVector, _CMP_GT_OQ), one));
+					for (; i < size; i++)
+						out[i] = (x[i] > threshold) ? 1 : 0;
+				}
+
+				DNF_COMPOSER_TARGET_AVX2 void sumSourcesAvx2(const double* const* sources, size_t numberOfSources, double* out, size_t size)
+				{
+					size_t i = 0;
+					for (; i + 4 <= size; i += 4)
+					{
+						__m256d sum = _mm256_setzero_pd();
+						for (size_t s = 0; s < numberOfSources; s++)
+							sum = _mm256_add_pd(sum, _mm256_loadu_pd(sources[s] + i));
+						_mm256_storeu_pd(out + i, sum);
+					}
+					for (; i < size; i++)
+					{
+						double sum = 0.0;
+						for (size_t s = 0; s < numberOfSources; s++)
+							sum += sources[s][i];
+						out[i] = sum;
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX2 void integrateFieldRowAvx2(FieldRow& row, size_t begin, size_t end)
+				{
+					double lowest = row.lowest;
+					double highest = row.highest;
+					double sum = row.sum;
+					double sumOfSquares = row.sumOfSquares;
+					for (size_t i = begin; i < end; i++)
+					{
+						const double value = row.activation[i] + row.gain * (-row.activation[i] + row.restingLevel[i] + row.input[i]);
+						row.activation[i] = value;
+						lowest = std::min(lowest, value);
+						highest = std::max(highest, value);
+						sum += value;
+						sumOfSquares += value * value;
+					}
+					row.lowest = lowest;
+					row.highest = highest;
+					row.sum = sum;
+					row.sumOfSquares = sumOfSquares;
+				}
+
+				// rows[k][i] becomes rows[i][k]
+				DNF_COMPOSER_TARGET_AVX2 inline void transposeAvx2(__m256d& r0, __m256d& r1, __m256d& r2, __m256d& r3)
+				{
+					const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+					const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+					const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+					const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+					r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+					r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+					r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+					r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+				}
+
+				// one value of each of four rows, one row per lane, with the statistics of the rows
+				DNF_COMPOSER_TARGET_AVX2 inline __m256d integrateFourValuesAvx2(__m256d gain, __m256d activation, __m256d restingLevel, __m256d input,
+					__m256d& lowest, __m256d& highest, __m256d& sum, __m256d& sumOfSquares)
+				{
+					const __m256d value = _mm256_add_pd(activation, _mm256_mul_pd(gain, _mm256_add_pd(_mm256_sub_pd(restingLevel, activation), input)));
+					lowest = _mm256_min_pd(value, lowest);
+					highest = _mm256_max_pd(value, highest);
+					sum = _mm256_add_pd(sum, value);
+					sumOfSquares = _mm256_add_pd(sumOfSquares, _mm256_mul_pd(value, value));
+					return value;
+				}
+
+				// four rows, one per lane, tiles of 4x4 values are transposed so every lane walks its row in order
+				DNF_COMPOSER_TARGET_AVX2 void integrateFourFieldRowsAvx2(FieldRow* rows, size_t begin, size_t end)
+				{
+					const __m256d gain = _mm256_set_pd(rows[3].gain, rows[2].gain, rows[1].gain, rows[0].gain);
+					__m256d lowest = _mm256_set_pd(rows[3].lowest, rows[2].lowest, rows[1].lowest, rows[0].lowest);
+					__m256d highest = _mm256_set_pd(rows[3].highest, rows[2].highest, rows[1].highest, rows[0].highest);
+					__m256d sum = _mm256_set_pd(rows[3].sum, rows[2].sum, rows[1].sum, rows[0].sum);
+					__m256d sumOfSquares = _mm256_set_pd(rows[3].sumOfSquares, rows[2].sumOfSquares, rows[1].sumOfSquares, rows[0].sumOfSquares);
+
+					size_t i = begin;
+					for (; i + 4 <= end; i += 4)
+					{
+						__m256d a[4], h[4], s[4];
+						for (size_t r = 0; r < 4; r++)
+						{
+							a[r] = _mm256_loadu_pd(rows[r].activation + i);
+							h[r] = _mm256_loadu_pd(rows[r].restingLevel + i);
+							s[r] = _mm256_loadu_pd(rows[r].input + i);
+						}
+						transposeAvx2(a[0], a[1], a[2], a[3]);
+						transposeAvx2(h[0], h[1], h[2], h[3]);
+						transposeAvx2(s[0], s[1], s[2], s[3]);
+						for (size_t k = 0; k < 4; k++)
+							a[k] = integrateFourValuesAvx2(gain, a[k], h[k], s[k], lowest, highest, sum, sumOfSquares);
+						transposeAvx2(a[0], a[1], a[2], a[3]);
+						for (size_t r = 0; r < 4; r++)
+							_mm256_storeu_pd(rows[r].activation + i, a[r]);
+					}
+					for (; i < end; i++)
+					{
+						const __m256d a = _mm256_set_pd(rows[3].activation[i], rows[2].activation[i], rows[1].activation[i], rows[0].activation[i]);
+						const __m256d h = _mm256_set_pd(rows[3].restingLevel[i], rows[2].restingLevel[i], rows[1].restingLevel[i], rows[0].restingLevel[i]);
+						const __m256d s = _mm256_set_pd(rows[3].input[i], rows[2].input[i], rows[1].input[i], rows[0].input[i]);
+						alignas(32) double value[4];
+						_mm256_store_pd(value, integrateFourValuesAvx2(gain, a, h, s, lowest, highest, sum, sumOfSquares));
+						for (size_t r = 0; r < 4; r++)
+							rows[r].activation[i] = value[r];
+					}
+
+					alignas(32) double statistics[4][4];
+					_mm256_store_pd(statistics[0], lowest);
+					_mm256_store_pd(statistics[1], highest);
+					_mm256_store_pd(statistics[2], sum);
+					_mm256_store_pd(statistics[3], sumOfSquares);
+					for (size_t r = 0; r < 4; r++)
+					{
+						rows[r].lowest = statistics[0][r];
+						rows[r].highest = statistics[1][r];
+						rows[r].sum = statistics[2][r];
+						rows[r].sumOfSquares = statistics[3][r];
+					}
+				}
+
+				// the polynomials of logScalar and sinCosTwoPiScalar, with the same operations in the same order
+				DNF_COMPOSER_TARGET_AVX2 inline __m256d logAvx2(__m256d u)
+				{
+					const __m256d one = _mm256_set1_pd(1.0);
+					const __m256i bits = _mm256_castpd_si256(u);
+					const __m256d biasedExponent = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(exponentShiftBits)));
+					__m256d e = _mm256_sub_pd(_mm256_sub_pd(biasedExponent, _mm256_set1_pd(exponentShift)), _mm256_set1_pd(1023.0));
+					__m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(mantissaBits)), _mm256_set1_epi64x(oneBits)));
+					const __m256d above = _mm256_cmp_pd(m, _mm256_set1_pd(sqrtTwo), _CMP_GT_OQ);
+					m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), above);
+					e = _mm256_add_pd(e, _mm256_and_pd(above, one));
+					const __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+					const __m256d z = _mm256_mul_pd(s, s);
+					__m256d p = _mm256_set1_pd(l9);
+					for (const double coefficient : { l8, l7, l6, l5, l4, l3, l2, l1, l0 })
+						p = _mm256_add_pd(_mm256_set1_pd(coefficient), _mm256_mul_pd(z, p));
+					return _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(ln2High)),
+						_mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(ln2Low)), _mm256_mul_pd(s, p)));
+				}
+
+				DNF_COMPOSER_TARGET_AVX2 inline void sinCosTwoPiAvx2(__m256d v, __m256d& cosine, __m256d& sine)
+				{
+					const __m256d shifted = _mm256_add_pd(_mm256_mul_pd(v, _mm256_set1_pd(4.0)), _mm256_set1_pd(roundingShift));
+					const __m256d q = _mm256_sub_pd(shifted, _mm256_set1_pd(roundingShift));
+					const __m256i quadrant = _mm256_castpd_si256(shifted);
+					const __m256d x = _mm256_mul_pd(_mm256_sub_pd(v, _mm256_mul_pd(q, _mm256_set1_pd(0.25))), _mm256_set1_pd(twoPi));
+					const __m256d z = _mm256_mul_pd(x, x);
+					__m256d sp = _mm256_set1_pd(s7);
+					for (const double coefficient : { s6, s5, s4, s3, s2, s1 })
+						sp = _mm256_add_pd(_mm256_set1_pd(coefficient), _mm256_mul_pd(z, sp));
+					__m256d kp = _mm256_set1_pd(k8);
+					for (const double coefficient : { k7, k6, k5, k4, k3, k2, k1 })
+						kp = _mm256_add_pd(_mm256_set1_pd(coefficient), _mm256_mul_pd(z, kp));
+					const __m256d sx = _mm256_add_pd(x, _mm256_mul_pd(_mm256_mul_pd(x, z), sp));
+					const __m256d cx = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(z, kp));
+					const __m256i one = _mm256_set1_epi64x(1);
+					const __m256d odd = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(quadrant, one), one));
+					// bit 1 of the quadrant moved to the sign bit
+					const __m256i cosineSign = _mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(quadrant, one), _mm256_set1_epi64x(2)), 62);
+					const __m256i sineSign = _mm256_slli_epi64(_mm256_and_si256(quadrant, _mm256_set1_epi64x(2)), 62);
+					cosine = _mm256_xor_pd(_mm256_blendv_pd(cx, sx, odd), _mm256_castsi256_pd(cosineSign));
+					sine = _mm256_xor_pd(_mm256_blendv_pd(sx, cx, odd), _mm256_castsi256_pd(sineSign));
+				}
+
+				// four pairs at a time, the first numbers of the pairs in one vector and the second in the other
+				DNF_COMPOSER_TARGET_AVX2 void boxMullerAvx2(double* values, size_t size)
+				{
+					size_t i = 0;
+					for (; i + 8 <= size; i += 8)
+					{
+						const __m256d a = _mm256_loadu_pd(values + i);
+						const __m256d b = _mm256_loadu_pd(values + i + 4);
+						const __m256d radius = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_set1_pd(-2.0), logAvx2(_mm256_unpacklo_pd(a, b))));
+						__m256d cosine, sine;
+						sinCosTwoPiAvx2(_mm256_unpackhi_pd(a, b), cosine, sine);
+						cosine = _mm256_mul_pd(radius, cosine);
+						sine = _mm256_mul_pd(radius, sine);
+						_mm256_storeu_pd(values + i, _mm256_unpacklo_pd(cosine, sine));
+						_mm256_storeu_pd(values + i + 4, _mm256_unpackhi_pd(cosine, sine));
+					}
+					for (; i + 2 <= size; i += 2)
+						boxMullerScalar(values[i], values[i + 1]);
+				}
+
+				// four rows per vector, eight outputs at a time, so the sums do not wait on each other,
+				// each in a register of its own
+				DNF_COMPOSER_TARGET_AVX2 void convolveInterleavedRowsAvx2(const double* input, const double* kernel, double* output,
+					size_t rows, size_t kernelSize, size_t outputSize)
+				{
+					for (size_t r = 0; r < rows; r += 4)
+					{
+						const __m256i mask = maskAvx2(rows - r);
+						size_t i = 0;
+						for (; i + 8 <= outputSize; i += 8)
+						{
+							__m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd(), sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+							__m256d sum4 = _mm256_setzero_pd(), sum5 = _mm256_setzero_pd(), sum6 = _mm256_setzero_pd(), sum7 = _mm256_setzero_pd();
+							for (size_t j = kernelSize, k = i; j-- > 0; ++k)
+							{
+								const __m256d weight = _mm256_maskload_pd(kernel + j * rows + r, mask);
+								const double* values = input + k * rows + r;
+								sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(weight, _mm256_maskload_pd(values, mask)));
+								sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(weight, _mm256_maskload_pd(values + rows, mask)));
+								sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(weight, _mm256_maskload_pd(values + 2 * rows, mask)));
+								sum3 = _mm256_add_pd(sum3, _mm256_mul_pd(weight, _mm256_maskload_pd(values + 3 * rows, mask)));
+								sum4 = _mm256_add_pd(sum4, _mm256_mul_pd(weight, _mm256_maskload_pd(values + 4 * rows, mask)));
+								sum5 = _mm256_add_pd(sum5, _mm256_mul_pd(weight, _mm256_maskload_pd(values + 5 * rows, mask)));
+								sum6 = _mm256_add_pd(sum6, _mm256_mul_pd(weight, _mm256_maskload_pd(values + 6 * rows, mask)));
+								sum7 = _mm256_add_pd(sum7, _mm256_mul_pd(weight, _mm256_maskload_pd(values + 7 * rows, mask)));
+							}
+							const __m256d sums[8] = { sum0, sum1, sum2, sum3, sum4, sum5, sum6, sum7 };
+							for (size_t q = 0; q < 8; q++)
+								_mm256_maskstore_pd(output + (i + q) * rows + r, mask, sums[q]);
+						}
+						for (; i < outputSize; i++)
+						{
+							__m256d sum = _mm256_setzero_pd();
+							for (size_t j = kernelSize, k = i; j-- > 0; ++k)
+								sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_maskload_pd(kernel + j * rows + r, mask), _mm256_maskload_pd(input + k * rows + r, mask)));
+							_mm256_maskstore_pd(output + i * rows + r, mask, sum);
+						}
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 inline __m512d expAvx512(__m512d x)
+				{
+					// the unmasked min, max and shift of gcc leave their unused pass-through lanes undefined, which it
+					// then reports as maybe uninitialized, the zero-masked forms over all lanes compute the same
+					constexpr __mmask8 allLanes = 0xff;
+					x = _mm512_maskz_min_pd(allLanes, _mm512_maskz_max_pd(allLanes, x, _mm512_set1_pd(minArgument)), _mm512_set1_pd(maxArgument));
+					const __m512d shifted = _mm512_add_pd(_mm512_mul_pd(x, _mm512_set1_pd(log2e)), _mm512_set1_pd(roundingShift));
+					const __m512d n = _mm512_sub_pd(shifted, _mm512_set1_pd(roundingShift));
+					__m512d r = _mm512_sub_pd(x, _mm512_mul_pd(n, _mm512_set1_pd(ln2High)));
+					r = _mm512_sub_pd(r, _mm512_mul_pd(n, _mm512_set1_pd(ln2Low)));
+					__m512d p = _mm512_set1_pd(c7);
+					p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c6));
+					p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c5));
+					p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c4));
+					p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c3));
+					p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c2));
+					p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c1));
+					p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(c0));
+					const __m512i exponent = _mm512_maskz_slli_epi64(allLanes,
+						_mm512_add_epi64(_mm512_castpd_si512(shifted), _mm512_set1_epi64(1023)), 52);
+					return _mm512_mul_pd(p, _mm512_castsi512_pd(exponent));
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 void polynomialExpAvx512(const double* x, double* out, size_t size)
+				{
+					for (size_t i = 0; i < size; i += 8)
+					{
+						const __mmask8 mask = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+						_mm512_mask_storeu_pd(out + i, mask, expAvx512(_mm512_maskz_loadu_pd(mask, x + i)));
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 void polynomialSigmoidAvx512(const double* x, double beta, double x0, double* out, size_t size)
+				{
+					const __m512d betaVector = _mm512_set1_pd(beta);
+					const __m512d x0Vector = _mm512_set1_pd(x0);
+					const __m512d one = _mm512_set1_pd(1.0);
+					for (size_t i = 0; i < size; i += 8)
+					{
+						const __mmask8 mask = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+						const __m512d values = _mm512_maskz_loadu_pd(mask, x + i);
+						const __m512d e = expAvx512(_mm512_mul_pd(_mm512_sub_pd(x0Vector, values), betaVector));
+						_mm512_mask_storeu_pd(out + i, mask, _mm512_div_pd(one, _mm512_add_pd(one, e)));
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 void heavisideAvx512(const double* x, double threshold, double* out, size_t size)
+				{
+					const __m512d thresholdVector = _mm512_set1_pd(threshold);
+					const __m512d one = _mm512_set1_pd(1.0);
+					for (size_t i = 0; i < size; i += 8)
+					{
+						const __mmask8 mask = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+						const __mmask8 above = _mm512_mask_cmp_pd_mask(mask, _mm512_maskz_loadu_pd(mask, x + i), thresholdVector, _CMP_GT_OQ);
+						_mm512_mask_storeu_pd(out + i, mask, _mm512_maskz_mov_pd(above, one));
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 void sumSourcesAvx512(const double* const* sources, size_t numberOfSources, double* out, size_t size)
+				{
+					for (size_t i = 0; i < size; i += 8)
+					{
+						const __mmask8 mask = size - i >= 8 ? 0xff : static_cast<__mmask8>((1u << (size - i)) - 1);
+						__m512d sum = _mm512_setzero_pd();
+						for (size_t s = 0; s < numberOfSources; s++)
+							sum = _mm512_add_pd(sum, _mm512_maskz_loadu_pd(mask, sources[s] + i));
+						_mm512_mask_storeu_pd(out + i, mask, sum);
+					}
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 inline __m512d logAvx512(__m512d u)
+				{
+					constexpr __mmask8 allLanes = 0xff;
+					const __m512d one = _mm512_set1_pd(1.0);
+					const __m512i bits = _mm512_castpd_si512(u);
+					const __m512d biasedExponent = _mm512_castsi512_pd(_mm512_or_si512(_mm512_maskz_srli_epi64(allLanes, bits, 52),
+						_mm512_set1_epi64(exponentShiftBits)));
+					__m512d e = _mm512_sub_pd(_mm512_sub_pd(biasedExponent, _mm512_set1_pd(exponentShift)), _mm512_set1_pd(1023.0));
+					__m512d m = _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi64(mantissaBits)), _mm512_set1_epi64(oneBits)));
+					const __mmask8 above = _mm512_cmp_pd_mask(m, _mm512_set1_pd(sqrtTwo), _CMP_GT_OQ);
+					m = _mm512_mask_mul_pd(m, above, m, _mm512_set1_pd(0.5));
+					e = _mm512_add_pd(e, _mm512_maskz_mov_pd(above, one));
+					const __m512d s = _mm512_div_pd(_mm512_sub_pd(m, one), _mm512_add_pd(m, one));
+					const __m512d z = _mm512_mul_pd(s, s);
+					__m512d p = _mm512_set1_pd(l9);
+					for (const double coefficient : { l8, l7, l6, l5, l4, l3, l2, l1, l0 })
+						p = _mm512_add_pd(_mm512_set1_pd(coefficient), _mm512_mul_pd(z, p));
+					return _mm512_add_pd(_mm512_mul_pd(e, _mm512_set1_pd(ln2High)),
+						_mm512_add_pd(_mm512_mul_pd(e, _mm512_set1_pd(ln2Low)), _mm512_mul_pd(s, p)));
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 inline void sinCosTwoPiAvx512(__m512d v, __m512d& cosine, __m512d& sine)
+				{
+					constexpr __mmask8 allLanes = 0xff;
+					const __m512d shifted = _mm512_add_pd(_mm512_mul_pd(v, _mm512_set1_pd(4.0)), _mm512_set1_pd(roundingShift));
+					const __m512d q = _mm512_sub_pd(shifted, _mm512_set1_pd(roundingShift));
+					const __m512i quadrant = _mm512_castpd_si512(shifted);
+					const __m512d x = _mm512_mul_pd(_mm512_sub_pd(v, _mm512_mul_pd(q, _mm512_set1_pd(0.25))), _mm512_set1_pd(twoPi));
+					const __m512d z = _mm512_mul_pd(x, x);
+					__m512d sp = _mm512_set1_pd(s7);
+					for (const double coefficient : { s6, s5, s4, s3, s2, s1 })
+						sp = _mm512_add_pd(_mm512_set1_pd(coefficient), _mm512_mul_pd(z, sp));
+					__m512d kp = _mm512_set1_pd(k8);
+					for (const double coefficient : { k7, k6, k5, k4, k3, k2, k1 })
+						kp = _mm512_add_pd(_mm512_set1_pd(coefficient), _mm512_mul_pd(z, kp));
+					const __m512d sx = _mm512_add_pd(x, _mm512_mul_pd(_mm512_mul_pd(x, z), sp));
+					const __m512d cx = _mm512_add_pd(_mm512_set1_pd(1.0), _mm512_mul_pd(z, kp));
+					const __m512i one = _mm512_set1_epi64(1);
+					const __mmask8 odd = _mm512_test_epi64_mask(quadrant, one);
+					const __m512i cosineSign = _mm512_maskz_slli_epi64(allLanes, _mm512_and_si512(_mm512_add_epi64(quadrant, one), _mm512_set1_epi64(2)), 62);
+					const __m512i sineSign = _mm512_maskz_slli_epi64(allLanes, _mm512_and_si512(quadrant, _mm512_set1_epi64(2)), 62);
+					cosine = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_mask_blend_pd(odd, cx, sx)), cosineSign));
+					sine = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_mask_blend_pd(odd, sx, cx)), sineSign));
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 void boxMullerAvx512(double* values, size_t size)
+				{
+					// the zero-masked forms over all lanes, as in expAvx512
+					constexpr __mmask8 allLanes = 0xff;
+					size_t i = 0;
+					for (; i + 16 <= size; i += 16)
+					{
+						const __m512d a = _mm512_loadu_pd(values + i);
+						const __m512d b = _mm512_loadu_pd(values + i + 8);
+						const __m512d radius = _mm512_maskz_sqrt_pd(allLanes, _mm512_mul_pd(_mm512_set1_pd(-2.0), logAvx512(_mm512_maskz_unpacklo_pd(allLanes, a, b))));
+						__m512d cosine, sine;
+						sinCosTwoPiAvx512(_mm512_maskz_unpackhi_pd(allLanes, a, b), cosine, sine);
+						cosine = _mm512_mul_pd(radius, cosine);
+						sine = _mm512_mul_pd(radius, sine);
+						_mm512_storeu_pd(values + i, _mm512_maskz_unpacklo_pd(allLanes, cosine, sine));
+						_mm512_storeu_pd(values + i + 8, _mm512_maskz_unpackhi_pd(allLanes, cosine, sine));
+					}
+					for (; i + 2 <= size; i += 2)
+						boxMullerScalar(values[i], values[i + 1]);
+				}
+
+				DNF_COMPOSER_TARGET_AVX512 void convolveInterleavedRowsAvx512(const double* input, const double* kernel, double* output,
+					size_t rows, size_t kernelSize, size_t outputSize)
+				{
+					for (size_t r = 0; r < rows; r += 8)
+					{
+						const __mmask8 mask = rows - r >= 8 ? 0xff : static_cast<__mmask8>((1u << (rows - r)) - 1);
+						size_t i = 0;
+						for (; i + 8 <= outputSize; i += 8)
+						{
+							__m512d sum0 = _mm512_setzero_pd(), sum1 = _mm512_setzero_pd(), sum2 = _mm512_setzero_pd(), sum3 = _mm512_setzero_pd();
+							__m512d sum4 = _mm512_setzero_pd(), sum5 = _mm512_setzero_pd(), sum6 = _mm512_setzero_pd(), sum7 = _mm512_setzero_pd();
+							for (size_t j = kernelSize, k = i; j-- > 0; ++k)
+							{
+								const __m512d weight = _mm512_maskz_loadu_pd(mask, kernel + j * rows + r);
+								const double* values = input + k * rows + r;
+								sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values)));
+								sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values + rows)));
+								sum2 = _mm512_add_pd(sum2, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values + 2 * rows)));
+								sum3 = _mm512_add_pd(sum3, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values + 3 * rows)));
+								sum4 = _mm512_add_pd(sum4, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values + 4 * rows)));
+								sum5 = _mm512_add_pd(sum5, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values + 5 * rows)));
+								sum6 = _mm512_add_pd(sum6, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values + 6 * rows)));
+								sum7 = _mm512_add_pd(sum7, _mm512_mul_pd(weight, _mm512_maskz_loadu_pd(mask, values + 7 * rows)));
+							}
+							const __m512d sums[8] = { sum0, sum1, sum2, sum3, sum4, sum5, sum6, sum7 };
+							for (size_t q = 0; q < 8; q++)
+								_mm512_mask_storeu_pd(output + (i + q) * rows + r, mask, sums[q]);
+						}
+						for (; i < outputSize; i++)
+						{
+							__m512d sum = _mm512_setzero_pd();
+							for (size_t j = kernelSize, k = i; j-- > 0; ++k)
+								sum = _mm512_add_pd(sum, _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, kernel + j * rows + r), _mm512_maskz_loadu_pd(mask, input + k * rows + r)));
+							_mm512_mask_storeu_pd(output + i * rows + r, mask, sum);
+						}
+					}
+				}
+#endif
+			}
+
+			InstructionSet getInstructionSet()
+			{
+				return activeInstructionSet.load(std::memory_order_relaxed);
+			}
+
+			std::string getInstructionSetName()
+			{
+				switch (getInstructionSet())
+				{
+				case InstructionSet::AVX512:
+					return "AVX-512";
+				case InstructionSet::AVX2:
+					return "AVX2";
+				default:
+					return "scalar";
+				}
+			}
+
+			void setInstructionSet(InstructionSet instructionSet)
+			{
+				activeInstructionSet = std::min(instructionSet, supportedInstructionSet);
+			}
+
+			void polynomialExp(std::span<const double> x, std::span<double> out)
+			{
+#if defined(DNF_COMPOSER_SIMD_X86)
+				switch (getInstructionSet())
+				{
+				case InstructionSet::AVX512:
+					polynomialExpAvx512(x.data(), out.data(), x.size());
+					return;
+				case InstructionSet::AVX2:
+					polynomialExpAvx2(x.data(), out.data(), x.size());
+					return;
+				default:
+					break;
+				}
+#endif
+				for (size_t i = 0; i < x.size(); i++)
+					out[i] = expScalar(x[i]);
+			}
+
+			void polynomialSigmoid(std::span<const double> x, double beta, double x0, std::span<double> out)
+			{
+#if defined(DNF_COMPOSER_SIMD_X86)
+				switch (getInstructionSet())
+				{
+				case InstructionSet::AVX512:
+					polynomialSigmoidAvx512(x.data(), beta, x0, out.data(), x.size());
+					return;
+				case InstructionSet::AVX2:
+					polynomialSigmoidAvx2(x.data(), beta, x0, out.data(), x.size());
+					return;
+				default:
+					break;
+				}
+#endif
+				for (size_t i = 0; i < x.size(); i++)
+					out[i] = 1 / (1 + expScalar(-beta * (x[i] - x0)));
+			}
+
+			void heaviside(std::span<const double> x, double threshold, std::span<double> out)
+			{
+#if defined(DNF_COMPOSER_SIMD_X86)
+				switch (getInstructionSet())
+				{
+				case InstructionSet::AVX512:
+					heavisideAvx512(x.data(), threshold, out.data(), x.size());
+					return;
+				case InstructionSet::AVX2:
+					heavisideAvx2(x.data(), threshold, out.data(), x.size());
+					return;
+				default:
+					break;
+				}
+#endif
+				for (size_t i = 0; i < x.size(); i++)
+					out[i] = (x[i] > threshold) ? 1 : 0;
+			}
+
+			void sumSources(std::span<const double* const> sources, std::span<double> out)
+			{
+#if defined(DNF_COMPOSER_SIMD_X86)
+				switch (getInstructionSet())
+				{
+				case InstructionSet::AVX512:
+					sumSourcesAvx512(sources.data(), sources.size(), out.data(), out.size());
+					return;
+				case InstructionSet::AVX2:
+					sumSourcesAvx2(sources.data(), sources.size(), out.data(), out.size());
+					return;
+				default:
+					break;
+				}
+#endif
+				for (size_t i = 0; i < out.size(); i++)
+				{
+					double sum = 0.0;
+					for (const double* const source : sources)
+						sum += source[i];
+					out[i] = sum;
+				}
+			}
+
+			void boxMuller(std::span<double> values)
+			{
+#if defined(DNF_COMPOSER_SIMD_X86)
+				switch (getInstructionSet())
+				{
+				case InstructionSet::AVX512:
+					boxMullerAvx512(values.data(), values.size());
+					return;
+				case InstructionSet::AVX2:
+					boxMullerAvx2(values.data(), values.size());
+					return;
+				default:
+					break;
+				}
+#endif
+				for (size_t i = 0; i + 2 <= values.size(); i += 2)
+					boxMullerScalar(values[i], values[i + 1]);
+			}
+
+			void convolveInterleavedRows(const double* input, const double* kernel, double* output,
+				size_t rows, size_t kernelSize, size_t outputSize)
+			{
+#if defined(DNF_COMPOSER_SIMD_X86)
+				switch (getInstructionSet())
+				{
+				case InstructionSet::AVX512:
+					convolveInterleavedRowsAvx512(input, kernel, output, rows, kernelSize, outputSize);
+					return;
+				case InstructionSet::AVX2:
+					convolveInterleavedRowsAvx2(input, kernel, output, rows, kernelSize, outputSize);
+					return;
+				default:
+					break;
+				}
+#endif
+				convolveInterleavedRowsScalar(input, kernel, output, rows, kernelSize, outputSize);
+			}
+
+			void integrateFieldRows(std::span<FieldRow> rows, size_t begin, size_t end)
+			{
+#if defined(DNF_COMPOSER_SIMD_X86)
+				// the rows are independent, lanes wider than four would only add transposes
+				if (getInstructionSet() != InstructionSet::SCALAR)
+				{
+					size_t r = 0;
+					for (; r + 4 <= rows.size(); r += 4)
+						integrateFourFieldRowsAvx2(rows.data() + r, begin, end);
+					for (; r < rows.size(); r++)
+						integrateFieldRowAvx2(rows[r], begin, end);
+					return;
+				}
+#endif
+				for (FieldRow& row : rows)
+				{
+					double lowest = row.lowest;
+					double highest = row.highest;
+					double sum = row.sum;
+					double sumOfSquares = row.sumOfSquares;
+					for (size_t i = begin; i < end; i++)
+					{
+						const double value = row.activation[i] + row.gain * (-row.activation[i] + row.restingLevel[i] + row.input[i]);
+						row.activation[i] = value;
+						lowest = std::min(lowest, value);
+						highest = std::max(highest, value);
+						sum += value;
+						sumOfSquares += value * value;
+					}
+					row.lowest = lowest;
+					row.highest = highest;
+					row.sum = sum;
+					row.sumOfSquares = sumOfSquares;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,138 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "tools/sparse_weights.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace math
+		{
+			SparseWeights::SparseWeights()
+				: storage(WeightStorage::DENSE), rows(0), columns(0), nonZeros(0)
+			{}
+
+			void SparseWeights::compress(std::span<const double> weights, size_t rows, size_t columns, double threshold)
+			{
+				this->rows = rows;
+				this->columns = columns;
+				rowOffsets.clear();
+				columnIndices.clear();
+				values.clear();
+
+				double largestMagnitude = 0.0;
+				for (const double weight : weights)
+					largestMagnitude = std::max(largestMagnitude, std::abs(weight));
+				const double cutOff = threshold * largestMagnitude;
+
+				// measure how many weights are kept and how wide the band of every row is
+				nonZeros = 0;
+				size_t bandFill = 0;
+				for (size_t j = 0; j < rows; j++)
+				{
+					const double* const row = weights.data() + j * columns;
+					size_t first = columns, last = 0;
+					for (size_t i = 0; i < columns; i++)
+					{
+						if (std::abs(row[i]) <= cutOff)
+							continue;
+						nonZeros++;
+						first = std::min(first, i);
+						last = i;
+					}
+					if (first < columns)
+						bandFill += last - first + 1;
+				}
+
+				const double total = static_cast<double>(rows * columns);
+				if (total > 0 && static_cast<double>(bandFill) <= maximumBandedDensity * total &&
+					static_cast<double>(bandFill) <= maximumBandFill * static_cast<double>(nonZeros))
+					storage = WeightStorage::BANDED;
+				else if (total > 0 && static_cast<double>(nonZeros) <= maximumSparseDensity * total)
+					storage = WeightStorage::CSR;
+				else
+				{
+					// the caller keeps multiplying the dense matrix
+					storage = WeightStorage::DENSE;
+					rowOffsets.shrink_to_fit();
+					columnIndices.shrink_to_fit();
+					values.shrink_to_fit();
+					return;
+				}
+
+				rowOffsets.reserve(rows + 1);
+				columnIndices.reserve(storage == WeightStorage::BANDED ? rows : nonZeros);
+				values.reserve(storage == WeightStorage::BANDED ? bandFill : nonZeros);
+				rowOffsets.push_back(0);
+				for (size_t j = 0; j < rows; j++)
+				{
+					const double* const row = weights.data() + j * columns;
+					if (storage == WeightStorage::BANDED)
+					{
+						size_t first = 0, end = 0;
+						for (size_t i = 0; i < columns; i++)
+						{
+							if (std::abs(row[i]) <= cutOff)
+								continue;
+							if (end == 0)
+								first = i;
+							end = i + 1;
+						}
+						columnIndices.push_back(static_cast<std::uint32_t>(first));
+						values.insert(values.end(), row + first, row + end);
+					}
+					else
+					{
+						for (size_t i = 0; i < columns; i++)
+						{
+							if (std::abs(row[i]) <= cutOff)
+								continue;
+							columnIndices.push_back(static_cast<std::uint32_t>(i));
+							values.push_back(row[i]);
+						}
+					}
+					rowOffsets.push_back(values.size());
+				}
+			}
+
+			void SparseWeights::multiply(std::span<const double> input, std::span<double> output, double scalar) const
+			{
+				std::ranges::fill(output, 0.0);
+
+				// the rows are added in order, so every output sums its terms in the same order as the dense product
+				for (size_t j = 0; j < rows; j++)
+				{
+					const double x = input[j];
+					if (x == 0.0)
+						continue;
+
+					const size_t begin = rowOffsets[j];
+					const size_t end = rowOffsets[j + 1];
+					if (storage == WeightStorage::BANDED)
+					{
+						double* const out = output.data() + columnIndices[j];
+						for (size_t k = begin; k < end; k++)
+							out[k - begin] += scalar * values[k] * x;
+					}
+					else
+					{
+						for (size_t k = begin; k < end; k++)
+							output[columnIndices[k]] += scalar * values[k] * x;
+					}
+				}
+			}
+
+			double SparseWeights::getDensity() const
+			{
+				if (rows == 0 || columns == 0)
+					return 0.0;
+				return static_cast<double>(nonZeros) / static_cast<double>(rows * columns);
+			}
+		}
+	}
+}
@@ -0,0 +1,152 @@
+// This is a personal academic project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: https://pvs-studio.com
+
+#include "tools/thread_pool.h"
+
+#include "tools/profiling.h"
+
+
+namespace dnf_composer
+{
+	namespace tools
+	{
+		namespace threading
+		{
+			namespace
+			{
+				thread_local bool insideWorker = false;
+			}
+
+			ThreadPool::ThreadPool(int numberOfWorkers)
+				: taskContext(nullptr), taskInvoker(nullptr), taskCount(0), nextIndex(0),
+					activeWorkers(0), generation(0), stopping(false)
+			{
+				if (numberOfWorkers <= 0)
+					numberOfWorkers = getHardwareConcurrency();
+
+				// the calling thread also executes tasks, so it counts as one of the workers
+				workers.reserve(numberOfWorkers - 1);
+				for (int i = 0; i < numberOfWorkers - 1; i++)
+					workers.emplace_back(&ThreadPool::workerLoop, this);
+			}
+
+			ThreadPool::~ThreadPool()
+			{
+				{
+					std::lock_guard lock(mutex);
+					stopping = true;
+				}
+				workAvailable.notify_all();
+				for (auto& worker : workers)
+					worker.join();
+			}
+
+			int ThreadPool::getNumberOfThreads() const
+			{
+				return static_cast<int>(workers.size()) + 1;
+			}
+
+			bool ThreadPool::isWorkerThread()
+			{
+				return insideWorker;
+			}
+
+			int ThreadPool::getHardwareConcurrency()
+			{
+				const unsigned int concurrency = std::thread::hardware_concurrency();
+				return concurrency == 0 ? 1 : static_cast<int>(concurrency);
+			}
+
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+			size_t ThreadPool::getWorkerAllocationCount() const
+			{
+				return workerAllocationCount.load(std::memory_order_relaxed);
+			}
+#endif
+
+			void ThreadPool::dispatch(size_t count, void* context, void (*invoker)(void*, size_t))
+			{
+				if (count == 0)
+					return;
+
+				if (workers.empty() || insideWorker || count == 1)
+				{
+					for (size_t i = 0; i < count; i++)
+						invoker(context, i);
+					return;
+				}
+
+				std::lock_guard dispatchLock(dispatchMutex);
+				{
+					std::lock_guard lock(mutex);
+					taskContext = context;
+					taskInvoker = invoker;
+					taskCount = count;
+					nextIndex.store(0);
+					activeWorkers = workers.size();
+					taskException = nullptr;
+					++generation;
+				}
+				workAvailable.notify_all();
+
+				insideWorker = true;
+				runTasks();
+				insideWorker = false;
+
+				std::unique_lock lock(mutex);
+				workFinished.wait(lock, [this] { return activeWorkers == 0; });
+				taskContext = nullptr;
+				taskInvoker = nullptr;
+				if (taskException)
+					std::rethrow_exception(taskException);
+			}
+
+			void ThreadPool::runTasks()
+			{
+				size_t index;
+				while ((index = nextIndex.fetch_add(1)) < taskCount)
+				{
+					try
+					{
+						taskInvoker(taskContext, index);
+					}
+					catch (...)
+					{
+						std::lock_guard lock(mutex);
+						if (!taskException)
+							taskException = std::current_exception();
+					}
+				}
+			}
+
+			void ThreadPool::workerLoop()
+			{
+				insideWorker = true;
+				std::uint64_t lastGeneration = 0;
+				while (true)
+				{
+					{
+						std::unique_lock lock(mutex);
+						workAvailable.wait(lock, [&] { return stopping || generation != lastGeneration; });
+						if (stopping)
+							return;
+						lastGeneration = generation;
+					}
+
+#ifdef DNF_COMPOSER_COUNT_ALLOCATIONS
+					const size_t allocationsBeforeTasks = profiling::getAllocationCount();
+					runTasks();
+					workerAllocationCount.fetch_add(profiling::getAllocationCount() - allocationsBeforeTasks, std::memory_order_relaxed);
+#else
+					runTasks();
+#endif
+
+					std::lock_guard lock(mutex);
+					if (--activeWorkers == 0)
+						workFinished.notify_one();
+				}
+			}
+		}
+	}
+}
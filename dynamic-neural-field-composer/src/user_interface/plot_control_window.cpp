@@ -73,8 +73,7 @@ namespace dnf_composer::user_interface
 						ImGui::Separator();
 						for (const auto& element : simulation->getElements())
 						{
-							for (const auto* components = element->getComponents();
-								const auto& name : *components | std::views::keys)
+							for (const auto& name : element->getComponentList())
 							{
 								const std::string item_label = element->getUniqueName() + " " + name;
 								if (ImGui::Selectable(item_label.c_str()))
@@ -61,7 +61,7 @@ namespace dnf_composer
 		return result.str();
 	}
 
-	void Heatmap::render(const std::vector<std::vector<double>*>& data, const std::vector<std::string>& legends)
+	void Heatmap::render(const std::vector<element::Component*>& data, const std::vector<std::string>& legends)
 	{
 		if (data.size() != 1)
 		{
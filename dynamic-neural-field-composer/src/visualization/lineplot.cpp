@@ -65,7 +65,7 @@ namespace dnf_composer
 		return result.str();
 	}
 
-	void LinePlot::render(const std::vector<std::vector<double>*>& data, const std::vector<std::string>& legends)
+	void LinePlot::render(const std::vector<element::Component*>& data, const std::vector<std::string>& legends)
 	{
         static constexpr double safeMargin = 0.01;
 		bool whereDimensionsChangedByUser = false;
@@ -210,7 +210,7 @@ namespace dnf_composer
 		for (size_t j = 0; j < data.size(); ++j) 
 		{
 			const std::string& label = legends[j];
-            const std::vector<double>& line_data = *data[j];
+            const element::Component& line_data = *data[j];
 
             std::vector<double> shiftedXValues(line_data.size());
             for (size_t i = 0; i < line_data.size(); ++i) 
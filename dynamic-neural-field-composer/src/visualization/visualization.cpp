@@ -168,7 +168,7 @@ namespace dnf_composer
 			}
 
 
-			std::vector<std::vector<double>*> allDataToPlotPtr;
+			std::vector<element::Component*> allDataToPlotPtr;
 			allDataToPlotPtr.reserve(data.size());
 			for (const auto& d : data)
 			{
@@ -0,0 +1,88 @@
+// Checks that adaptive stepping refuses quiescence skipping and step periods other than 1, which it would
+// otherwise ignore, and that a double-buffered simulation run adaptively keeps publishing in the steps after it.
+
+#include <functional>
+
+#include "test_harness.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	bool throwsInvalidParameter(const std::function<void()>& call)
+	{
+		try
+		{
+			call();
+		}
+		catch (const Exception& ex)
+		{
+			return ex.getErrorCode() == ErrorCode::SIM_INVALID_PARAMETER;
+		}
+		return false;
+	}
+
+	struct Architecture
+	{
+		std::shared_ptr<Simulation> simulation;
+		std::shared_ptr<element::NeuralField> field;
+		std::shared_ptr<element::GaussKernel> kernel;
+	};
+
+	Architecture makeArchitecture()
+	{
+		const auto simulation = std::make_shared<Simulation>("adaptive stepping", 1.0, 0.0, 0.0);
+		const auto [field, kernel] = addSelfExcitedField(*simulation, "field");
+		field->addInput(addElement<element::GaussStimulus>(*simulation, "stimulus", stimulusParameters()));
+		return { simulation, field, kernel };
+	}
+
+	void checkRejectedCombinations()
+	{
+		Architecture quiescent = makeArchitecture();
+		quiescent.simulation->setQuiescenceSkipping(true);
+		check(throwsInvalidParameter([&] { quiescent.simulation->setAdaptiveStepping(true); }),
+			"adaptive stepping refused with quiescence skipping");
+
+		Architecture adaptive = makeArchitecture();
+		adaptive.simulation->setAdaptiveStepping(true);
+		check(throwsInvalidParameter([&] { adaptive.simulation->setQuiescenceSkipping(true); }),
+			"quiescence skipping refused with adaptive stepping");
+
+		adaptive.kernel->setStepPeriod(2);
+		check(throwsInvalidParameter([&] { adaptive.simulation->run(10.0); }), "adaptive run refused with a step period of 2");
+		adaptive.kernel->setStepPeriod(1);
+		adaptive.simulation->run(10.0);
+		check(adaptive.simulation->getStepStatistics().acceptedSteps > 0, "adaptive run with a step period of 1");
+	}
+
+	void checkPublishingAfterAdaptiveRun()
+	{
+		Architecture adaptive = makeArchitecture();
+		adaptive.simulation->setDoubleBuffered(true);
+		adaptive.simulation->setAdaptiveStepping(true);
+		adaptive.simulation->init();
+		adaptive.simulation->run(50.0);
+
+		// the field is still forming its bump, so its output moves in every step
+		for (int i = 0; i < 3; i++)
+		{
+			const std::vector<double> output = adaptive.field->getComponent("output");
+			adaptive.simulation->step();
+			const element::Component& published = adaptive.field->getPublishedComponent("output");
+			check(std::vector<double>(published.begin(), published.end()) == output,
+				"step " + std::to_string(i + 1) + " after the adaptive run: output published");
+		}
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::FATAL);
+	checkRejectedCombinations();
+	checkPublishingAfterAdaptiveRun();
+
+	return finish("Adaptive stepping refuses what it would ignore.");
+}
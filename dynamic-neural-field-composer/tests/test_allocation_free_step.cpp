@@ -0,0 +1,130 @@
+// Checks that the steady-state simulation step makes no heap allocations, serial and parallel, with and without
+// double buffering, in one stage and in the four of RK4, with noise and a coupling that learns, while another thread allocates all the time,
+// and that a Gauss field coupling evaluated from its profiles only builds its dense weights when they are read,
+// and publishes them then, so reading them does not make the steps after allocate.
+// Built against the library compiled with DNF_COMPOSER_COUNT_ALLOCATIONS, see CMakeLists.txt.
+
+#ifndef DNF_COMPOSER_COUNT_ALLOCATIONS
+#error "test_allocation_free_step counts allocations, it must be built with DNF_COMPOSER_COUNT_ALLOCATIONS"
+#endif
+
+#include <thread>
+#include <atomic>
+
+#include "test_harness.h"
+#include "elements/gauss_field_coupling.h"
+#include "elements/field_coupling.h"
+#include "elements/normal_noise.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	struct Configuration
+	{
+		std::string name;
+		ExecutionMode executionMode;
+		bool doubleBuffered;
+		element::Integrator integrator = element::Integrator::EULER;
+	};
+
+	void checkAllocationFreeSteps(const Configuration& configuration)
+	{
+		Simulation simulation(configuration.name, 1.0, 0.0, 0.0);
+		simulation.setSeed(7);
+		const auto input = addSelfExcitedField(simulation, "input field").field;
+		const auto output = addElement<element::NeuralField>(simulation, "output field", fieldParameters());
+		const auto stimulus = addElement<element::GaussStimulus>(simulation, "stimulus", stimulusParameters(25.0));
+		const auto noise = addElement<element::NormalNoise>(simulation, "noise", element::NormalNoiseParameters{ 0.2 });
+		// a single coupling is evaluated from its profiles, not from the weights
+		const auto gaussCoupling = addElement<element::GaussFieldCoupling>(simulation, "gauss coupling",
+			element::GaussFieldCouplingParameters{ dimensions, true, false, { { 25.0, 75.0, 5.0, 3.0 } } });
+		const auto learningCoupling = addElement<element::FieldCoupling>(simulation, "learning coupling",
+			element::FieldCouplingParameters{ dimensions, LearningRule::HEBB, 1.0, 0.01 });
+		input->addInput(stimulus);
+		input->addInput(noise);
+		gaussCoupling->addInput(input);
+		learningCoupling->addInput(input);
+		output->addInput(gaussCoupling);
+		output->addInput(learningCoupling);
+		for (const auto& field : { input, output })
+		{
+			element::NeuralFieldParameters parameters = field->getParameters();
+			parameters.integrator = configuration.integrator;
+			field->setParameters(parameters);
+		}
+		simulation.setExecutionMode(configuration.executionMode);
+		simulation.setNumberOfWorkers(4);
+		simulation.setDoubleBuffered(configuration.doubleBuffered);
+		simulation.init();
+		learningCoupling->setLearning(true);
+
+		check(gaussCoupling->isUsingLowRankEvaluation(), configuration.name + ": coupling evaluated from its profiles");
+		check(gaussCoupling->getComponents()->at("weights").empty(), configuration.name + ": weights not built in init()");
+
+		// the first steps compile the plan and follow the start of learning, they may allocate
+		simulation.step();
+		simulation.step();
+		// the weights are built outside the steps that follow
+		check(gaussCoupling->getComponent("weights").size() == static_cast<size_t>(dimensions.size * dimensions.size),
+			configuration.name + ": weights built when read");
+
+		std::atomic<bool> stepping{ true };
+		std::atomic<size_t> allocatedBlocks{ 0 };
+		std::thread allocator([&stepping, &allocatedBlocks]
+		{
+			// the block escapes through an atomic, so the allocation is not optimized away
+			static std::atomic<const double*> lastBlock{ nullptr };
+			while (stepping.load())
+			{
+				const std::vector<double> block(64);
+				lastBlock = block.data();
+				allocatedBlocks++;
+			}
+		});
+		// the steps go on until the other thread has allocated in between them
+		const size_t allocationsBeforeSteps = simulation.getSteadyStateStepAllocations();
+		for (int i = 0; i < 200 || allocatedBlocks.load() < 1000; i++)
+			simulation.step();
+		const size_t allocationsDuringSteps = simulation.getSteadyStateStepAllocations() - allocationsBeforeSteps;
+		stepping = false;
+		allocator.join();
+		check(allocationsDuringSteps == 0, configuration.name + ": steps made " + std::to_string(allocationsDuringSteps) + " allocations");
+	}
+
+	void checkPublishedWeights()
+	{
+		Simulation simulation("published weights", 1.0, 0.0, 0.0);
+		const auto input = addElement<element::NeuralField>(simulation, "input field", fieldParameters());
+		const auto coupling = addElement<element::GaussFieldCoupling>(simulation, "coupling",
+			element::GaussFieldCouplingParameters{ dimensions, true, false, { { 25.0, 75.0, 5.0, 3.0 } } });
+		coupling->addInput(input);
+		simulation.setDoubleBuffered(true);
+		simulation.init();
+		simulation.step();
+
+		const std::vector<double> weights = coupling->getComponent("weights");
+		check(published(*coupling, "weights") == weights, "weights published when read");
+		simulation.step();
+		check(published(*coupling, "weights") == weights, "weights still published after a step");
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+	for (const Configuration& configuration : {
+		Configuration{ "serial", ExecutionMode::SERIAL, false },
+		Configuration{ "serial double-buffered", ExecutionMode::SERIAL, true },
+		Configuration{ "parallel levels", ExecutionMode::PARALLEL_LEVELS, false },
+		Configuration{ "parallel levels double-buffered", ExecutionMode::PARALLEL_LEVELS, true },
+		Configuration{ "type sorted", ExecutionMode::TYPE_SORTED, false },
+		Configuration{ "serial RK4", ExecutionMode::SERIAL, false, element::Integrator::RK4 },
+		Configuration{ "type sorted RK4", ExecutionMode::TYPE_SORTED, false, element::Integrator::RK4 } })
+		checkAllocationFreeSteps(configuration);
+	checkPublishedWeights();
+
+	return finish("Steps are allocation free.");
+}
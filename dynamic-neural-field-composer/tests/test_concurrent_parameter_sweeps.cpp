@@ -0,0 +1,90 @@
+// Runs two parameter sweeps at the same time, each over its own thread pool, and checks that the execution plan
+// of every point is compiled exactly once: the connections made while one sweep builds its points must not make
+// the plans of the points the other sweep is running stale. Both sweeps must also get the same results.
+
+#include <filesystem>
+#include <thread>
+
+#include "test_harness.h"
+#include "simulation/parameter_sweep.h"
+#include "elements/normal_noise.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	std::string saveSimulation(const std::string& directory)
+	{
+		const auto simulation = std::make_shared<Simulation>("concurrent sweeps", 1.0, 0.0, 0.0);
+		const auto nf = addElement<element::NeuralField>(*simulation, "nf",
+			element::NeuralFieldParameters{ 20.0, -5.0, element::SigmoidFunction{ 0.0, 4.0 } });
+		const auto gk = addElement<element::GaussKernel>(*simulation, "gk", element::GaussKernelParameters{ 3.0, 10.0 });
+		const auto gs = addElement<element::GaussStimulus>(*simulation, "gs", element::GaussStimulusParameters{ 5.0, 8.0, 50.0 });
+		const auto nn = addElement<element::NormalNoise>(*simulation, "nn", element::NormalNoiseParameters{ 0.2 });
+		nf->addInput(gk);
+		gk->addInput(nf);
+		nf->addInput(gs);
+		nf->addInput(nn);
+
+		simulation->save(directory);
+		return directory + simulation->getUniqueIdentifier() + ".json";
+	}
+}
+
+int main()
+{
+	try
+	{
+		tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+
+		const std::string directory = (std::filesystem::temp_directory_path() / "dnf-composer-concurrent-sweeps").string() + "/";
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		const std::string simulationFilePath = saveSimulation(directory);
+
+		SweepSpecification specification;
+		specification.runTime = 100.0;
+		specification.seed = 1;
+		specification.parameters = { { "nf", "tau", { 10.0, 20.0 } }, { "gs", "position", { 20.0, 40.0, 60.0, 80.0 } } };
+
+		ParameterSweep firstSweep(simulationFilePath, specification, directory + "first results.jsonl");
+		ParameterSweep secondSweep(simulationFilePath, specification, directory + "second results.jsonl");
+		firstSweep.setNumberOfWorkers(2);
+		secondSweep.setNumberOfWorkers(2);
+
+		std::vector<SweepPointResult> firstResults;
+		std::vector<SweepPointResult> secondResults;
+		std::thread firstThread([&] { firstResults = firstSweep.run(); });
+		std::thread secondThread([&] { secondResults = secondSweep.run(); });
+		firstThread.join();
+		secondThread.join();
+
+		const size_t numberOfPoints = firstSweep.getPoints().size();
+		check(firstResults.size() == numberOfPoints && secondResults.size() == numberOfPoints, "a sweep did not return every point");
+		check(firstSweep.getNumberOfPlanCompilations() == numberOfPoints, "the first sweep compiled " +
+			std::to_string(firstSweep.getNumberOfPlanCompilations()) + " plans for " + std::to_string(numberOfPoints) + " points");
+		check(secondSweep.getNumberOfPlanCompilations() == numberOfPoints, "the second sweep compiled " +
+			std::to_string(secondSweep.getNumberOfPlanCompilations()) + " plans for " + std::to_string(numberOfPoints) + " points");
+		for (size_t p = 0; p < std::min(firstResults.size(), secondResults.size()); p++)
+		{
+			const auto& first = firstResults[p];
+			const auto& second = secondResults[p];
+			check(!first.cached && !second.cached, "point " + std::to_string(p) + " was read from a result file");
+			bool same = first.hash == second.hash && first.fields.size() == second.fields.size();
+			for (size_t f = 0; same && f < first.fields.size(); f++)
+				same = first.fields[f].numberOfBumps == second.fields[f].numberOfBumps && first.fields[f].centroids == second.fields[f].centroids;
+			check(same, "point " + std::to_string(p) + " has different results in the two sweeps");
+		}
+
+		std::filesystem::remove_all(directory);
+	}
+	catch (const std::exception& ex)
+	{
+		std::cerr << "FAILED: exception " << ex.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return finish("Concurrent sweeps compiled one execution plan per point.");
+}
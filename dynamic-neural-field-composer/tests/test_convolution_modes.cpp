@@ -0,0 +1,67 @@
+// Checks that a kernel convolved through the FFT gives the output of the direct convolution, up to rounding,
+// for Gauss and Mexican hat kernels, circular or not, wide enough for the automatic mode to choose the FFT.
+
+#include <cmath>
+#include <numeric>
+
+#include "test_harness.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	// largest difference between the FFT and the direct convolution of the same input, relative to the sum
+	// of the magnitudes of the kernel, the bound of the error of the output of a field, which lies in [0, 1]
+	constexpr double tolerance = 1e-12;
+
+	template <typename KernelType, typename Parameters>
+	void checkFftConvolution(const std::string& name, const Parameters& parameters)
+	{
+		Simulation simulation(name, 1.0, 0.0, 0.0);
+		const element::ElementDimensions fieldDimensions{ 360, 1.0 };
+		const auto field = addElement<element::NeuralField>(simulation, "field", fieldParameters(), fieldDimensions);
+		field->addInput(addElement<element::GaussStimulus>(simulation, "stimulus 1", stimulusParameters(60.0), fieldDimensions));
+		field->addInput(addElement<element::GaussStimulus>(simulation, "stimulus 2", element::GaussStimulusParameters{ 20.0, 8.0, 300.0 }, fieldDimensions));
+		const auto direct = addElement<KernelType>(simulation, "direct kernel", parameters, fieldDimensions);
+		const auto fft = addElement<KernelType>(simulation, "fft kernel", parameters, fieldDimensions);
+		direct->setConvolutionMode(element::ConvolutionMode::DIRECT);
+		fft->setConvolutionMode(element::ConvolutionMode::FFT);
+		direct->addInput(field);
+		fft->addInput(field);
+		simulation.init();
+
+		check(!direct->isUsingFftConvolution(), name + ": direct kernel convolved directly");
+		check(fft->isUsingFftConvolution(), name + ": fft kernel convolved through the FFT");
+
+		const std::vector<double> kernel = direct->getComponent("kernel");
+		const double magnitude = std::accumulate(kernel.begin(), kernel.end(), 0.0,
+			[](double sum, double value) { return sum + std::abs(value); });
+		double largestDifference = 0.0;
+		for (int i = 0; i < 100; i++)
+		{
+			simulation.step();
+			const std::vector<double> directOutput = direct->getComponent("output");
+			const std::vector<double> fftOutput = fft->getComponent("output");
+			for (size_t j = 0; j < directOutput.size(); j++)
+				largestDifference = std::max(largestDifference, std::abs(directOutput[j] - fftOutput[j]));
+		}
+		check(largestDifference <= tolerance * magnitude, name + ": largest difference " + std::to_string(largestDifference / magnitude)
+			+ " of the kernel magnitude");
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+
+	checkFftConvolution<element::GaussKernel>("circular Gauss kernel", element::GaussKernelParameters{ 25.0, 3.0, -0.01, true });
+	checkFftConvolution<element::GaussKernel>("Gauss kernel", element::GaussKernelParameters{ 25.0, 3.0, -0.01, false });
+	checkFftConvolution<element::MexicanHatKernel>("circular Mexican hat kernel",
+		element::MexicanHatKernelParameters{ 10.0, 15.0, 30.0, 15.0, -0.01, true });
+	checkFftConvolution<element::MexicanHatKernel>("Mexican hat kernel",
+		element::MexicanHatKernelParameters{ 10.0, 15.0, 30.0, 15.0, -0.01, false });
+
+	return finish("FFT convolution matches the direct convolution.");
+}
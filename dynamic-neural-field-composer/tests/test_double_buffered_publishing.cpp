@@ -0,0 +1,107 @@
+// Checks that in double-buffered mode the components an element publishes match its own after the step
+// that follows, when constant components are not copied again: a kernel given new parameters and
+// the weights of a coupling that learns. An element that is not stepped, a kernel with a step period
+// or a field held by quiescence skipping, must still have the outputs it publishes.
+
+#include <array>
+
+#include "test_harness.h"
+#include "elements/field_coupling.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	void checkKernelParameterChange()
+	{
+		Simulation simulation("kernel parameter change", 1.0, 0.0, 0.0);
+		const auto [field, kernel] = addSelfExcitedField(simulation, "field");
+		simulation.setDoubleBuffered(true);
+		simulation.init();
+
+		for (int i = 0; i < 3; i++)
+			simulation.step();
+		check(published(*kernel, "kernel") == kernel->getComponent("kernel"), "kernel published after init");
+
+		kernel->setParameters(element::GaussKernelParameters{ 6.0, 5.0, -0.02 });
+		simulation.step();
+		check(published(*kernel, "kernel") == kernel->getComponent("kernel"), "kernel published after new parameters");
+	}
+
+	void checkLearningWeights()
+	{
+		Simulation simulation("learning weights", 1.0, 0.0, 0.0);
+		const element::ElementDimensions smallDimensions{ 50, 1.0 };
+		const auto input = addElement<element::NeuralField>(simulation, "input field", fieldParameters(), smallDimensions);
+		const auto output = addElement<element::NeuralField>(simulation, "output field", fieldParameters(), smallDimensions);
+		const auto stimulus = addElement<element::GaussStimulus>(simulation, "stimulus", stimulusParameters(25.0), smallDimensions);
+		const auto coupling = addElement<element::FieldCoupling>(simulation, "coupling",
+			element::FieldCouplingParameters{ smallDimensions, LearningRule::HEBB, 1.0, 0.1 }, smallDimensions);
+		input->addInput(stimulus);
+		output->addInput(stimulus);
+		coupling->addInput(input);
+		output->addInput(coupling);
+		simulation.setDoubleBuffered(true);
+		simulation.init();
+
+		coupling->setLearning(true);
+		simulation.step();
+		for (int i = 0; i < 5; i++)
+		{
+			// a step publishes what the step before it learnt
+			const std::vector<double> weights = coupling->getComponent("weights");
+			simulation.step();
+			const std::string step = "learning step " + std::to_string(i + 1);
+			check(published(*coupling, "weights") == weights, step + ": learnt weights published");
+			check(coupling->getComponent("weights") != weights, step + ": weights learnt");
+		}
+
+		coupling->setLearning(false);
+		const std::vector<double> learntWeights = coupling->getComponent("weights");
+		simulation.step();
+		check(published(*coupling, "weights") == learntWeights, "weights published after learning stops");
+		simulation.step();
+		check(published(*coupling, "weights") == learntWeights, "weights unchanged after learning stops");
+	}
+
+	void checkHeldElements()
+	{
+		Simulation simulation("held elements", 1.0, 0.0, 0.0);
+		const auto [field, kernel] = addSelfExcitedField(simulation, "field");
+		field->addInput(addElement<element::GaussStimulus>(simulation, "stimulus", stimulusParameters()));
+		kernel->setStepPeriod(4);
+		simulation.setQuiescenceSkipping(true);
+		simulation.setQuiescenceTolerance(1e-3);
+		simulation.setDoubleBuffered(true);
+		simulation.init();
+
+		std::array<int, 2> heldSteps{};
+		const std::array<element::Element*, 2> heldElements{ field.get(), kernel.get() };
+		for (std::int64_t step = 0; step < 300; step++)
+		{
+			simulation.step();
+			for (size_t e = 0; e < heldElements.size(); e++)
+			{
+				element::Element& element = *heldElements[e];
+				if (element.getStepRecord().lastStep == step)
+					continue;
+				heldSteps[e]++;
+				check(published(element, "output") == element.getComponent("output"),
+					"step " + std::to_string(step) + ": '" + element.getUniqueName() + "' held with the outputs it published");
+			}
+		}
+		check(heldSteps[0] > 0, "field held by quiescence skipping");
+		check(heldSteps[1] > 0, "kernel held between its steps");
+	}
+}
+
+int main()
+{
+	checkKernelParameterChange();
+	checkLearningWeights();
+	checkHeldElements();
+
+	return finish("Published components match.");
+}
@@ -0,0 +1,129 @@
+// Checks that every instance of an ensemble computes bit for bit what it computes alone in the type-sorted mode
+// with its instance seed, on every instruction set the processor supports and with one or several groups of
+// instances: the instances give their kernels widths of their own, so the kernels convolved across the instances
+// have different sizes, some kernels do not wrap around the field, and the fields and noise have an odd size.
+// Also checks that a run is the same on every instruction set, and that an odd number of normal numbers is
+// the start of the even number drawn after it.
+
+#include "test_harness.h"
+#include "simulation/ensemble_simulation.h"
+#include "tools/simd.h"
+#include "tools/rng.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	constexpr size_t numberOfInstances = 7;
+	constexpr int steps = 60;
+	constexpr std::uint64_t seed = 17;
+	const element::ElementDimensions oddDimensions{ 101, 1.0 };
+
+	std::shared_ptr<Simulation> buildInstance(size_t instance)
+	{
+		const auto simulation = std::make_shared<Simulation>("ensemble instance " + std::to_string(instance), 1.0, 0.0, 0.0);
+		const double width = 2.0 + static_cast<double>(instance % 3);
+
+		const auto even = addElement<element::NeuralField>(*simulation, "even field", fieldParameters());
+		const auto evenKernel = addElement<element::GaussKernel>(*simulation, "even kernel", element::GaussKernelParameters{ width, 3.0, -0.01 });
+		even->addInput(evenKernel);
+		evenKernel->addInput(even);
+		even->addInput(addElement<element::GaussStimulus>(*simulation, "even stimulus", stimulusParameters(20.0 + 8.0 * static_cast<double>(instance))));
+		even->addInput(addElement<element::NormalNoise>(*simulation, "even noise", element::NormalNoiseParameters{ 0.3 }));
+
+		const auto odd = addElement<element::NeuralField>(*simulation, "odd field", fieldParameters(), oddDimensions);
+		const auto oddKernel = addElement<element::MexicanHatKernel>(*simulation, "odd kernel",
+			element::MexicanHatKernelParameters{ width, 15.0, 2 * width, 10.0, -0.01 }, oddDimensions);
+		odd->addInput(oddKernel);
+		oddKernel->addInput(odd);
+		odd->addInput(addElement<element::GaussStimulus>(*simulation, "odd stimulus", stimulusParameters(50.0), oddDimensions));
+		odd->addInput(addElement<element::NormalNoise>(*simulation, "odd noise", element::NormalNoiseParameters{ 0.3 }, oddDimensions));
+
+		// a kernel that does not wrap around, between fields of the same size
+		const auto second = addElement<element::NeuralField>(*simulation, "second field", fieldParameters());
+		const auto edgeKernel = addElement<element::GaussKernel>(*simulation, "edge kernel",
+			element::GaussKernelParameters{ width + 1.0, 4.0, 0.0, false });
+		edgeKernel->addInput(even);
+		second->addInput(edgeKernel);
+		return simulation;
+	}
+
+	AllComponents runAlone(size_t instance)
+	{
+		const auto simulation = buildInstance(instance);
+		simulation->setSeed(EnsembleSimulation::getInstanceSeed(seed, instance));
+		simulation->setExecutionMode(ExecutionMode::TYPE_SORTED);
+		simulation->init();
+		for (int i = 0; i < steps; i++)
+			simulation->step();
+		return getAllComponents(*simulation);
+	}
+
+	std::vector<AllComponents> runEnsemble(int numberOfWorkers)
+	{
+		EnsembleSimulation ensemble(numberOfInstances, buildInstance, seed);
+		ensemble.setNumberOfWorkers(numberOfWorkers);
+		ensemble.init();
+		for (int i = 0; i < steps; i++)
+			ensemble.step();
+		std::vector<AllComponents> components;
+		for (size_t i = 0; i < numberOfInstances; i++)
+			components.push_back(getAllComponents(*ensemble.getInstance(i)));
+		return components;
+	}
+
+	void checkInstances(tools::simd::InstructionSet instructionSet, std::vector<AllComponents>& scalarRuns)
+	{
+		tools::simd::setInstructionSet(instructionSet);
+		if (tools::simd::getInstructionSet() != instructionSet)
+			return;
+		const std::string name = tools::simd::getInstructionSetName();
+
+		std::vector<AllComponents> alone;
+		for (size_t i = 0; i < numberOfInstances; i++)
+			alone.push_back(runAlone(i));
+		for (const int numberOfWorkers : { 1, 3 })
+		{
+			const std::vector<AllComponents> ensemble = runEnsemble(numberOfWorkers);
+			for (size_t i = 0; i < numberOfInstances; i++)
+				checkSameComponents(alone[i], ensemble[i], name + ", " + std::to_string(numberOfWorkers) + " group(s), instance " + std::to_string(i));
+		}
+
+		if (instructionSet == tools::simd::InstructionSet::SCALAR)
+			scalarRuns = alone;
+		else
+			for (size_t i = 0; i < numberOfInstances; i++)
+				checkSameComponents(scalarRuns[i], alone[i], name + " against scalar, instance " + std::to_string(i));
+	}
+
+	void checkOddNormalNumbers()
+	{
+		tools::rng::PhiloxGenerator generator(seed, 3);
+		for (const size_t size : { size_t{ 1 }, size_t{ 3 }, size_t{ 5 }, size_t{ 101 } })
+		{
+			std::vector<double> odd(size);
+			std::vector<double> even(size + 1);
+			const std::uint64_t counter = generator.getCounter();
+			generator.fillNormal(odd);
+			generator.setCounter(counter);
+			generator.fillNormal(even);
+			check(std::equal(odd.begin(), odd.end(), even.begin()),
+				std::to_string(size) + " normal numbers are the start of " + std::to_string(size + 1));
+		}
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+	const tools::simd::InstructionSet detected = tools::simd::getInstructionSet();
+	std::vector<AllComponents> scalarRuns;
+	for (const auto instructionSet : { tools::simd::InstructionSet::SCALAR, tools::simd::InstructionSet::AVX2, tools::simd::InstructionSet::AVX512 })
+		checkInstances(instructionSet, scalarRuns);
+	tools::simd::setInstructionSet(detected);
+	checkOddNormalNumbers();
+
+	return finish("Every instance of an ensemble computes what it computes alone.");
+}
@@ -0,0 +1,42 @@
+// Checks that the execution modes are interchangeable: an architecture stepped level by level in parallel,
+// or sorted by type with its neural fields integrated as the rows of one matrix, ends with bit for bit the
+// components it ends with when stepped serially, with and without double buffering.
+
+#include "test_harness.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	AllComponents run(ExecutionMode executionMode, bool doubleBuffered, int steps)
+	{
+		Simulation simulation("execution modes", 1.0, 0.0, 0.0);
+		simulation.setSeed(42);
+		addActionSelectionArchitecture(simulation);
+		simulation.setExecutionMode(executionMode);
+		simulation.setNumberOfWorkers(4);
+		simulation.setDoubleBuffered(doubleBuffered);
+		simulation.init();
+		for (int i = 0; i < steps; i++)
+			simulation.step();
+		return getAllComponents(simulation);
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+
+	constexpr int steps = 200;
+	for (const bool doubleBuffered : { false, true })
+	{
+		const std::string buffering = doubleBuffered ? " double-buffered" : "";
+		const AllComponents serial = run(ExecutionMode::SERIAL, doubleBuffered, steps);
+		checkSameComponents(serial, run(ExecutionMode::PARALLEL_LEVELS, doubleBuffered, steps), "parallel levels" + buffering);
+		checkSameComponents(serial, run(ExecutionMode::TYPE_SORTED, doubleBuffered, steps), "type sorted" + buffering);
+	}
+
+	return finish("Every execution mode gives the serial results.");
+}
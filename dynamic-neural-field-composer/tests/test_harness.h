@@ -0,0 +1,180 @@
+#pragma once
+
+// What the tests share: a check that counts failures instead of stopping at the first one, the exit code
+// that reports them, the field, kernel and stimulus most tests build their architectures from, and an
+// architecture with every common kind of element, for the tests that compare whole runs.
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <type_traits>
+
+#include "simulation/simulation.h"
+#include "elements/neural_field.h"
+#include "elements/gauss_kernel.h"
+#include "elements/gauss_stimulus.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/normal_noise.h"
+#include "elements/gauss_field_coupling.h"
+
+namespace dnf_composer
+{
+	namespace test
+	{
+		inline int failures = 0;
+
+		inline void check(bool condition, const std::string& message)
+		{
+			if (condition)
+				return;
+			std::cerr << "FAILED: " << message << '\n';
+			failures++;
+		}
+
+		// the exit code of the test, the message is printed if every check passed
+		inline int finish(const std::string& message)
+		{
+			if (failures != 0)
+			{
+				std::cerr << failures << " check(s) failed.\n";
+				return EXIT_FAILURE;
+			}
+			std::cout << message << '\n';
+			return EXIT_SUCCESS;
+		}
+
+		inline const element::ElementDimensions dimensions{ 100, 1.0 };
+
+		inline element::NeuralFieldParameters fieldParameters(double tau = 25.0)
+		{
+			return { tau, -5.0, element::SigmoidFunction{ 0.0, 10.0 } };
+		}
+
+		inline element::GaussKernelParameters kernelParameters()
+		{
+			return { 3.0, 3.0, -0.01 };
+		}
+
+		inline element::GaussStimulusParameters stimulusParameters(double position = 50.0)
+		{
+			return { 5.0, 15.0, position };
+		}
+
+		template <typename ElementType, typename Parameters>
+		std::shared_ptr<ElementType> addElement(Simulation& simulation, const std::string& name, const Parameters& parameters,
+			const element::ElementDimensions& elementDimensions = dimensions)
+		{
+			const auto element = std::make_shared<ElementType>(element::ElementCommonParameters{ name, elementDimensions }, parameters);
+			simulation.addElement(element);
+			return element;
+		}
+
+		// a neural field exciting itself through a Gauss kernel
+		struct SelfExcitedField
+		{
+			std::shared_ptr<element::NeuralField> field;
+			std::shared_ptr<element::GaussKernel> kernel;
+		};
+
+		inline SelfExcitedField addSelfExcitedField(Simulation& simulation, const std::string& name,
+			const element::ElementDimensions& elementDimensions = dimensions)
+		{
+			const auto field = addElement<element::NeuralField>(simulation, name, fieldParameters(), elementDimensions);
+			const auto kernel = addElement<element::GaussKernel>(simulation, name + " kernel", kernelParameters(), elementDimensions);
+			field->addInput(kernel);
+			kernel->addInput(field);
+			return { field, kernel };
+		}
+
+		inline std::vector<double> published(const element::Element& element, const std::string& componentName)
+		{
+			const element::Component& component = element.getPublishedComponent(componentName);
+			return { component.begin(), component.end() };
+		}
+
+		// the architecture of ex_complementary_action_selection, 25 elements with a Gauss field coupling besides
+		// the kernel couplings, its connections are made in the opposite order when reverseConnections is set
+		inline void addActionSelectionArchitecture(Simulation& simulation, bool reverseConnections = false)
+		{
+			const element::NeuralFieldParameters parameters{ 25.0, -10.0, element::SigmoidFunction{ 0.0, 5.0 } };
+			const auto hpf = addElement<element::NeuralField>(simulation, "hand position field", parameters);
+			const auto sof = addElement<element::NeuralField>(simulation, "small object field", parameters);
+			const auto lof = addElement<element::NeuralField>(simulation, "large object field", parameters);
+			const auto aef = addElement<element::NeuralField>(simulation, "action execution field", parameters);
+			const auto sos = addElement<element::NeuralField>(simulation, "small object selection field", parameters);
+			const auto loif = addElement<element::NeuralField>(simulation, "large object integration field", parameters);
+
+			std::vector<std::pair<std::shared_ptr<element::Element>, std::shared_ptr<element::Element>>> connections;
+			const auto connect = [&](const std::shared_ptr<element::Element>& source, const std::shared_ptr<element::Element>& target)
+			{
+				connections.emplace_back(source, target);
+			};
+			const auto couple = [&](const std::string& name, const auto& kernelParameters,
+				const std::shared_ptr<element::NeuralField>& source, const std::shared_ptr<element::NeuralField>& target)
+			{
+				using KernelType = std::conditional_t<std::is_same_v<std::decay_t<decltype(kernelParameters)>, element::MexicanHatKernelParameters>,
+					element::MexicanHatKernel, element::GaussKernel>;
+				const auto kernel = addElement<KernelType>(simulation, name, kernelParameters);
+				connect(source, kernel);
+				connect(kernel, target);
+			};
+
+			connect(addElement<element::GaussStimulus>(simulation, "hand position stimulus", stimulusParameters(50.0)), hpf);
+			connect(addElement<element::GaussStimulus>(simulation, "small object 1 stimulus", stimulusParameters(20.0)), sof);
+			connect(addElement<element::GaussStimulus>(simulation, "small object 2 stimulus", stimulusParameters(80.0)), sof);
+			connect(addElement<element::GaussStimulus>(simulation, "large object stimulus", stimulusParameters(50.0)), lof);
+
+			couple("hpf kernel", element::GaussKernelParameters{ 20.0, 2.0, -0.01 }, hpf, hpf);
+			couple("sof kernel", element::MexicanHatKernelParameters{ 5.0, 15.0, 10.0, 15.0, -0.01 }, sof, sof);
+			couple("lof kernel", element::GaussKernelParameters{ 20.0, 2.0, -0.01 }, lof, lof);
+			couple("sosf kernel", element::GaussKernelParameters{ 18.92, 23.22, -0.23 }, sos, sos);
+			couple("loif kernel", element::GaussKernelParameters{ 20.0, 2.0, -0.01 }, loif, loif);
+			couple("aef kernel", element::GaussKernelParameters{ 5.09, 7.85, -0.42 }, aef, aef);
+			couple("hpf - loif coupling", element::GaussKernelParameters{ 5.0, 10.47, 0.0 }, hpf, loif);
+			couple("hpf - sosf coupling", element::GaussKernelParameters{ 5.0, -6.65, 0.0 }, hpf, sos);
+			couple("sof - sosf coupling", element::GaussKernelParameters{ 2.96, 10.75, 0.0 }, sof, sos);
+			couple("lof - loif coupling", element::GaussKernelParameters{ 5.0, 10.17, 0.0 }, lof, loif);
+			couple("sosf - aef coupling", element::GaussKernelParameters{ 5.0, 26.0, 0.0 }, sos, aef);
+			couple("loif - aef coupling", element::GaussKernelParameters{ 5.0, 26.0, 0.0 }, loif, aef);
+
+			connect(addElement<element::NormalNoise>(simulation, "sosf normal noise", element::NormalNoiseParameters{ 0.32 }), sos);
+			connect(addElement<element::NormalNoise>(simulation, "aef normal noise", element::NormalNoiseParameters{ 0.36 }), aef);
+			const auto gfc = addElement<element::GaussFieldCoupling>(simulation, "hpf - aef gauss coupling",
+				element::GaussFieldCouplingParameters{ dimensions, false, false, { { 50.0, 30.0, 3.0, 5.0 }, { 20.0, 70.0, 2.0, 5.0 } } });
+			connect(hpf, gfc);
+			connect(gfc, aef);
+
+			if (reverseConnections)
+				std::ranges::reverse(connections);
+			for (const auto& [source, target] : connections)
+				target->addInput(source);
+		}
+
+		using AllComponents = std::map<std::string, std::vector<std::vector<double>>>;
+
+		// every component of every element, by element name
+		inline AllComponents getAllComponents(const Simulation& simulation)
+		{
+			AllComponents result;
+			for (const auto& element : simulation.getElements())
+				for (const std::string& componentName : element->getComponentList())
+					result[element->getUniqueName()].push_back(element->getComponent(componentName));
+			return result;
+		}
+
+		// checks that two runs ended with the same components, bit for bit, every element that differs fails
+		inline void checkSameComponents(const AllComponents& first, const AllComponents& second, const std::string& what)
+		{
+			check(first.size() == second.size(), what + ": different elements");
+			for (const auto& [name, components] : first)
+			{
+				const auto other = second.find(name);
+				check(other != second.end() && other->second == components, what + ": '" + name + "' differs");
+			}
+		}
+	}
+}
@@ -0,0 +1,189 @@
+// Checks that Heun and RK4 take their stages with inputs computed from the state of every stage: on a field that
+// excites itself their error falls with the second and fourth power of the step size, where a scheme holding the
+// input over the step stays first order. Also checks that the noise is drawn once per step, that every execution
+// mode and an ensemble give bit for bit the same multi-stage steps, and that double buffering, which would delay the inputs of
+// every stage by a stage, is refused.
+
+#include <cmath>
+
+#include "test_harness.h"
+#include "simulation/ensemble_simulation.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	void setIntegrator(const Simulation& simulation, element::Integrator integrator)
+	{
+		for (const auto& element : simulation.getElements())
+			if (const auto field = std::dynamic_pointer_cast<element::NeuralField>(element))
+			{
+				element::NeuralFieldParameters parameters = field->getParameters();
+				parameters.integrator = integrator;
+				field->setParameters(parameters);
+			}
+	}
+
+	// activation of a field exciting itself while its bump forms, every 4 time units, the sigmoid is not steep,
+	// so the step sizes compared are small enough for the error to fall with the order of the integrator
+	std::vector<double> runSelfExcitedField(element::Integrator integrator, double deltaT)
+	{
+		Simulation simulation("self-excited field", deltaT, 0.0, 0.0);
+		const auto field = addElement<element::NeuralField>(simulation, "field",
+			element::NeuralFieldParameters{ 25.0, -5.0, element::SigmoidFunction{ 0.0, 4.0 }, integrator });
+		const auto kernel = addElement<element::GaussKernel>(simulation, "kernel", kernelParameters());
+		field->addInput(kernel);
+		kernel->addInput(field);
+		field->addInput(addElement<element::GaussStimulus>(simulation, "stimulus", stimulusParameters()));
+		simulation.init();
+
+		std::vector<double> samples;
+		const int stepsPerSample = static_cast<int>(std::lround(4.0 / deltaT));
+		for (int sample = 0; sample < 25; sample++)
+		{
+			for (int i = 0; i < stepsPerSample; i++)
+				simulation.step();
+			const std::vector<double> activation = field->getComponent("activation");
+			samples.insert(samples.end(), activation.begin(), activation.end());
+		}
+		return samples;
+	}
+
+	double maximumDifference(const std::vector<double>& first, const std::vector<double>& second)
+	{
+		double difference = 0.0;
+		for (size_t i = 0; i < first.size(); i++)
+			difference = std::max(difference, std::abs(first[i] - second[i]));
+		return difference;
+	}
+
+	void checkOrders()
+	{
+		const std::vector<double> reference = runSelfExcitedField(element::Integrator::RK4, 1.0 / 16);
+		const auto order = [&reference](element::Integrator integrator)
+		{
+			const double coarseError = maximumDifference(runSelfExcitedField(integrator, 1.0), reference);
+			const double fineError = maximumDifference(runSelfExcitedField(integrator, 0.5), reference);
+			return std::log2(coarseError / fineError);
+		};
+		const double eulerOrder = order(element::Integrator::EULER);
+		const double heunOrder = order(element::Integrator::HEUN);
+		const double rk4Order = order(element::Integrator::RK4);
+		check(eulerOrder > 0.8 && eulerOrder < 1.2, "Euler is first order, measured " + std::to_string(eulerOrder));
+		check(heunOrder > 1.8 && heunOrder < 2.2, "Heun is second order, measured " + std::to_string(heunOrder));
+		check(rk4Order > 3.6, "RK4 is fourth order, measured " + std::to_string(rk4Order));
+	}
+
+	void checkNoiseHeldOverStep()
+	{
+		// a field without a kernel sees only the noise, with the input held over the step RK4 is the
+		// Taylor series of the exact solution to the fourth power
+		Simulation simulation("noise held", 2.0, 0.0, 0.0);
+		simulation.setSeed(3);
+		const auto field = addElement<element::NeuralField>(simulation, "field",
+			element::NeuralFieldParameters{ 10.0, -5.0, element::SigmoidFunction{ 0.0, 10.0 }, element::Integrator::RK4 });
+		const auto noise = addElement<element::NormalNoise>(simulation, "noise", element::NormalNoiseParameters{ 1.0 });
+		field->addInput(noise);
+		simulation.init();
+
+		const double a = 2.0 / 10.0;
+		const double gain = a - a * a / 2 + a * a * a / 6 - a * a * a * a / 24;
+		double largestDifference = 0.0;
+		for (int i = 0; i < 20; i++)
+		{
+			const std::vector<double> before = field->getComponent("activation");
+			simulation.step();
+			const std::vector<double> after = field->getComponent("activation");
+			const std::vector<double> input = noise->getComponent("output");
+			for (size_t j = 0; j < after.size(); j++)
+				largestDifference = std::max(largestDifference, std::abs(after[j] - (before[j] + gain * (-before[j] - 5.0 + input[j]))));
+		}
+		check(largestDifference < 1e-12, "noise drawn once per step, difference " + std::to_string(largestDifference));
+	}
+
+	constexpr int actionSelectionSteps = 100;
+
+	std::shared_ptr<Simulation> buildActionSelection(ExecutionMode executionMode, element::Integrator integrator)
+	{
+		const auto simulation = std::make_shared<Simulation>("execution modes", 1.0, 0.0, 0.0);
+		simulation->setSeed(11);
+		addActionSelectionArchitecture(*simulation);
+		setIntegrator(*simulation, integrator);
+		simulation->setExecutionMode(executionMode);
+		simulation->setNumberOfWorkers(4);
+		return simulation;
+	}
+
+	AllComponents runActionSelection(ExecutionMode executionMode, element::Integrator integrator)
+	{
+		const auto simulation = buildActionSelection(executionMode, integrator);
+		simulation->init();
+		for (int i = 0; i < actionSelectionSteps; i++)
+			simulation->step();
+		return getAllComponents(*simulation);
+	}
+
+	// the second instance of an ensemble, which seeds it with its own seed
+	AllComponents runActionSelectionEnsemble(element::Integrator integrator)
+	{
+		EnsembleSimulation ensemble(2, [integrator](size_t)
+		{
+			return buildActionSelection(ExecutionMode::TYPE_SORTED, integrator);
+		}, 5);
+		ensemble.setNumberOfWorkers(1);
+		ensemble.init();
+		for (int i = 0; i < actionSelectionSteps; i++)
+			ensemble.step();
+		return getAllComponents(*ensemble.getInstance(1));
+	}
+
+	void checkExecutionModes()
+	{
+		for (const auto integrator : { element::Integrator::HEUN, element::Integrator::RK4 })
+		{
+			const std::string name = element::IntegratorToString.at(integrator);
+			const AllComponents serial = runActionSelection(ExecutionMode::SERIAL, integrator);
+			checkSameComponents(serial, runActionSelection(ExecutionMode::PARALLEL_LEVELS, integrator), name + " parallel levels");
+			checkSameComponents(serial, runActionSelection(ExecutionMode::TYPE_SORTED, integrator), name + " type sorted");
+
+			const auto alone = buildActionSelection(ExecutionMode::TYPE_SORTED, integrator);
+			alone->setSeed(EnsembleSimulation::getInstanceSeed(5, 1));
+			alone->init();
+			for (int i = 0; i < actionSelectionSteps; i++)
+				alone->step();
+			checkSameComponents(getAllComponents(*alone), runActionSelectionEnsemble(integrator), name + " ensemble instance");
+		}
+	}
+
+	void checkDoubleBufferingRefused()
+	{
+		Simulation simulation("double buffered", 1.0, 0.0, 0.0);
+		addSelfExcitedField(simulation, "field");
+		setIntegrator(simulation, element::Integrator::HEUN);
+		simulation.setDoubleBuffered(true);
+		simulation.init();
+		bool refused = false;
+		try
+		{
+			simulation.step();
+		}
+		catch (const Exception& ex)
+		{
+			refused = ex.getErrorCode() == ErrorCode::SIM_INVALID_PARAMETER;
+		}
+		check(refused, "a double-buffered step of a field integrated in stages is refused");
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::FATAL);
+	checkOrders();
+	checkNoiseHeldOverStep();
+	checkExecutionModes();
+	checkDoubleBufferingRefused();
+
+	return finish("Multi-stage integrators evaluate the inputs of every stage.");
+}
@@ -0,0 +1,133 @@
+// Checks the lowest and highest activation a neural field reports after its fused step
+// against the separate pass NeuralField::updateMinMaxActivation() over the new activation,
+// and the fields stepped together by NeuralFieldBatch against fields stepped through the generic, unfused step.
+
+#include "test_harness.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	// exposes the separate pass over the activation
+	class ReferenceNeuralField : public element::NeuralField
+	{
+	public:
+		using NeuralField::NeuralField;
+		void updateReferenceMinMaxActivation() { updateMinMaxActivation(); }
+	};
+
+	// the sigmoid behind a type the fused step does not know, so the field steps through the separate passes
+	struct UnknownSigmoidFunction : public element::ActivationFunction
+	{
+		element::SigmoidFunction sigmoid;
+
+		UnknownSigmoidFunction(double x_shift, double steepness) : sigmoid(x_shift, steepness) {}
+		UnknownSigmoidFunction(const UnknownSigmoidFunction&) = default;
+
+		std::vector<double> operator()(std::span<const double> input) override { return sigmoid(input); }
+		void operator()(std::span<const double> input, std::span<double> output) override { sigmoid(input, output); }
+		bool operator==(const ActivationFunction& other) const override { return this == &other; }
+		std::unique_ptr<ActivationFunction> clone() const override { return std::make_unique<UnknownSigmoidFunction>(*this); }
+		std::string toString() const override { return "Unknown " + sigmoid.toString(); }
+		void print() const override { sigmoid.print(); }
+	};
+
+	// a stimulus wider than the field raises the activation everywhere, so every value moves away from the resting level
+	void checkFusedStatistics(int size, int steps)
+	{
+		Simulation simulation("neural field statistics", 1.0, 0.0, 0.0);
+		const element::ElementDimensions fieldDimensions{ size, 1.0 };
+		const auto field = addElement<ReferenceNeuralField>(simulation, "field", fieldParameters(), fieldDimensions);
+		field->addInput(addElement<element::GaussStimulus>(simulation, "stimulus",
+			element::GaussStimulusParameters{ size / 2.0, 5.0, size / 3.0 }, fieldDimensions));
+		simulation.init();
+
+		for (int i = 0; i < steps; i++)
+		{
+			simulation.step();
+			const double lowest = field->getLowestActivation();
+			const double highest = field->getHighestActivation();
+			field->updateReferenceMinMaxActivation();
+			const std::string step = "size " + std::to_string(size) + ", step " + std::to_string(i + 1);
+			check(lowest == field->getLowestActivation(), step + ": lowest activation " + std::to_string(lowest) +
+				", expected " + std::to_string(field->getLowestActivation()));
+			check(highest == field->getHighestActivation(), step + ": highest activation " + std::to_string(highest) +
+				", expected " + std::to_string(field->getHighestActivation()));
+		}
+	}
+
+	struct FieldRun
+	{
+		std::vector<std::vector<double>> activations;
+		std::vector<double> lowest;
+		std::vector<double> highest;
+	};
+
+	// five fields of the same size in one level, so the batch steps a group of four rows and a single one
+	FieldRun runFields(ExecutionMode mode, const element::ActivationFunction& activationFunction, int size, int steps)
+	{
+		constexpr int numberOfFields = 5;
+		Simulation simulation("neural field batch statistics", 1.0, 0.0, 0.0);
+		simulation.setExecutionMode(mode);
+		const element::ElementDimensions fieldDimensions{ size, 1.0 };
+		std::vector<std::shared_ptr<element::NeuralField>> fields;
+		for (int i = 0; i < numberOfFields; i++)
+		{
+			const std::string suffix = " " + std::to_string(i);
+			const auto field = addElement<element::NeuralField>(simulation, "field" + suffix,
+				element::NeuralFieldParameters{ 20.0 + i, -5.0, activationFunction }, fieldDimensions);
+			field->addInput(addElement<element::GaussStimulus>(simulation, "stimulus" + suffix,
+				element::GaussStimulusParameters{ size / 2.0, 5.0 + i, size * (i + 1) / (numberOfFields + 1.0) }, fieldDimensions));
+			fields.push_back(field);
+		}
+		simulation.init();
+		for (int i = 0; i < steps; i++)
+			simulation.step();
+
+		FieldRun run;
+		for (const auto& field : fields)
+		{
+			run.activations.push_back(field->getComponent("activation"));
+			run.lowest.push_back(field->getLowestActivation());
+			run.highest.push_back(field->getHighestActivation());
+		}
+		return run;
+	}
+
+	void checkBatchedStatistics(int size, int steps)
+	{
+		const element::SigmoidFunction sigmoid{ 0.0, 10.0 };
+		const FieldRun reference = runFields(ExecutionMode::SERIAL, UnknownSigmoidFunction{ 0.0, 10.0 }, size, steps);
+		const FieldRun single = runFields(ExecutionMode::SERIAL, sigmoid, size, steps);
+		const FieldRun batched = runFields(ExecutionMode::TYPE_SORTED, sigmoid, size, steps);
+
+		for (const auto& [run, name] : { std::pair{ &single, "fused" }, std::pair{ &batched, "batched" } })
+			for (size_t f = 0; f < reference.activations.size(); f++)
+			{
+				const std::string field = std::string(name) + " field " + std::to_string(f) + " of size " + std::to_string(size);
+				check(run->activations[f] == reference.activations[f], field + ": activation differs from the unfused step");
+				check(run->lowest[f] == reference.lowest[f], field + ": lowest activation " + std::to_string(run->lowest[f]) +
+					", expected " + std::to_string(reference.lowest[f]));
+				check(run->highest[f] == reference.highest[f], field + ": highest activation " + std::to_string(run->highest[f]) +
+					", expected " + std::to_string(reference.highest[f]));
+			}
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+
+	// one block, and several blocks with a partial last one
+	checkFusedStatistics(100, 5);
+	checkFusedStatistics(1300, 5);
+	for (const int steps : { 1, 5 })
+	{
+		checkBatchedStatistics(100, steps);
+		checkBatchedStatistics(1300, steps);
+	}
+
+	return finish("Neural field statistics match the separate passes.");
+}
@@ -0,0 +1,120 @@
+// Checks the documented error bounds of the polynomial exp and sigmoid on every instruction set the processor
+// supports: a relative error below polynomialExpMaxRelativeError over [-708, 708], and an absolute error of
+// the sigmoid below a quarter of it. Also checks that the normal numbers of the polynomial Box-Muller transform stay
+// within boxMullerMaxAbsoluteError of those of the standard library, and are the same on every instruction set.
+
+#include <cmath>
+#include <numbers>
+
+#include "test_harness.h"
+#include "tools/simd.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	// arguments spread over the whole range, with the ends, zero and the points where the exponent shift changes
+	std::vector<double> makeArguments()
+	{
+		std::vector<double> arguments;
+		constexpr int samples = 200000;
+		for (int i = 0; i <= samples; i++)
+			arguments.push_back(-708.0 + 1416.0 * i / samples);
+		for (int k = -1021; k <= 1020; k++)
+			for (const double offset : { -1e-9, 0.0, 1e-9 })
+				arguments.push_back((k + 0.5) * std::log(2.0) + offset);
+		arguments.push_back(0.0);
+		return arguments;
+	}
+
+	void checkErrorBounds(tools::simd::InstructionSet instructionSet, const std::vector<double>& arguments)
+	{
+		tools::simd::setInstructionSet(instructionSet);
+		if (tools::simd::getInstructionSet() != instructionSet)
+			return;
+		const std::string name = tools::simd::getInstructionSetName();
+
+		std::vector<double> exps(arguments.size());
+		tools::simd::polynomialExp(arguments, exps);
+		double largestRelativeError = 0.0;
+		for (size_t i = 0; i < arguments.size(); i++)
+		{
+			const double exact = std::exp(arguments[i]);
+			largestRelativeError = std::max(largestRelativeError, std::abs(exps[i] - exact) / exact);
+		}
+		check(largestRelativeError < tools::simd::polynomialExpMaxRelativeError,
+			name + ": largest relative error of exp " + std::to_string(largestRelativeError));
+
+		constexpr double beta = 4.0;
+		constexpr double x0 = 1.5;
+		std::vector<double> inputs;
+		for (int i = 0; i <= 100000; i++)
+			inputs.push_back(-100.0 + 200.0 * i / 100000);
+		std::vector<double> sigmoids(inputs.size());
+		tools::simd::polynomialSigmoid(inputs, beta, x0, sigmoids);
+		double largestAbsoluteError = 0.0;
+		for (size_t i = 0; i < inputs.size(); i++)
+			largestAbsoluteError = std::max(largestAbsoluteError, std::abs(sigmoids[i] - 1 / (1 + std::exp(-beta * (inputs[i] - x0)))));
+		check(largestAbsoluteError < tools::simd::polynomialExpMaxRelativeError / 4,
+			name + ": largest absolute error of the sigmoid " + std::to_string(largestAbsoluteError));
+		std::cout << name << ": exp " << largestRelativeError << ", sigmoid " << largestAbsoluteError << '\n';
+	}
+
+	// pairs of uniform numbers over (0, 1), with the smallest and largest the generator draws and the quadrant ends of v
+	std::vector<double> makeUniformPairs()
+	{
+		std::vector<double> pairs;
+		constexpr int samples = 400;
+		for (int i = 0; i < samples; i++)
+			for (int j = 0; j < samples; j++)
+				pairs.insert(pairs.end(), { (i + 0.5) / samples, (j + 0.5) / samples });
+		for (const double u : { 0x1.0p-33, 1 - 0x1.0p-33 })
+			for (const double v : { 0x1.0p-33, 0.25, 0.5, 0.75, 1 - 0x1.0p-33 })
+				pairs.insert(pairs.end(), { u, v });
+		pairs.insert(pairs.end(), { 0.5, 0.5 });
+		return pairs;
+	}
+
+	void checkBoxMuller(tools::simd::InstructionSet instructionSet, const std::vector<double>& pairs, std::vector<double>& scalarNormals)
+	{
+		tools::simd::setInstructionSet(instructionSet);
+		if (tools::simd::getInstructionSet() != instructionSet)
+			return;
+		const std::string name = tools::simd::getInstructionSetName();
+
+		std::vector<double> normals = pairs;
+		tools::simd::boxMuller(normals);
+		double largestAbsoluteError = 0.0;
+		for (size_t i = 0; i < pairs.size(); i += 2)
+		{
+			const double radius = std::sqrt(-2 * std::log(pairs[i]));
+			const double angle = 2 * std::numbers::pi * pairs[i + 1];
+			largestAbsoluteError = std::max({ largestAbsoluteError, std::abs(normals[i] - radius * std::cos(angle)),
+				std::abs(normals[i + 1] - radius * std::sin(angle)) });
+		}
+		check(largestAbsoluteError < tools::simd::boxMullerMaxAbsoluteError,
+			name + ": largest absolute error of the Box-Muller transform " + std::to_string(largestAbsoluteError));
+		if (instructionSet == tools::simd::InstructionSet::SCALAR)
+			scalarNormals = normals;
+		else
+			check(normals == scalarNormals, name + ": the Box-Muller transform differs from the scalar one");
+		std::cout << name << ": Box-Muller " << largestAbsoluteError << '\n';
+	}
+}
+
+int main()
+{
+	const tools::simd::InstructionSet detected = tools::simd::getInstructionSet();
+	const std::vector<double> arguments = makeArguments();
+	for (const auto instructionSet : { tools::simd::InstructionSet::SCALAR, tools::simd::InstructionSet::AVX2, tools::simd::InstructionSet::AVX512 })
+		checkErrorBounds(instructionSet, arguments);
+	const std::vector<double> pairs = makeUniformPairs();
+	std::vector<double> scalarNormals;
+	for (const auto instructionSet : { tools::simd::InstructionSet::SCALAR, tools::simd::InstructionSet::AVX2, tools::simd::InstructionSet::AVX512 })
+		checkBoxMuller(instructionSet, pairs, scalarNormals);
+	tools::simd::setInstructionSet(detected);
+
+	return finish("The polynomial exp and Box-Muller transform stay within their documented errors.");
+}
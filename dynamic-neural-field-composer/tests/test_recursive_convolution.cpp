@@ -0,0 +1,91 @@
+// Checks when a kernel set to the recursive convolution uses it: only where it is faster than the direct
+// convolution and its error stays within the maximum recursive error, which then bounds the actual difference.
+
+#include <limits>
+
+#include "test_harness.h"
+#include "elements/mexican_hat_kernel.h"
+#include "elements/normal_noise.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	struct Comparison
+	{
+		bool recursive;
+		// largest difference from the direct convolution, relative to the sum of the magnitudes of the kernel
+		double relativeError;
+	};
+
+	template <typename KernelType, typename Parameters>
+	Comparison compare(int size, const Parameters& parameters, double maximumError)
+	{
+		Simulation simulation("recursive convolution", 1.0, 0.0, 0.0);
+		simulation.setSeed(1);
+		const element::ElementDimensions fieldDimensions{ size, 1.0 };
+		const auto noise = addElement<element::NormalNoise>(simulation, "noise", element::NormalNoiseParameters{ 1.0 }, fieldDimensions);
+		const auto direct = addElement<KernelType>(simulation, "direct", parameters, fieldDimensions);
+		const auto recursive = addElement<KernelType>(simulation, "recursive", parameters, fieldDimensions);
+		direct->setConvolutionMode(element::ConvolutionMode::DIRECT);
+		recursive->setConvolutionMode(element::ConvolutionMode::RECURSIVE);
+		recursive->setMaximumRecursiveError(maximumError);
+		direct->addInput(noise);
+		recursive->addInput(noise);
+		simulation.init();
+
+		double magnitude = 0.0;
+		for (const double value : direct->getComponent("kernel"))
+			magnitude += std::abs(value);
+		Comparison comparison{ recursive->isUsingRecursiveConvolution(), 0.0 };
+		for (int i = 0; i < 10; i++)
+		{
+			simulation.step();
+			const std::vector<double> directOutput = direct->getComponent("output");
+			const std::vector<double> recursiveOutput = recursive->getComponent("output");
+			double largestInput = 0.0;
+			for (const double value : noise->getComponent("output"))
+				largestInput = std::max(largestInput, std::abs(value));
+			for (size_t j = 0; j < directOutput.size(); j++)
+				comparison.relativeError = std::max(comparison.relativeError,
+					std::abs(directOutput[j] - recursiveOutput[j]) / (magnitude * largestInput));
+		}
+		return comparison;
+	}
+
+	void checkRecursiveConvolution()
+	{
+		constexpr double maximumError = element::Kernel::defaultMaximumRecursiveError;
+		const auto gauss = [](double width, bool circular) { return element::GaussKernelParameters{ width, 3.0, 0.0, circular, true }; };
+
+		// wide enough to be faster and not truncated by the field, so within the bound
+		for (const bool circular : { true, false })
+		{
+			const Comparison comparison = compare<element::GaussKernel>(500, gauss(10.0, circular), maximumError);
+			const std::string configuration = circular ? "circular gauss, width 10" : "bounded gauss, width 10";
+			check(comparison.recursive, configuration + ": convolved recursively");
+			check(comparison.relativeError <= maximumError, configuration + ": error " + std::to_string(comparison.relativeError));
+		}
+
+		// the direct convolution is faster for narrow kernels
+		check(!compare<element::GaussKernel>(500, gauss(1.0, true), maximumError).recursive, "gauss, width 1: convolved directly");
+
+		// the field truncates the kernel, whose recursive error would be around 16%
+		check(!compare<element::GaussKernel>(100, gauss(30.0, true), maximumError).recursive, "circular gauss, width 30 on 100 samples: not convolved recursively");
+		check(compare<element::GaussKernel>(100, gauss(30.0, true), std::numeric_limits<double>::infinity()).recursive,
+			"circular gauss, width 30 on 100 samples: convolved recursively whatever the error");
+
+		// the errors of the two Gaussians of a Mexican hat do not cancel
+		const element::MexicanHatKernelParameters mexicanHat{ 10.0, 11.0, 20.0, 15.0, 0.0, true, true };
+		check(!compare<element::MexicanHatKernel>(500, mexicanHat, maximumError).recursive, "mexican hat, width 10: not convolved recursively");
+	}
+}
+
+int main()
+{
+	checkRecursiveConvolution();
+
+	return finish("Recursive convolution is used where expected.");
+}
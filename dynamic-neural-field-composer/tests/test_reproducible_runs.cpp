@@ -0,0 +1,33 @@
+// Checks that the same architecture built twice, the second time with its connections made in the opposite order,
+// gives bit for bit the same components after the same steps with the same seed: the inputs of an element are
+// summed in the same order whatever the addresses of the elements and the order of the connections.
+
+#include "test_harness.h"
+
+
+using namespace dnf_composer;
+using namespace dnf_composer::test;
+
+namespace
+{
+	AllComponents run(bool reverseConnections, int steps)
+	{
+		Simulation simulation("reproducible runs", 1.0, 0.0, 0.0);
+		simulation.setSeed(42);
+		addActionSelectionArchitecture(simulation, reverseConnections);
+		simulation.init();
+		for (int i = 0; i < steps; i++)
+			simulation.step();
+		return getAllComponents(simulation);
+	}
+}
+
+int main()
+{
+	tools::logger::Logger::setMinLogLevel(tools::logger::LogLevel::ERROR);
+
+	constexpr int steps = 200;
+	checkSameComponents(run(false, steps), run(true, steps), "connections made in the opposite order");
+
+	return finish("Runs of the same architecture are reproducible.");
+}